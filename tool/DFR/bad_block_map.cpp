@@ -0,0 +1,114 @@
+#include "bad_block_map.h"
+#include "logger.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+void BadBlockMap::add(uint64_t offset, uint64_t length) {
+    if (length == 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t start = offset;
+    uint64_t end = offset + length;
+
+    // دمج المنطقة السابقة إن تداخلت أو لاصقت
+    auto it = blocks.upper_bound(start);
+    if (it != blocks.begin()) {
+        auto prev = std::prev(it);
+        if (prev->second >= start) {
+            start = prev->first;
+            end = std::max(end, prev->second);
+            it = blocks.erase(prev);
+        }
+    }
+    while (it != blocks.end() && it->first <= end) {
+        end = std::max(end, it->second);
+        it = blocks.erase(it);
+    }
+    blocks[start] = end;
+}
+
+void BadBlockMap::remove(uint64_t offset, uint64_t length) {
+    if (length == 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t start = offset;
+    uint64_t end = offset + length;
+
+    auto it = blocks.upper_bound(start);
+    if (it != blocks.begin()) --it;
+    while (it != blocks.end() && it->first < end) {
+        uint64_t blockStart = it->first;
+        uint64_t blockEnd = it->second;
+        if (blockEnd <= start) {
+            ++it;
+            continue;
+        }
+        it = blocks.erase(it);
+        if (blockStart < start) blocks[blockStart] = start;
+        if (blockEnd > end) blocks[end] = blockEnd;
+    }
+}
+
+std::vector<BadBlockMap::Range> BadBlockMap::ranges() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Range> result;
+    result.reserve(blocks.size());
+    for (const auto& [start, end] : blocks) result.emplace_back(start, end - start);
+    return result;
+}
+
+uint64_t BadBlockMap::totalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t total = 0;
+    for (const auto& [start, end] : blocks) total += end - start;
+    return total;
+}
+
+bool BadBlockMap::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return blocks.empty();
+}
+
+bool BadBlockMap::save(const std::string& path, const std::string& devicePath) const {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARN("BadBlocks", "Cannot write bad-block map ", tmpPath);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "# DFR bad-block map for " << devicePath << "\n"
+            << "#      pos        size  status\n";
+        for (const auto& [start, end] : blocks) {
+            out << "0x" << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << start
+                << "  0x" << std::setw(8) << (end - start) << std::dec << "  -\n";
+        }
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+bool BadBlockMap::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string pos, size, status;
+        if (!(iss >> pos >> size >> status) || status != "-") continue;
+        try {
+            add(std::stoull(pos, nullptr, 0), std::stoull(size, nullptr, 0));
+        } catch (const std::exception&) {
+            LOG_WARN("BadBlocks", "Ignoring malformed line in ", path, ": ", line);
+        }
+    }
+    return true;
+}
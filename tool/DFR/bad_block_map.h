@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+
+// خريطة المناطق غير المقروءة على القرص (بالبايت، بدقة القطاع).
+// تُملأ أثناء القراءة المتسامحة وتُعاد محاولتها في النهاية، وتُحفظ بصيغة قريبة من mapfile الخاص بـ ddrescue.
+// آمنة للاستخدام من عدة خيوط.
+class BadBlockMap {
+public:
+    using Range = std::pair<uint64_t, uint64_t>;    // بداية، طول
+
+    // إضافة منطقة (تُدمج مع المتداخل والمتلاصق)
+    void add(uint64_t offset, uint64_t length);
+
+    // حذف منطقة نجحت قراءتها لاحقًا
+    void remove(uint64_t offset, uint64_t length);
+
+    // نسخة مرتبة من المناطق
+    std::vector<Range> ranges() const;
+
+    uint64_t totalBytes() const;
+
+    bool empty() const;
+
+    // حفظ وتحميل الخريطة: سطر لكل منطقة "0xSTART 0xLENGTH -"
+    bool save(const std::string& path, const std::string& devicePath) const;
+    bool load(const std::string& path);
+
+private:
+    mutable std::mutex mutex;
+    std::map<uint64_t, uint64_t> blocks;    // بداية -> نهاية
+};
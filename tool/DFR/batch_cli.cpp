@@ -0,0 +1,425 @@
+#include "batch_cli.h"
+#include "utils.h"
+#include "scan_stats.h"
+#include "output_manager.h"
+#include "signature_automaton.h"
+#include "signature_database.h"
+#include "ui_cli.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <memory>
+#include <csignal>
+
+namespace {
+
+// SIGINT/SIGTERM: إيقاف المهمة بأمان وحفظ نقطة الاستئناف بدل القتل الفوري
+extern "C" void handleStopSignal(int) {
+    RecoveryJob::requestStop();
+}
+
+} // namespace
+
+int BatchCli::run(int argc, char** argv) {
+    Config config;
+    try {
+        config = parse(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[!] " << e.what() << "\n";
+        printUsage(std::cerr);
+        return static_cast<int>(ExitCode::USAGE);
+    }
+
+    if (config.help) {
+        printUsage(std::cout);
+        return static_cast<int>(ExitCode::OK);
+    }
+
+    // السجلات إلى stderr (وملف المهمة لاحقًا)، وstdout للملخص فقط
+    Logger& logger = Logger::getInstance();
+    logger.setConsoleStream(std::cerr);
+    logger.setLevel(config.logLevel);
+
+    if (!config.queryDir.empty()) return runQuery(config);
+
+    const auto& job = config.job;
+    if (config.listPartitions) {
+        DiskReader reader(job.devicePath);
+        uint64_t diskSize = reader.detectDiskSize() ? reader.getDiskInfo().totalSize : 0;
+        std::cout << PartitionTable::toJson(PartitionTable::read(reader, diskSize)) << std::endl;
+        return static_cast<int>(ExitCode::OK);
+    }
+
+    if (!Utils::createDirectoryIfNotExists(job.outputDir)) {
+        std::cerr << "[!] Failed to create output directory: " << job.outputDir << "\n";
+        return static_cast<int>(ExitCode::FAILED);
+    }
+    if (config.summaryPath.empty()) config.summaryPath = job.outputDir + "/summary.json";
+    if (config.logFile.empty()) config.logFile = job.outputDir + "/dfr.log";
+
+    logger.setLogFile(config.logFile);
+    logger.enableAsync();
+
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    ScanStats& stats = ScanStats::getInstance();
+    stats.reset();
+
+    RecoveryJob::Summary summary;
+    {
+        OutputManager output(job.outputDir);
+        if (!output.setupDirectories()) {
+            summary.error = "Failed to prepare output directory " + job.outputDir;
+        } else {
+            CliUI ui;
+            std::unique_ptr<ProgressReporter> progress;
+            if (config.progress) {
+                progress = std::make_unique<ProgressReporter>(ui, std::chrono::milliseconds(1000), std::cerr);
+            }
+
+            try {
+                summary = RecoveryJob(job).run(output);
+            } catch (const std::exception& e) {
+                summary.error = e.what();
+            }
+            if (progress) progress->stop();
+        }
+    }
+
+    if (summary.success) {
+        stats.writeJson(job.outputDir + "/scan_stats.json");
+        LOG_INFO("Batch", "Recovered ", summary.filesRecovered, " files from ", summary.hits, " hits");
+    } else if (summary.interrupted) {
+        LOG_WARN("Batch", "Job interrupted, progress saved to ", summary.checkpointPath);
+    } else {
+        LOG_ERROR("Batch", "Job failed: ", summary.error);
+    }
+    logger.disableAsync();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    writeSummary(config, summary);
+
+    if (summary.interrupted) return static_cast<int>(ExitCode::INTERRUPTED);
+    if (!summary.success) return static_cast<int>(ExitCode::FAILED);
+    return static_cast<int>(summary.readErrors || summary.writeErrors ? ExitCode::PARTIAL : ExitCode::OK);
+}
+
+BatchCli::Config BatchCli::parse(int argc, char** argv) {
+    Config config;
+    bool haveDevice = false;
+
+    // القاعدة تُحمل قبل بقية الخيارات لأن --types يتحقق من الأنواع المعروفة
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--signatures") config.signaturesPath = argv[i + 1];
+    }
+    if (!config.signaturesPath.empty()) {
+        SignatureScanner::installSignatures(SignatureDatabase::load(config.signaturesPath));
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--device" || arg == "-d") {
+            config.job.devicePath = value();
+            haveDevice = true;
+        } else if (arg == "--output" || arg == "-o") {
+            config.job.outputDir = value();
+        } else if (arg == "--types" || arg == "-t") {
+            std::string list = value();
+            config.job.fileTypes.clear();
+            if (list == "all") continue;
+
+            std::istringstream iss(list);
+            std::string token;
+            const auto& known = SignatureScanner::getKnownSignatures();
+            while (std::getline(iss, token, ',')) {
+                token = Utils::trim(token);
+                if (token.empty()) continue;
+                if (const auto* preset = SignatureAutomaton::presetTypes(token)) {
+                    config.job.fileTypes.insert(config.job.fileTypes.end(), preset->begin(), preset->end());
+                    continue;
+                }
+                bool exists = std::any_of(known.begin(), known.end(),
+                                          [&](const SignatureScanner::FileSignature& s) { return s.extension == token; });
+                if (!exists) throw std::invalid_argument("unknown file type '" + token + "'");
+                config.job.fileTypes.push_back(token);
+            }
+        } else if (arg == "--signatures") {
+            value();    // حُملت أعلاه
+        } else if (arg == "--range" || arg == "-r") {
+            // START:LENGTH أو START (حتى النهاية)، ويمكن تكرار الخيار أو الفصل بفواصل
+            auto extents = ScanExtents::parseList(value());
+            config.job.extents.insert(config.job.extents.end(), extents.begin(), extents.end());
+        } else if (arg == "--extents-file") {
+            auto extents = ScanExtents::loadFile(value());
+            config.job.extents.insert(config.job.extents.end(), extents.begin(), extents.end());
+        } else if (arg == "--partitions") {
+            config.job.usePartitionTable = true;
+        } else if (arg == "--no-gaps") {
+            config.job.scanGaps = false;
+        } else if (arg == "--list-partitions") {
+            config.listPartitions = true;
+        } else if (arg == "--threads" || arg == "-j") {
+            config.job.threads = static_cast<unsigned>(std::stoul(value()));
+        } else if (arg == "--chunk-size") {
+            config.job.chunkSize = static_cast<size_t>(Utils::parseSize(value()));
+            if (config.job.chunkSize == 0) throw std::invalid_argument("chunk size must be positive");
+        } else if (arg == "--max-file-size") {
+            config.job.maxFileSize = static_cast<size_t>(Utils::parseSize(value()));
+        } else if (arg == "--max-carve-size") {
+            config.job.maxCarveSize = Utils::parseSize(value());
+        } else if (arg == "--image") {
+            config.job.imagePath = value();
+        } else if (arg == "--image-compress") {
+            config.job.compressImage = true;
+        } else if (arg == "--strict-read") {
+            config.job.tolerateBadSectors = false;
+        } else if (arg == "--retries") {
+            config.job.badSectorRetries = static_cast<unsigned>(std::stoul(value()));
+        } else if (arg == "--nested") {
+            if (!ContainmentIndex::parsePolicy(value(), config.job.containment)) {
+                throw std::invalid_argument("--nested must be outer, inner or both");
+            }
+        } else if (arg == "--huge-pages") {
+            config.job.hugePages = true;
+        } else if (arg == "--numa") {
+            config.job.numa = true;
+        } else if (arg == "--report") {
+            std::stringstream list(value());
+            std::string token;
+            while (std::getline(list, token, ',')) {
+                ReportWriter::Format format;
+                if (!ReportWriter::parseFormat(Utils::trim(token), format)) {
+                    throw std::invalid_argument("unknown report format '" + token + "' (jsonl, csv or dfxml)");
+                }
+                if (std::find(config.job.reports.begin(), config.job.reports.end(), format) ==
+                    config.job.reports.end()) {
+                    config.job.reports.push_back(format);
+                }
+            }
+        } else if (arg == "--no-hash") {
+            config.job.hashFiles = false;
+        } else if (arg == "--query") {
+            config.queryDir = value();
+        } else if (arg == "--where") {
+            config.where.push_back(RecoveredIndex::parseFilter(value()));
+        } else if (arg == "--sort") {
+            config.sortField = value();
+            config.sortDescending = !config.sortField.empty() && config.sortField[0] == '-';
+            if (config.sortDescending) config.sortField.erase(0, 1);
+            const auto& fields = RecoveredIndex::fields();
+            if (std::find(fields.begin(), fields.end(), config.sortField) == fields.end()) {
+                throw std::invalid_argument("unknown sort field '" + config.sortField + "'");
+            }
+        } else if (arg == "--limit") {
+            config.limit = static_cast<size_t>(std::stoull(value()));
+        } else if (arg == "--no-prefilter") {
+            config.job.prefilter = false;
+        } else if (arg == "--rescan") {
+            config.job.useIndex = false;
+        } else if (arg == "--no-resume") {
+            config.job.resume = false;
+        } else if (arg == "--checkpoint-interval") {
+            config.job.checkpointInterval = static_cast<unsigned>(std::stoul(value()));
+        } else if (arg == "--format" || arg == "-f") {
+            config.format = value();
+            if (config.format != "json" && config.format != "text") {
+                throw std::invalid_argument("format must be json or text");
+            }
+        } else if (arg == "--summary") {
+            config.summaryPath = value();
+        } else if (arg == "--log-file") {
+            config.logFile = value();
+        } else if (arg == "--log-level") {
+            std::string level = value();
+            if (level == "debug") config.logLevel = LogLevel::DEBUG;
+            else if (level == "info") config.logLevel = LogLevel::INFO;
+            else if (level == "warning") config.logLevel = LogLevel::WARNING;
+            else if (level == "error") config.logLevel = LogLevel::ERROR;
+            else throw std::invalid_argument("unknown log level '" + level + "'");
+        } else if (arg == "--quiet" || arg == "-q") {
+            config.logLevel = LogLevel::ERROR;
+        } else if (arg == "--progress") {
+            config.progress = true;
+        } else if (arg == "--help" || arg == "-h") {
+            config.help = true;
+            return config;
+        } else {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+
+    if (!haveDevice && config.queryDir.empty()) throw std::invalid_argument("--device or --query is required");
+    if (config.queryDir.empty() && (!config.where.empty() || !config.sortField.empty() || config.limit)) {
+        throw std::invalid_argument("--where, --sort and --limit need --query");
+    }
+    if (config.job.compressImage && config.job.imagePath.empty()) {
+        throw std::invalid_argument("--image-compress needs --image");
+    }
+    return config;
+}
+
+void BatchCli::printUsage(std::ostream& out) {
+    out << "Usage: dfr --device PATH [options]\n"
+        << "       dfr --query DIR [--where EXPR]... [--sort [-]FIELD] [--limit N] [-f json|text]\n"
+        << "\n"
+        << "  -d, --device PATH        disk, partition or image to scan (required\n"
+        << "                           unless --query)\n"
+        << "  -o, --output DIR         output directory (default ./recovered)\n"
+        << "  -t, --types LIST         comma-separated types or presets (images, documents),\n"
+        << "                           e.g. jpg,png,pdf (default all)\n"
+        << "      --signatures FILE    signature database to use instead of the built-in table\n"
+        << "                           (see signatures.conf; compiled to FILE.bin on first use)\n"
+        << "  -r, --range START[:LEN]  extent to scan; repeatable or comma-separated, suffixes\n"
+        << "                           K/M/G/T or S for 512-byte sectors (default whole device)\n"
+        << "      --extents-file FILE  extents to scan, one START[:LEN] per line\n"
+        << "      --partitions         scan each MBR/GPT partition and unpartitioned gap as\n"
+        << "                           its own extent (intersected with --range if given)\n"
+        << "      --no-gaps            with --partitions, skip unpartitioned space\n"
+        << "      --list-partitions    print the partition table as JSON and exit\n"
+        << "  -j, --threads N          worker threads (default: all cores)\n"
+        << "      --chunk-size SIZE    read/scan chunk size (default 64M)\n"
+        << "      --huge-pages         read buffers on 2M pages (hugetlbfs, else transparent\n"
+        << "                           huge pages, else normal pages)\n"
+        << "      --numa               pin workers round-robin to NUMA nodes with node-local\n"
+        << "                           buffers (needs libnuma at build time)\n"
+        << "      --max-file-size SIZE carve size when neither the header nor a footer gives\n"
+        << "                           the length (default 10M; max= in a signature database)\n"
+        << "      --max-carve-size SIZE\n"
+        << "                           cap on lengths read from headers (RIFF, BMP, ZIP EOCD);\n"
+        << "                           carving streams in 1M blocks (default 16G)\n"
+        << "      --nested outer|inner|both\n"
+        << "                           files found inside another recovered file: keep the\n"
+        << "                           container only (default), only the innermost files, or\n"
+        << "                           both with inner ones logged as references to the container\n"
+        << "      --image FILE         write a raw image of everything read (sparse file with\n"
+        << "                           per-block SHA-256 in FILE.sha256); a full-device image\n"
+        << "                           is also used for carving and can be scanned later with -d\n"
+        << "      --image-compress     write the image as zlib-compressed blocks instead\n"
+        << "      --retries N          re-read passes over bad sectors after the scan (default 1)\n"
+        << "      --strict-read        skip a whole chunk on the first read error instead of\n"
+        << "                           splitting it and zero-filling bad sectors\n"
+        << "      --no-prefilter       scan zero-filled and uniform blocks too (and write no\n"
+        << "                           <output>/usage.map)\n"
+        << "      --report LIST        stream per-hit records while carving to <output>/report.jsonl,\n"
+        << "                           report.csv and/or report.dfxml (LIST of jsonl,csv,dfxml):\n"
+        << "                           offset, length, status, validation, SHA-256, metadata\n"
+        << "      --no-hash            do not compute SHA-256 of recovered files for the index\n"
+        << "      --rescan             ignore <output>/hits.idx and rebuild it with a full scan\n"
+        << "      --no-resume          ignore <output>/checkpoint.dfr and start from scratch\n"
+        << "      --checkpoint-interval SECONDS\n"
+        << "                           how often progress is checkpointed (default 30)\n"
+        << "  -f, --format json|text   summary format on stdout (default json)\n"
+        << "      --summary FILE       summary file (default <output>/summary.json)\n"
+        << "      --log-file FILE      log file (default <output>/dfr.log)\n"
+        << "      --log-level LEVEL    debug, info, warning or error (default info)\n"
+        << "  -q, --quiet              only log errors\n"
+        << "      --progress           live progress line on stderr\n"
+        << "\n"
+        << "Query mode searches <DIR>/recovered.idx written by earlier runs:\n"
+        << "      --where EXPR         FIELD OP VALUE with OP one of = != < <= > >= ~ (contains),\n"
+        << "                           or a bare FIELD (set/non-empty); repeatable, all must match.\n"
+        << "                           Fields: name type offset size date year gps author make\n"
+        << "                           model title hash, e.g. --where type=jpg --where year=2023\n"
+        << "                           --where gps\n"
+        << "      --sort [-]FIELD      order by FIELD, '-' for descending (default offset)\n"
+        << "      --limit N            print at most N files\n"
+        << "\n"
+        << "Exit codes: 0 success, 1 failure, 2 usage error, 3 completed with read or\n"
+        << "            write errors, 4 interrupted (re-run the same command to resume)\n"
+        << "Run without arguments for the interactive menu.\n";
+}
+
+int BatchCli::runQuery(const Config& config) {
+    RecoveredIndex index;
+    std::vector<size_t> rows;
+    try {
+        if (!index.load(config.queryDir + "/recovered.idx")) {
+            std::cerr << "[!] No recovered-files index in " << config.queryDir << "\n";
+            return static_cast<int>(ExitCode::FAILED);
+        }
+        rows = index.select(config.where, config.sortField, config.sortDescending, config.limit);
+    } catch (const std::exception& e) {
+        std::cerr << "[!] " << e.what() << "\n";
+        return static_cast<int>(ExitCode::FAILED);
+    }
+    if (config.format == "json") {
+        // سطر JSON لكل ملف
+        for (size_t row : rows) std::cout << RecoveredIndex::toJson(index.row(row)) << "\n";
+    } else {
+        std::cout << std::left << std::setw(24) << "FILE" << std::setw(6) << "TYPE" << std::right << std::setw(10)
+                  << "SIZE" << std::setw(16) << "OFFSET" << "  " << std::left << std::setw(20) << "DATE"
+                  << std::setw(4) << "GPS" << "DETAILS\n";
+        for (size_t row : rows) {
+            RecoveredIndex::Entry entry = index.row(row);
+            std::string date = entry.date ? std::to_string(entry.date) : "";
+            if (date.size() == 14) {
+                date = date.substr(0, 4) + "-" + date.substr(4, 2) + "-" + date.substr(6, 2) + " " +
+                       date.substr(8, 2) + ":" + date.substr(10, 2) + ":" + date.substr(12, 2);
+            }
+            std::string details;
+            for (const std::string* part : {&entry.make, &entry.model, &entry.author, &entry.title}) {
+                if (part->empty()) continue;
+                if (!details.empty()) details += " | ";
+                details += *part;
+            }
+            std::cout << std::left << std::setw(24) << entry.filename << std::setw(6) << entry.type << std::right
+                      << std::setw(10) << Utils::formatFileSize(entry.size) << std::setw(16) << entry.offset << "  "
+                      << std::left << std::setw(20) << date << std::setw(4) << (entry.gps ? "yes" : "") << details
+                      << "\n";
+        }
+        std::cout << rows.size() << " of " << index.size() << " files\n";
+    }
+    return static_cast<int>(ExitCode::OK);
+}
+
+void BatchCli::writeSummary(const Config& config, const RecoveryJob::Summary& summary) {
+    std::string json = summary.toJson();
+
+    std::ofstream file(config.summaryPath, std::ios::trunc);
+    if (file.is_open()) {
+        file << json << "\n";
+    } else {
+        std::cerr << "[!] Failed to write summary file: " << config.summaryPath << std::endl;
+    }
+
+    if (config.format == "json") {
+        std::cout << json << std::endl;
+        return;
+    }
+
+    std::cout << (summary.success ? "[+] Recovery completed" : "[!] Recovery failed: " + summary.error) << "\n"
+              << " - Device: " << summary.devicePath << "\n"
+              << " - Extents: " << ScanExtents::describe(summary.extents) << "\n"
+              << " - Partition table: " << PartitionTable::schemeName(summary.layout.scheme)
+              << " (" << summary.layout.partitions.size() << " partitions)\n"
+              << " - Scanned: " << Utils::formatFileSize(summary.bytesScanned)
+              << " (" << Utils::formatFileSize(summary.bytesSkipped) << " uniform blocks skipped, "
+              << Utils::formatFileSize(summary.bytesHighEntropy) << " high-entropy)\n"
+              << " - Hits: " << summary.hits << "\n"
+              << " - Files recovered: " << summary.filesRecovered
+              << " (" << Utils::formatFileSize(summary.bytesRecovered) << ")\n"
+              << " - Read errors: " << summary.readErrors << "\n"
+              << " - Write errors: " << summary.writeErrors << "\n"
+              << " - Unreadable: " << Utils::formatFileSize(summary.unreadableBytes)
+              << " (" << Utils::formatFileSize(summary.bytesRecoveredOnRetry) << " recovered on retry)\n"
+              << " - Image: " << (summary.imagePath.empty() ? "none" : summary.imagePath)
+              << " (" << Utils::formatFileSize(summary.bytesImaged) << ")\n"
+              << " - Resumed: " << Utils::formatFileSize(summary.bytesResumed) << " scanned, "
+              << summary.filesResumed << " files\n"
+              << " - Elapsed: " << summary.elapsedSeconds << "s\n";
+    for (const auto& [extension, count] : summary.filesPerType) {
+        std::cout << "   - " << extension << ": " << count << "\n";
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+#include "logger.h"
+#include "recovery_job.h"
+
+// وضع الدفعات: تشغيل مهمة استعادة كاملة من سطر الأوامر بلا أي سؤال للمستخدم.
+// stdout يحمل الملخص فقط (JSON افتراضيًا) والسجلات والتقدم تذهب إلى stderr،
+// وكل مهمة تكتب سجلها وملخصها داخل مجلد الإخراج الخاص بها فيمكن تشغيل عدة مهام معًا.
+class BatchCli {
+public:
+    // رموز الخروج
+    enum class ExitCode : int {
+        OK = 0,             // اكتملت المهمة
+        FAILED = 1,         // تعذر تشغيل المهمة
+        USAGE = 2,          // خطأ في المعاملات
+        PARTIAL = 3,        // اكتملت مع أخطاء قراءة أو كتابة
+        INTERRUPTED = 4     // أوقفت بإشارة؛ نقطة الاستئناف محفوظة
+    };
+
+    struct Config {
+        RecoveryJob::Options job;
+        std::string format = "json";        // json | text
+        std::string summaryPath;            // افتراضيًا <output>/summary.json
+        std::string logFile;                // افتراضيًا <output>/dfr.log
+        std::string signaturesPath;         // قاعدة توقيعات خارجية (فارغ = الجدول المدمج)
+        LogLevel logLevel = LogLevel::INFO;
+        bool progress = false;
+        bool listPartitions = false;
+        bool help = false;
+
+        // وضع الاستعلام: البحث في فهرس مجلد إخراج سابق دون مسح
+        std::string queryDir;
+        std::vector<RecoveredIndex::Filter> where;
+        std::string sortField;
+        bool sortDescending = false;
+        size_t limit = 0;
+    };
+
+    // تشغيل وضع الدفعات وإرجاع رمز الخروج
+    static int run(int argc, char** argv);
+
+    // تحليل المعاملات (يرمي std::invalid_argument عند الخطأ)
+    static Config parse(int argc, char** argv);
+
+    // طباعة طريقة الاستخدام
+    static void printUsage(std::ostream& out);
+
+private:
+    // طباعة الملفات المطابقة من <queryDir>/recovered.idx
+    static int runQuery(const Config& config);
+
+    // كتابة الملخص إلى stdout وإلى ملف الملخص
+    static void writeSummary(const Config& config, const RecoveryJob::Summary& summary);
+};
@@ -0,0 +1,285 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+
+#include <algorithm>
+
+#include "logger.h"
+#include "utils.h"
+#include "disk_reader.h"
+#include "output_manager.h"
+#include "recovery_job.h"
+#include "recovered_index.h"
+#include "scan_stats.h"
+
+#include "synthetic_image.h"
+
+// قياس أداء القراءة ومهمة الاستعادة الكاملة (RecoveryJob كما في وضع الدفعات) على صورة اصطناعية
+// والتحقق من دقة الاستعادة مقابل الحقيقة المرجعية. النتيجة سطر JSON واحد للمقارنة بين الإصدارات
+// (مع --out تُضاف النتائج إلى ملف JSON Lines تراكمي).
+// مراحل المسح والكتابة والبيانات الوصفية من عدادات ScanStats داخل المهمة: زمنها مجموع أزمنة الخيوط،
+// فمعدلها معدل الخيط الواحد، وزمن المهمة كلها في recovery.
+//
+//   cmake --build build --target dfr_bench
+//   ./build/dfr_bench --size-mb 256 --seed 42 --label $(git rev-parse --short HEAD) --out bench.jsonl
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct StageResult {
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+    uint64_t items = 0;
+
+    double gbps() const { return seconds > 0 ? bytes / seconds / 1e9 : 0.0; }
+};
+
+struct TypeAccuracy {
+    uint64_t planted = 0;
+    uint64_t detected = 0;
+    uint64_t exact = 0;
+};
+
+struct Options {
+    SyntheticImage::Config image;
+    std::string label = "local";
+    std::string outPath;
+    std::string workDir = "dfr_bench_work";
+    int repeat = 1;
+    unsigned threads = 0;
+};
+
+// الأسر التي تشترك في التوقيع نفسه تُعتبر تطابقًا صحيحًا
+bool sameFamily(const std::string& planted, const std::string& found) {
+    static const std::set<std::string> zipFamily = {"zip", "docx", "xlsx", "pptx"};
+    if (zipFamily.count(planted) && zipFamily.count(found)) return true;
+    return planted == found;
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// مخزن فارغ لإسكات مخرجات الاستعادة أثناء القياس
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+void printUsage() {
+    std::cerr << "Usage: dfr_bench [--size-mb N] [--seed N] [--files-per-type N] [--zero-noise]\n"
+              << "                 [--repeat N] [--threads N] [--label NAME] [--work-dir DIR] [--out results.json]\n";
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--size-mb") opts.image.imageSize = std::stoull(value()) * 1024 * 1024;
+        else if (arg == "--seed") opts.image.seed = std::stoull(value(), nullptr, 0);
+        else if (arg == "--files-per-type") opts.image.filesPerType = std::stoul(value());
+        else if (arg == "--zero-noise") opts.image.zeroNoise = true;
+        else if (arg == "--repeat") opts.repeat = std::max(1, std::stoi(value()));
+        else if (arg == "--threads") opts.threads = std::stoul(value());
+        else if (arg == "--label") opts.label = value();
+        else if (arg == "--work-dir") opts.workDir = value();
+        else if (arg == "--out") opts.outPath = value();
+        else if (arg == "--help" || arg == "-h") { printUsage(); return false; }
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        if (!parseArgs(argc, argv, opts)) return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "[!] " << e.what() << "\n";
+        printUsage();
+        return 2;
+    }
+
+    Logger::getInstance().setLevel(LogLevel::WARNING);
+    Utils::createDirectoryIfNotExists(opts.workDir);
+
+    // توليد الصورة
+    auto genStart = Clock::now();
+    SyntheticImage image(opts.image);
+    image.generate();
+    const auto& data = image.bytes();
+    const auto& truth = image.groundTruth();
+    double genSeconds = secondsSince(genStart);
+    std::cerr << "[bench] generated " << Utils::formatFileSize(data.size()) << " image with "
+              << truth.size() << " planted files in " << genSeconds << "s\n";
+
+    StageResult readStage, scanStage, carveStage, metadataStage, recoveryStage;
+
+    // القارئ: قراءة الصورة من ملف على قطع (غالبًا من ذاكرة التخزين المؤقت للنظام)
+    std::string imagePath = opts.workDir + "/synthetic.img";
+    if (!image.saveTo(imagePath)) {
+        std::cerr << "[!] Failed to write image to " << imagePath << "\n";
+        return 1;
+    }
+    {
+        DiskReader reader(imagePath);
+        std::vector<uint8_t> buffer(64 * 1024 * 1024);
+        for (int r = 0; r < opts.repeat; ++r) {
+            auto start = Clock::now();
+            for (uint64_t pos = 0; pos < data.size(); pos += buffer.size()) {
+                size_t len = static_cast<size_t>(std::min<uint64_t>(buffer.size(), data.size() - pos));
+                reader.readInto(pos, buffer.data(), len);
+            }
+            readStage.seconds += secondsSince(start);
+            readStage.bytes += data.size();
+        }
+    }
+
+    // الاستعادة: مهمة RecoveryJob كاملة على ملف الصورة كما يشغلها وضع الدفعات
+    // (مسح متوازٍ ثم قياس الأطوال والاحتواء والكتابة والبصمات والفهرس)
+    std::string carveDir = opts.workDir + "/carved";
+    RecoveryJob::Summary summary;
+    RecoveredIndex recovered;
+    ScanStats& stats = ScanStats::getInstance();
+    stats.reset();
+    for (int r = 0; r < opts.repeat; ++r) {
+        std::filesystem::remove_all(carveDir);
+        OutputManager output(carveDir);
+        if (!output.setupDirectories()) {
+            std::cerr << "[!] Failed to create " << carveDir << "\n";
+            return 1;
+        }
+
+        RecoveryJob::Options jobOptions;
+        jobOptions.devicePath = imagePath;
+        jobOptions.outputDir = carveDir;
+        jobOptions.threads = opts.threads;
+        jobOptions.useIndex = false;
+        jobOptions.resume = false;
+
+        NullBuffer nullBuffer;
+        std::streambuf* saved = std::cout.rdbuf(&nullBuffer);
+        auto start = Clock::now();
+        summary = RecoveryJob(jobOptions).run(output);
+        recoveryStage.seconds += secondsSince(start);
+        std::cout.rdbuf(saved);
+
+        if (!summary.success) {
+            std::cerr << "[!] Recovery failed: " << summary.error << "\n";
+            return 1;
+        }
+        recoveryStage.bytes += summary.bytesScanned;
+    }
+    recoveryStage.items = summary.filesRecovered;
+
+    ScanStats::Snapshot snap = stats.snapshot();
+    scanStage = {snap.bytesScanned, snap.scanNanos / 1e9, snap.totalHits};
+    carveStage = {snap.carveBytesWritten, snap.carveNanos / 1e9, snap.filesCarved};
+    metadataStage = {snap.metadataBytes, snap.metadataNanos / 1e9, snap.filesCarved};
+
+    try {
+        if (!recovered.load(summary.recoveredIndexPath)) {
+            std::cerr << "[!] No recovered index at " << summary.recoveredIndexPath << "\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[!] " << e.what() << "\n";
+        return 1;
+    }
+
+    // مطابقة الملفات المستعادة مع الحقيقة المرجعية حسب موقع البداية
+    std::multimap<uint64_t, RecoveredIndex::Entry> carvedByOffset;
+    for (size_t i = 0; i < recovered.size(); ++i) {
+        auto entry = recovered.row(i);
+        carvedByOffset.emplace(entry.offset, entry);
+    }
+
+    std::map<std::string, TypeAccuracy> accuracy;
+    uint64_t truePositiveFiles = 0;
+    for (const auto& file : truth) {
+        accuracy[file.type].planted++;
+        auto range = carvedByOffset.equal_range(file.offset);
+        bool found = false, exactLength = false;
+        for (auto it = range.first; it != range.second; ++it) {
+            if (!sameFamily(file.type, it->second.type)) continue;
+            found = true;
+            exactLength |= it->second.size == file.length;
+            ++truePositiveFiles;
+        }
+        if (found) accuracy[file.type].detected++;
+        if (found && exactLength && !file.fragmented) accuracy[file.type].exact++;
+    }
+    uint64_t falsePositiveFiles = recovered.size() - truePositiveFiles;
+
+    // بناء تقرير JSON
+    uint64_t planted = truth.size(), detected = 0, exact = 0, fragmented = 0;
+    for (const auto& file : truth) fragmented += file.fragmented;
+    for (const auto& [type, acc] : accuracy) { detected += acc.detected; exact += acc.exact; }
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+    json << "{\"label\": \"" << Utils::jsonEscape(opts.label) << "\""
+         << ", \"config\": {\"image_bytes\": " << opts.image.imageSize
+         << ", \"seed\": " << opts.image.seed
+         << ", \"files_per_type\": " << opts.image.filesPerType
+         << ", \"zero_noise\": " << (opts.image.zeroNoise ? "true" : "false")
+         << ", \"repeat\": " << opts.repeat << "}"
+         << ", \"stages\": {";
+
+    auto stageJson = [&](const char* name, const StageResult& s, bool last) {
+        json << "\"" << name << "\": {\"bytes\": " << s.bytes << ", \"seconds\": " << s.seconds
+             << ", \"gbps\": " << s.gbps() << ", \"items\": " << s.items << "}" << (last ? "" : ", ");
+    };
+    stageJson("read", readStage, false);
+    stageJson("scan", scanStage, false);
+    stageJson("carve", carveStage, false);
+    stageJson("metadata", metadataStage, false);
+    stageJson("recovery", recoveryStage, true);
+
+    json << "}, \"accuracy\": {\"planted\": " << planted
+         << ", \"fragmented\": " << fragmented
+         << ", \"detected\": " << detected
+         << ", \"exact_carves\": " << exact
+         << ", \"total_hits\": " << summary.hits
+         << ", \"hits_rejected\": " << summary.hitsRejected
+         << ", \"hits_contained\": " << summary.hitsContained
+         << ", \"files_recovered\": " << recovered.size()
+         << ", \"false_positive_files\": " << falsePositiveFiles
+         << ", \"per_type\": {";
+    bool first = true;
+    for (const auto& [type, acc] : accuracy) {
+        json << (first ? "" : ", ") << "\"" << type << "\": {\"planted\": " << acc.planted
+             << ", \"detected\": " << acc.detected << ", \"exact\": " << acc.exact << "}";
+        first = false;
+    }
+    json << "}}}";
+
+    std::cout << json.str() << std::endl;
+    if (!opts.outPath.empty()) {
+        std::ofstream out(opts.outPath, std::ios::app);
+        out << json.str() << "\n";
+    }
+
+    std::cerr << "[bench] read " << readStage.gbps() << " GB/s | scan " << scanStage.gbps() << " | carve "
+              << carveStage.gbps() << " | metadata " << metadataStage.gbps() << " GB/s per thread | recovery "
+              << recoveryStage.gbps() << " GB/s (" << recoveryStage.seconds << "s)\n"
+              << "[bench] detected " << detected << "/" << planted << ", exact " << exact
+              << "/" << (planted - fragmented) << " unfragmented, false-positive files " << falsePositiveFiles << "\n";
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "synthetic_image.h"
+
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+
+SyntheticImage::SyntheticImage(const Config& config)
+    : config(config), rngState(config.seed) {}
+
+void SyntheticImage::generate() {
+    data.assign(config.imageSize, 0);
+    if (!config.zeroNoise) fillRandom(data.data(), data.size());
+
+    const std::vector<std::string> types = {"jpg", "png", "zip", "pdf", "mp3"};
+    uint64_t slotSize = config.imageSize / (types.size() * config.filesPerType);
+    size_t slot = 0;
+
+    for (size_t i = 0; i < config.filesPerType; ++i) {
+        for (const auto& type : types) {
+            std::vector<uint8_t> file = buildFile(type);
+            uint64_t slotStart = slot++ * slotSize;
+
+            bool aligned = nextDouble() < config.alignedRatio;
+            bool fragmented = nextDouble() < config.fragmentedRatio;
+            uint64_t gap = fragmented ? 4096 * (1 + nextU64() % 8) : 0;
+            uint64_t needed = file.size() + gap;
+            if (needed + 8192 > slotSize) continue;
+
+            uint64_t offset = slotStart + 4096 + nextU64() % (slotSize - needed - 8192);
+            if (aligned) offset &= ~uint64_t(4095);
+            else if (offset % 4096 == 0) offset += 1 + nextU64() % 511;
+
+            if (fragmented) {
+                // الجزء الأول ثم فجوة ضوضاء ثم الباقي
+                size_t split = file.size() / 2;
+                std::copy(file.begin(), file.begin() + split, data.begin() + offset);
+                std::copy(file.begin() + split, file.end(), data.begin() + offset + split + gap);
+            } else {
+                std::copy(file.begin(), file.end(), data.begin() + offset);
+            }
+
+            planted.push_back({type, offset, file.size(), offset % 4096 == 0, fragmented, gap});
+        }
+    }
+
+    std::sort(planted.begin(), planted.end(),
+              [](const PlantedFile& a, const PlantedFile& b) { return a.offset < b.offset; });
+}
+
+bool SyntheticImage::saveTo(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(out);
+}
+
+uint64_t SyntheticImage::nextU64() {
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+double SyntheticImage::nextDouble() {
+    return (nextU64() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void SyntheticImage::fillRandom(uint8_t* dst, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t v = nextU64();
+        std::memcpy(dst + i, &v, 8);
+    }
+    for (; i < size; ++i) dst[i] = static_cast<uint8_t>(nextU64());
+}
+
+std::vector<uint8_t> SyntheticImage::payload(size_t size) {
+    std::vector<uint8_t> out(size);
+    fillRandom(out.data(), size);
+    for (auto& b : out) if (b == 0xFF) b = 0xFE;
+    return out;
+}
+
+size_t SyntheticImage::randomSize(size_t minSize, size_t maxSize) {
+    return minSize + nextU64() % (maxSize - minSize + 1);
+}
+
+std::vector<uint8_t> SyntheticImage::buildFile(const std::string& type) {
+    if (type == "jpg") return buildJpeg();
+    if (type == "png") return buildPng();
+    if (type == "zip") return buildZip();
+    if (type == "pdf") return buildPdf();
+    return buildMp3();
+}
+
+void SyntheticImage::put16BE(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(v >> 8); out.push_back(v & 0xFF);
+}
+
+void SyntheticImage::put32BE(std::vector<uint8_t>& out, uint32_t v) {
+    put16BE(out, v >> 16); put16BE(out, v & 0xFFFF);
+}
+
+void SyntheticImage::put16LE(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(v & 0xFF); out.push_back(v >> 8);
+}
+
+void SyntheticImage::put32LE(std::vector<uint8_t>& out, uint32_t v) {
+    put16LE(out, v & 0xFFFF); put16LE(out, v >> 16);
+}
+
+void SyntheticImage::append(std::vector<uint8_t>& out, const std::string& s) {
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+void SyntheticImage::append(std::vector<uint8_t>& out, const std::vector<uint8_t>& v) {
+    out.insert(out.end(), v.begin(), v.end());
+}
+
+uint32_t SyntheticImage::crc32(const uint8_t* p, size_t n, uint32_t crc) {
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+std::vector<uint8_t> SyntheticImage::buildJpeg() {
+    std::vector<uint8_t> out = {0xFF, 0xD8, 0xFF, 0xE0};
+    put16BE(out, 16);
+    append(out, std::string("JFIF\0", 5));
+    out.insert(out.end(), {0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00});
+    out.insert(out.end(), {0xFF, 0xDB});
+    put16BE(out, 67);
+    out.push_back(0x00);
+    append(out, payload(64));
+    out.insert(out.end(), {0xFF, 0xDA});
+    put16BE(out, 8);
+    out.insert(out.end(), {0x01, 0x01, 0x00, 0x00, 0x3F, 0x00});
+    append(out, payload(randomSize(20 * 1024, 600 * 1024)));
+    out.insert(out.end(), {0xFF, 0xD9});
+    return out;
+}
+
+void SyntheticImage::pngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& body) {
+    put32BE(out, static_cast<uint32_t>(body.size()));
+    size_t crcStart = out.size();
+    out.insert(out.end(), type, type + 4);
+    append(out, body);
+    put32BE(out, crc32(out.data() + crcStart, body.size() + 4));
+}
+
+std::vector<uint8_t> SyntheticImage::buildPng() {
+    std::vector<uint8_t> out = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    std::vector<uint8_t> ihdr;
+    put32BE(ihdr, 640); put32BE(ihdr, 480);
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});
+    pngChunk(out, "IHDR", ihdr);
+    pngChunk(out, "IDAT", payload(randomSize(10 * 1024, 400 * 1024)));
+    pngChunk(out, "IEND", {});
+    return out;
+}
+
+std::vector<uint8_t> SyntheticImage::buildZip() {
+    std::vector<uint8_t> body = payload(randomSize(8 * 1024, 300 * 1024));
+    uint32_t crc = crc32(body.data(), body.size());
+    const std::string name = "data.bin";
+
+    std::vector<uint8_t> out = {0x50, 0x4B, 0x03, 0x04};
+    put16LE(out, 20); put16LE(out, 0); put16LE(out, 0); put16LE(out, 0); put16LE(out, 0);
+    put32LE(out, crc); put32LE(out, body.size()); put32LE(out, body.size());
+    put16LE(out, name.size()); put16LE(out, 0);
+    append(out, name);
+    append(out, body);
+
+    uint32_t cdOffset = out.size();
+    out.insert(out.end(), {0x50, 0x4B, 0x01, 0x02});
+    put16LE(out, 20); put16LE(out, 20); put16LE(out, 0); put16LE(out, 0); put16LE(out, 0); put16LE(out, 0);
+    put32LE(out, crc); put32LE(out, body.size()); put32LE(out, body.size());
+    put16LE(out, name.size()); put16LE(out, 0); put16LE(out, 0); put16LE(out, 0); put16LE(out, 0);
+    put32LE(out, 0); put32LE(out, 0);
+    append(out, name);
+    uint32_t cdSize = out.size() - cdOffset;
+
+    out.insert(out.end(), {0x50, 0x4B, 0x05, 0x06});
+    put16LE(out, 0); put16LE(out, 0); put16LE(out, 1); put16LE(out, 1);
+    put32LE(out, cdSize); put32LE(out, cdOffset); put16LE(out, 0);
+    return out;
+}
+
+std::vector<uint8_t> SyntheticImage::buildPdf() {
+    std::vector<uint8_t> out;
+    append(out, "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+    append(out, "1 0 obj\n<< /Author (Synthetic Bench) /Creator (dfr_bench) >>\nendobj\n");
+    std::vector<uint8_t> stream = payload(randomSize(8 * 1024, 400 * 1024));
+    append(out, "2 0 obj\n<< /Length " + std::to_string(stream.size()) + " >>\nstream\n");
+    append(out, stream);
+    append(out, "\nendstream\nendobj\ntrailer\n<< /Info 1 0 R >>\n%%EOF\n");
+    return out;
+}
+
+std::vector<uint8_t> SyntheticImage::buildMp3() {
+    // نصف الملفات بلا وسم ID3v2 فتبدأ برأس إطار مباشرة
+    std::vector<uint8_t> out;
+    if (nextDouble() < 0.5) {
+        out = {'I', 'D', '3', 3, 0, 0, 0, 0, 0, 10};
+        append(out, payload(10));
+    }
+    size_t frames = randomSize(20, 600);
+    for (size_t i = 0; i < frames; ++i) {
+        out.insert(out.end(), {0xFF, 0xFB, 0x90, 0x00});
+        append(out, payload(417 - 4));
+    }
+    return out;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// مولد صور أقراص اصطناعية قابلة للتكرار لقياس الأداء ودقة الاستعادة
+// الخلفية ضوضاء عشوائية وتُزرع فيها ملفات JPEG/PNG/ZIP/PDF/MP3 في مواقع معروفة
+class SyntheticImage {
+public:
+    // ملف مزروع (الحقيقة المرجعية)
+    struct PlantedFile {
+        std::string type;        // الامتداد المتوقع
+        uint64_t offset;         // بداية الملف في الصورة
+        uint64_t length;         // الطول الكامل للملف
+        bool aligned;            // هل البداية على حد قطاع 4096
+        bool fragmented;         // هل قُسم الملف إلى جزأين بينهما ضوضاء
+        uint64_t fragmentGap;    // حجم الفجوة إن كان مجزأً
+    };
+
+    // إعدادات التوليد
+    struct Config {
+        uint64_t imageSize = 256ull * 1024 * 1024;
+        uint64_t seed = 0x5EED5EED;
+        size_t filesPerType = 8;
+        double fragmentedRatio = 0.25;
+        double alignedRatio = 0.5;
+        bool zeroNoise = false;  // خلفية أصفار بدل الضوضاء (لعزل أثر الإصابات الكاذبة)
+    };
+
+    explicit SyntheticImage(const Config& config);
+
+    // توليد الصورة وقائمة الملفات المزروعة
+    void generate();
+
+    const std::vector<uint8_t>& bytes() const { return data; }
+    const std::vector<PlantedFile>& groundTruth() const { return planted; }
+
+    // حفظ الصورة إلى ملف لقياس القارئ
+    bool saveTo(const std::string& path) const;
+
+private:
+    Config config;
+    uint64_t rngState;
+    std::vector<uint8_t> data;
+    std::vector<PlantedFile> planted;
+
+    // splitmix64: سريع وثابت عبر المنصات
+    uint64_t nextU64();
+
+    double nextDouble();
+
+    void fillRandom(uint8_t* dst, size_t size);
+
+    // بايتات عشوائية لا تحتوي 0xFF (لتجنب علامات JPEG والتزامن الكاذب داخل الملف)
+    std::vector<uint8_t> payload(size_t size);
+
+    size_t randomSize(size_t minSize, size_t maxSize);
+
+    std::vector<uint8_t> buildFile(const std::string& type);
+
+    static void put16BE(std::vector<uint8_t>& out, uint16_t v);
+    static void put32BE(std::vector<uint8_t>& out, uint32_t v);
+    static void put16LE(std::vector<uint8_t>& out, uint16_t v);
+    static void put32LE(std::vector<uint8_t>& out, uint32_t v);
+    static void append(std::vector<uint8_t>& out, const std::string& s);
+    static void append(std::vector<uint8_t>& out, const std::vector<uint8_t>& v);
+
+    static uint32_t crc32(const uint8_t* p, size_t n, uint32_t crc = 0);
+
+    // JPEG: SOI + APP0(JFIF) + DQT + SOS + بيانات مشفرة + EOI
+    std::vector<uint8_t> buildJpeg();
+
+    void pngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& body);
+
+    // PNG: التوقيع + IHDR + IDAT + IEND بقيم CRC صحيحة
+    std::vector<uint8_t> buildPng();
+
+    // ZIP: ملف مخزن واحد + الدليل المركزي + EOCD
+    std::vector<uint8_t> buildZip();
+
+    // PDF: رأس وكائن معلومات وتدفق ثنائي وذيل %%EOF
+    std::vector<uint8_t> buildPdf();
+
+    // MP3: وسم ID3v2 (في نصف الملفات) ثم إطارات MPEG1 Layer III بمعدل 128kbps
+    std::vector<uint8_t> buildMp3();
+};
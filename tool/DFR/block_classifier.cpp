@@ -0,0 +1,222 @@
+#include "block_classifier.h"
+#include "logger.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#include <filesystem>
+
+namespace {
+
+// فوق هذا الحد تكون الكتلة مضغوطة أو مشفرة أو عشوائية (البيانات العشوائية في 4KB تعطي نحو 7.95)
+const double kHighEntropyBits = 7.8;
+
+// هل كل البايتات تساوي data[0]؟ المقارنة بكلمات 64 بت يحولها المترجم إلى تعليمات متجهة
+bool isUniform(const uint8_t* data, size_t size) {
+    uint64_t pattern = 0x0101010101010101ULL * data[0];
+    size_t words = size / sizeof(uint64_t);
+    uint64_t diff = 0;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t word;
+        std::memcpy(&word, data + i * sizeof(uint64_t), sizeof(word));
+        diff |= word ^ pattern;
+    }
+    for (size_t i = words * sizeof(uint64_t); i < size; ++i) diff |= data[i] ^ data[0];
+    return diff == 0;
+}
+
+} // namespace
+
+BlockClassifier::Kind BlockClassifier::classify(const uint8_t* data, size_t size, uint8_t& fill) {
+    if (size == 0) return Kind::DATA;
+    if (isUniform(data, size)) {
+        fill = data[0];
+        return fill == 0 ? Kind::ZERO : Kind::UNIFORM;
+    }
+    return entropy(data, size) >= kHighEntropyBits ? Kind::HIGH_ENTROPY : Kind::DATA;
+}
+
+double BlockClassifier::entropy(const uint8_t* data, size_t size) {
+    if (size == 0) return 0.0;
+
+    // أربعة مدرجات تكرارية متوازية حتى لا تتعطل الكتابات المتتالية على العداد نفسه
+    uint32_t counts[4][256] = {};
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        ++counts[0][data[i]];
+        ++counts[1][data[i + 1]];
+        ++counts[2][data[i + 2]];
+        ++counts[3][data[i + 3]];
+    }
+    for (; i < size; ++i) ++counts[0][data[i]];
+
+    double bits = 0.0;
+    double total = static_cast<double>(size);
+    for (int b = 0; b < 256; ++b) {
+        uint32_t c = counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b];
+        if (c == 0) continue;
+        double p = c / total;
+        bits -= p * std::log2(p);
+    }
+    return bits;
+}
+
+void BlockClassifier::classifyRegion(const uint8_t* data, size_t size, uint64_t baseOffset,
+                                     std::pmr::vector<Run>& runs) {
+    for (size_t pos = 0; pos < size; pos += kBlockSize) {
+        size_t len = std::min(kBlockSize, size - pos);
+        uint8_t fill = 0;
+        Kind kind = classify(data + pos, len, fill);
+
+        if (!runs.empty() && runs.back().kind == kind && runs.back().fill == fill &&
+            runs.back().offset + runs.back().length == baseOffset + pos) {
+            runs.back().length += len;
+        } else {
+            runs.push_back({baseOffset + pos, len, kind, fill});
+        }
+    }
+}
+
+const char* BlockClassifier::kindName(Kind kind) {
+    switch (kind) {
+        case Kind::ZERO: return "zero";
+        case Kind::UNIFORM: return "uniform";
+        case Kind::HIGH_ENTROPY: return "high-entropy";
+        case Kind::DATA: break;
+    }
+    return "data";
+}
+
+void UsageMap::add(const std::pmr::vector<BlockClassifier::Run>& newRuns) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& run : newRuns) {
+        if (run.length == 0) continue;
+        BlockClassifier::Run merged = run;
+        uint64_t end = run.offset + run.length;
+
+        // التصنيف الأحدث يحل محل ما سبق في المنطقة نفسها (مثل خريطة محملة من تشغيل سابق)
+        auto it = runs.lower_bound(run.offset);
+        if (it != runs.begin()) --it;
+        while (it != runs.end() && it->first < end) {
+            BlockClassifier::Run old = it->second;
+            if (old.offset + old.length <= run.offset) {
+                ++it;
+                continue;
+            }
+            it = runs.erase(it);
+            if (old.offset < run.offset) {
+                BlockClassifier::Run head = old;
+                head.length = run.offset - old.offset;
+                runs[head.offset] = head;
+            }
+            if (old.offset + old.length > end) {
+                BlockClassifier::Run tail = old;
+                tail.offset = end;
+                tail.length = old.offset + old.length - end;
+                it = runs.emplace(tail.offset, tail).first;
+                break;
+            }
+        }
+
+        // دمج المنطقة السابقة واللاحقة إن كانتا ملاصقتين ومن النوع نفسه
+        auto next = runs.lower_bound(run.offset);
+        if (next != runs.begin()) {
+            auto prev = std::prev(next);
+            if (prev->second.offset + prev->second.length == merged.offset && prev->second.kind == merged.kind &&
+                prev->second.fill == merged.fill) {
+                merged.offset = prev->second.offset;
+                merged.length += prev->second.length;
+                runs.erase(prev);
+            }
+        }
+        if (next != runs.end() && next->first == merged.offset + merged.length &&
+            next->second.kind == merged.kind && next->second.fill == merged.fill) {
+            merged.length += next->second.length;
+            runs.erase(next);
+        }
+        runs[merged.offset] = merged;
+    }
+}
+
+uint64_t UsageMap::totalBytes(BlockClassifier::Kind kind) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t total = 0;
+    for (const auto& [start, run] : runs) {
+        if (run.kind == kind) total += run.length;
+    }
+    return total;
+}
+
+bool UsageMap::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return runs.empty();
+}
+
+bool UsageMap::save(const std::string& path, const std::string& devicePath) const {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARN("UsageMap", "Cannot write usage map ", tmpPath);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "# DFR usage map for " << devicePath << "\n"
+            << "#      pos        size  kind\n";
+        for (const auto& [start, run] : runs) {
+            out << "0x" << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << start
+                << "  0x" << std::setw(8) << run.length << "  " << BlockClassifier::kindName(run.kind);
+            if (run.kind == BlockClassifier::Kind::UNIFORM) out << " 0x" << std::setw(2) << int(run.fill);
+            out << std::dec << "\n";
+        }
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+bool UsageMap::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::pmr::vector<BlockClassifier::Run> loaded;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string pos, size, kind, fill;
+        if (!(iss >> pos >> size >> kind)) continue;
+        iss >> fill;
+        bool ok = false;
+        BlockClassifier::Run run;
+        run.kind = parseKind(kind, ok);
+        try {
+            if (!ok) throw std::invalid_argument(kind);
+            run.offset = std::stoull(pos, nullptr, 0);
+            run.length = std::stoull(size, nullptr, 0);
+            if (!fill.empty()) run.fill = static_cast<uint8_t>(std::stoul(fill, nullptr, 0));
+        } catch (const std::exception&) {
+            LOG_WARN("UsageMap", "Ignoring malformed line in ", path, ": ", line);
+            continue;
+        }
+        loaded.push_back(run);
+    }
+    add(loaded);
+    return true;
+}
+
+BlockClassifier::Kind UsageMap::parseKind(const std::string& name, bool& ok) {
+    ok = true;
+    for (auto kind : {BlockClassifier::Kind::DATA, BlockClassifier::Kind::ZERO, BlockClassifier::Kind::UNIFORM,
+                      BlockClassifier::Kind::HIGH_ENTROPY}) {
+        if (name == BlockClassifier::kindName(kind)) return kind;
+    }
+    ok = false;
+    return BlockClassifier::Kind::DATA;
+}
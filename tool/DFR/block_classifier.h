@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// تصنيف سريع لكتل القرص قبل المسح: كتل الأصفار والكتل ذات البايت المتكرر لا تحتوي توقيعًا
+// فتُتخطى، والكتل عالية العشوائية (مضغوطة أو مشفرة) تُمسح لكنها تظهر في خريطة الاستخدام.
+class BlockClassifier {
+public:
+    static constexpr size_t kBlockSize = 4096;
+
+    enum class Kind : uint8_t {
+        DATA,
+        ZERO,
+        UNIFORM,        // بايت واحد متكرر غير الصفر (مثل 0xFF في ذاكرة فلاش ممسوحة)
+        HIGH_ENTROPY
+    };
+
+    // مجموعة كتل متتالية من النوع نفسه
+    struct Run {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        Kind kind = Kind::DATA;
+        uint8_t fill = 0;       // البايت المتكرر لـ ZERO و UNIFORM
+    };
+
+    // تصنيف كتلة واحدة (fill يستقبل البايت المتكرر إن كانت موحدة)
+    static Kind classify(const uint8_t* data, size_t size, uint8_t& fill);
+
+    // إنتروبيا شانون بالبت لكل بايت (0..8)
+    static double entropy(const uint8_t* data, size_t size);
+
+    // تصنيف منطقة كتلة كتلة ودمج المتتالي المتشابه (الإزاحات = baseOffset + الموقع)
+    static void classifyRegion(const uint8_t* data, size_t size, uint64_t baseOffset, std::pmr::vector<Run>& runs);
+
+    static const char* kindName(Kind kind);
+};
+
+// خريطة استخدام القرص: مناطق الأصفار والبايت المتكرر والبيانات العشوائية والبيانات العادية.
+// تُملأ من عدة خيوط وتُحفظ بصيغة قريبة من خريطة القطاعات التالفة.
+class UsageMap {
+public:
+    void add(const std::pmr::vector<BlockClassifier::Run>& runs);
+
+    // مجموع البايتات لكل نوع
+    uint64_t totalBytes(BlockClassifier::Kind kind) const;
+
+    bool empty() const;
+
+    // سطر لكل منطقة "0xSTART 0xLENGTH KIND"
+    bool save(const std::string& path, const std::string& devicePath) const;
+    bool load(const std::string& path);
+
+private:
+    mutable std::mutex mutex;
+    // عقد الشجرة من مجمع خاص بالخريطة (محمي بالقفل نفسه) لا من malloc المشترك بين الخيوط
+    std::pmr::unsynchronized_pool_resource pool;
+    std::pmr::map<uint64_t, BlockClassifier::Run> runs{&pool};     // بداية -> منطقة
+
+    static BlockClassifier::Kind parseKind(const std::string& name, bool& ok);
+};
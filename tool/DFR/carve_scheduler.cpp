@@ -0,0 +1,37 @@
+#include "carve_scheduler.h"
+
+#include <algorithm>
+
+void CarveScheduler::sortByOffset(std::vector<SignatureAutomaton::Hit>& hits) {
+    std::stable_sort(hits.begin(), hits.end(),
+                     [](const SignatureAutomaton::Hit& a, const SignatureAutomaton::Hit& b) { return a.offset < b.offset; });
+}
+
+uint64_t CarveScheduler::windowFor(const SignatureAutomaton::Hit& hit, uint64_t defaultWindow) {
+    return hit.signature->maxSize ? hit.signature->maxSize : defaultWindow;
+}
+
+std::vector<CarveScheduler::Batch> CarveScheduler::plan(const std::vector<SignatureAutomaton::Hit>& hits,
+                                                        uint64_t defaultWindow, uint64_t diskSize,
+                                                        uint64_t maxBatchBytes) {
+    std::vector<Batch> batches;
+    for (size_t i = 0; i < hits.size(); ++i) {
+        uint64_t start = hits[i].offset;
+        if (start >= diskSize) continue;
+        uint64_t end = std::min({diskSize, start + windowFor(hits[i], defaultWindow), start + maxBatchBytes});
+
+        if (!batches.empty()) {
+            Batch& current = batches.back();
+            uint64_t currentEnd = current.start + current.length;
+            uint64_t mergedEnd = std::max(currentEnd, end);
+            // متداخلة أو متلاصقة وما زالت ضمن حد الدفعة: قراءة واحدة
+            if (start <= currentEnd && mergedEnd - current.start <= maxBatchBytes) {
+                current.length = mergedEnd - current.start;
+                current.hitCount = i + 1 - current.firstHit;
+                continue;
+            }
+        }
+        batches.push_back({start, end - start, i, 1});
+    }
+    return batches;
+}
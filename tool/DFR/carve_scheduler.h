@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "signature_automaton.h"
+
+// جدولة الاستعادة حسب الموقع على القرص: نوافذ الإصابات المتداخلة أو المتلاصقة تُدمج في قراءة
+// واحدة كبيرة، وكل دفعة تخدم كل ملفاتها من مخزن واحد، فتصبح القراءة شبه متتابعة حتى على الأقراص الدوارة.
+class CarveScheduler {
+public:
+    // قراءة واحدة ومجموعة الإصابات التي تخدمها
+    struct Batch {
+        uint64_t start = 0;
+        uint64_t length = 0;
+        size_t firstHit = 0;        // فهرس أول إصابة في القائمة المرتبة
+        size_t hitCount = 0;
+    };
+
+    // ترتيب الإصابات حسب الموقع (مستقر: الإصابات في الموقع نفسه تبقى بترتيبها)
+    static void sortByOffset(std::vector<SignatureAutomaton::Hit>& hits);
+
+    // نافذة الاستعادة لإصابة: أقصى حجم لنوعها أو الحد العام
+    static uint64_t windowFor(const SignatureAutomaton::Hit& hit, uint64_t defaultWindow);
+
+    // تقسيم إصابات مرتبة إلى دفعات: نافذة كل إصابة [offset, offset + windowFor) مقصوصة على القرص
+    // وعلى maxBatchBytes، ولا تتجاوز الدفعة maxBatchBytes (ما بعد النافذة يُقرأ بالتدفق عند الاستعادة)
+    static std::vector<Batch> plan(const std::vector<SignatureAutomaton::Hit>& hits, uint64_t defaultWindow,
+                                   uint64_t diskSize, uint64_t maxBatchBytes);
+};
@@ -0,0 +1,275 @@
+#include "checkpoint.h"
+#include "logger.h"
+#include "utils.h"
+#include "hit_index.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const kMagic = "DFR-CHECKPOINT 1";
+
+} // namespace
+
+Checkpoint::Checkpoint(const std::string& path, std::chrono::seconds interval)
+    : path(path), interval(interval), lastSave(std::chrono::steady_clock::now()) {}
+
+bool Checkpoint::begin(const Identity& newIdentity, bool allowResume,
+                       const std::vector<const SignatureScanner::FileSignature*>& signatures) {
+    std::lock_guard<std::mutex> lock(mutex);
+    identity = newIdentity;
+    buildChunkMap();
+    carved.clear();
+
+    bool resumed = false;
+    if (allowResume && Utils::fileExists(path)) {
+        resumed = load(signatures);
+        if (!resumed) {
+            // مسح مختلف: البدء من الصفر (الملفات المستعادة من الجهاز نفسه تبقى صالحة)
+            buildChunkMap();
+        }
+    }
+
+    lastSave = std::chrono::steady_clock::now();
+    saveLocked();
+    return resumed;
+}
+
+bool Checkpoint::isChunkDone(size_t chunk) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunkDone[chunk] != 0;
+}
+
+void Checkpoint::completeChunk(size_t chunk, const std::vector<SignatureAutomaton::Hit>& hits) {
+    std::lock_guard<std::mutex> lock(mutex);
+    chunkHits[chunk] = hits;
+    chunkDone[chunk] = 1;
+}
+
+void Checkpoint::addHits(const std::vector<SignatureAutomaton::Hit>& hits) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& hit : hits) {
+        size_t chunk = chunkForOffset(hit.offset);
+        if (chunk != std::string::npos && chunkDone[chunk]) chunkHits[chunk].push_back(hit);
+    }
+}
+
+std::vector<SignatureAutomaton::Hit> Checkpoint::completedHits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<SignatureAutomaton::Hit> hits;
+    for (size_t chunk = 0; chunk < chunkDone.size(); ++chunk) {
+        if (chunkDone[chunk]) hits.insert(hits.end(), chunkHits[chunk].begin(), chunkHits[chunk].end());
+    }
+    std::sort(hits.begin(), hits.end(),
+              [](const SignatureAutomaton::Hit& a, const SignatureAutomaton::Hit& b) { return a.offset < b.offset; });
+    return hits;
+}
+
+bool Checkpoint::findCarved(uint64_t offset, const std::string& extension, CarvedRecord& record) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = carved.find({offset, extension});
+    if (it == carved.end()) return false;
+    record = it->second;
+    return true;
+}
+
+void Checkpoint::recordCarve(uint64_t offset, const std::string& extension, const CarvedRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    carved[{offset, extension}] = record;
+}
+
+int Checkpoint::highestFileNumber() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    int highest = 0;
+    for (const auto& [key, record] : carved) {
+        // الأسماء بالشكل recovered_00042.ext
+        size_t digits = record.filename.find_first_of("0123456789");
+        if (digits == std::string::npos) continue;
+        highest = std::max(highest, std::atoi(record.filename.c_str() + digits));
+    }
+    return highest;
+}
+
+void Checkpoint::maybeSave() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (std::chrono::steady_clock::now() - lastSave < interval) return;
+    saveLocked();
+}
+
+bool Checkpoint::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return saveLocked();
+}
+
+void Checkpoint::buildChunkMap() {
+    chunkExtent.clear();
+    extentFirstChunk.clear();
+    for (size_t e = 0; e < identity.extents.size(); ++e) {
+        extentFirstChunk.push_back(chunkExtent.size());
+        uint64_t chunks = (identity.extents[e].length + identity.chunkSize - 1) / identity.chunkSize;
+        chunkExtent.insert(chunkExtent.end(), chunks, e);
+    }
+    extentFirstChunk.push_back(chunkExtent.size());
+    chunkDone.assign(chunkExtent.size(), 0);
+    chunkHits.assign(chunkExtent.size(), {});
+}
+
+size_t Checkpoint::chunkForOffset(uint64_t offset) const {
+    auto extent = std::upper_bound(identity.extents.begin(), identity.extents.end(), offset,
+                                   [](uint64_t value, const ScanExtent& e) { return value < e.start; });
+    if (extent == identity.extents.begin()) return std::string::npos;
+    size_t index = static_cast<size_t>(extent - identity.extents.begin()) - 1;
+    if (offset >= identity.extents[index].end()) return std::string::npos;
+    return extentFirstChunk[index] + (offset - identity.extents[index].start) / identity.chunkSize;
+}
+
+size_t Checkpoint::contiguousDone(size_t extent) const {
+    size_t chunk = extentFirstChunk[extent];
+    while (chunk < extentFirstChunk[extent + 1] && chunkDone[chunk]) ++chunk;
+    return chunk - extentFirstChunk[extent];
+}
+
+bool Checkpoint::load(const std::vector<const SignatureScanner::FileSignature*>& signatures) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::string line, header;
+    while (std::getline(in, line) && line != "end_identity") header += line + "\n";
+
+    // أول ثلاثة أسطر: الصيغة والجهاز وحجمه
+    std::string expected = identityText();
+    auto deviceLines = [](const std::string& text) {
+        size_t end = 0;
+        for (int i = 0; i < 3 && end != std::string::npos; ++i) end = text.find('\n', end + (i ? 1 : 0));
+        return text.substr(0, end);
+    };
+    bool sameJob = header == expected;
+    bool sameDevice = deviceLines(header) == deviceLines(expected);
+    if (!sameDevice) {
+        LOG_WARN("Checkpoint", "Existing checkpoint ", path, " belongs to another device, starting fresh");
+        return false;
+    }
+    if (!sameJob) {
+        LOG_INFO("Checkpoint", "Scan settings changed since ", path, " was written; keeping only its carved files");
+    }
+
+    // الإصابة تُحفظ بمفتاح توقيعها لا بامتداده، فللنوع الواحد أكثر من توقيع (مثل mp3 بإطار أو بوسم ID3)
+    std::map<std::string, const SignatureScanner::FileSignature*> byKey;
+    for (const auto* signature : signatures) byKey.emplace(HitIndex::keyOf(*signature), signature);
+
+    size_t hitCount = 0;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string kind;
+        iss >> kind;
+
+        if (!sameJob && kind != "carved") continue;
+
+        if (kind == "watermark") {
+            // المقطع منجز حتى هذه الإزاحة (بداية أول قطعة غير منجزة)
+            size_t extent = 0;
+            uint64_t watermark = 0;
+            iss >> extent >> watermark;
+            if (extent >= identity.extents.size()) continue;
+            const ScanExtent& region = identity.extents[extent];
+            uint64_t done = std::min(watermark, region.end()) - std::min(watermark, region.start);
+            size_t chunks = done >= region.length ? extentFirstChunk[extent + 1] - extentFirstChunk[extent]
+                                                  : done / identity.chunkSize;
+            for (size_t c = 0; c < chunks; ++c) chunkDone[extentFirstChunk[extent] + c] = 1;
+        } else if (kind == "hit") {
+            uint64_t offset = 0;
+            std::string key;
+            iss >> offset >> key;
+            auto sig = byKey.find(key);
+            if (sig == byKey.end() && key.find(':') == std::string::npos) {
+                // نقطة استئناف أقدم تحفظ الامتداد وحده
+                sig = std::find_if(byKey.begin(), byKey.end(), [&](const auto& entry) {
+                    return entry.second->extension == key;
+                });
+            }
+            size_t chunk = chunkForOffset(offset);
+            if (sig == byKey.end() || chunk == std::string::npos) continue;
+            chunkHits[chunk].push_back({offset, sig->second});
+            ++hitCount;
+        } else if (kind == "carved") {
+            uint64_t offset = 0;
+            std::string extension;
+            CarvedRecord record;
+            iss >> offset >> extension >> record.size >> record.filename;
+            if (!record.filename.empty()) carved[{offset, extension}] = record;
+        }
+    }
+
+    // إصابات القطع غير المنجزة ستُكتشف مجددًا
+    for (size_t chunk = 0; chunk < chunkDone.size(); ++chunk) {
+        if (!chunkDone[chunk]) chunkHits[chunk].clear();
+    }
+
+    if (!sameJob) return false;
+
+    size_t doneChunks = std::count(chunkDone.begin(), chunkDone.end(), 1);
+    LOG_INFO("Checkpoint", "Resuming from ", path, ": ", doneChunks, "/", chunkDone.size(), " chunks scanned, ",
+             hitCount, " hits, ", carved.size(), " files already carved");
+    return true;
+}
+
+bool Checkpoint::saveLocked() {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARN("Checkpoint", "Cannot write checkpoint ", tmpPath);
+            return false;
+        }
+
+        out << identityText() << "end_identity\n";
+        for (size_t e = 0; e < identity.extents.size(); ++e) {
+            const ScanExtent& region = identity.extents[e];
+            size_t done = contiguousDone(e);
+            uint64_t watermark = std::min(region.end(), region.start + done * identity.chunkSize);
+            out << "watermark " << e << " " << watermark << "\n";
+            for (size_t c = 0; c < done; ++c) {
+                for (const auto& hit : chunkHits[extentFirstChunk[e] + c]) {
+                    out << "hit " << hit.offset << " " << HitIndex::keyOf(*hit.signature) << "\n";
+                }
+            }
+        }
+        for (const auto& [key, record] : carved) {
+            out << "carved " << key.first << " " << key.second << " " << record.size << " " << record.filename << "\n";
+        }
+        if (!out) {
+            LOG_WARN("Checkpoint", "Failed while writing checkpoint ", tmpPath);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        LOG_WARN("Checkpoint", "Cannot replace checkpoint ", path, ": ", ec.message());
+        return false;
+    }
+    lastSave = std::chrono::steady_clock::now();
+    LOG_DEBUG("Checkpoint", "Saved checkpoint with ", carved.size(), " carved files");
+    return true;
+}
+
+std::string Checkpoint::identityText() const {
+    std::ostringstream oss;
+    oss << kMagic << "\n"
+        << "device " << identity.devicePath << "\n"
+        << "device_size " << identity.deviceSize << "\n"
+        << "types " << (identity.types.empty() ? "all" : identity.types) << "\n"
+        << "chunk_size " << identity.chunkSize << "\n";
+    for (const auto& extent : identity.extents) {
+        oss << "extent " << extent.start << " " << extent.length << "\n";
+    }
+    if (!identity.image.empty()) oss << "image " << identity.image << "\n";
+    return oss.str();
+}
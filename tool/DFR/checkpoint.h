@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+#include "scan_extent.h"
+#include "signature_automaton.h"
+
+// نقطة استئناف دورية في مجلد الإخراج: علامة المسح لكل مقطع، الإصابات المكتشفة تحتها، وفهرس الملفات المستعادة.
+// المهمة التي تُعاد على نفس الجهاز وبنفس الإعدادات تتخطى القطع الممسوحة والملفات المكتوبة سابقًا.
+// الملف نصي ويُكتب إلى ملف مؤقت ثم يُعاد تسميته فلا يتلف عند الانقطاع.
+class Checkpoint {
+public:
+    // ما يجب أن يتطابق حتى يصح الاستئناف
+    struct Identity {
+        std::string devicePath;
+        uint64_t deviceSize = 0;
+        std::string types;                  // الأنواع المختارة مفصولة بفواصل
+        uint64_t chunkSize = 0;
+        std::vector<ScanExtent> extents;    // بعد التطبيع
+        std::string image;                  // صورة تُكتب أثناء المسح (إن وُجدت) حتى لا تنقصها قطع
+    };
+
+    struct CarvedRecord {
+        std::string filename;
+        uint64_t size = 0;
+    };
+
+    explicit Checkpoint(const std::string& path, std::chrono::seconds interval = std::chrono::seconds(30));
+
+    // بدء المهمة: تحميل نقطة استئناف مطابقة إن وُجدت (allowResume) وإلا البدء من الصفر.
+    // signatures تُستخدم لربط مفاتيح الإصابات المحفوظة بتوقيعاتها
+    bool begin(const Identity& identity, bool allowResume,
+               const std::vector<const SignatureScanner::FileSignature*>& signatures);
+
+    // عدد القطع الكلي (حسب المقاطع وحجم القطعة) وترقيمها ثابت بين التشغيلات
+    size_t chunkCount() const {
+        return chunkExtent.size();
+    }
+
+    bool isChunkDone(size_t chunk) const;
+
+    // تسجيل انتهاء مسح قطعة مع إصاباتها
+    void completeChunk(size_t chunk, const std::vector<SignatureAutomaton::Hit>& hits);
+
+    // إضافة إصابات لقطع منجزة (مثل ما يُكتشف بعد إعادة قراءة قطاعات تالفة)
+    void addHits(const std::vector<SignatureAutomaton::Hit>& hits);
+
+    // إصابات كل القطع المنجزة (في هذا التشغيل أو في تشغيل سابق) مرتبة حسب الموقع
+    std::vector<SignatureAutomaton::Hit> completedHits() const;
+
+    // هل استُعيد الملف عند هذه الإصابة سابقًا؟
+    bool findCarved(uint64_t offset, const std::string& extension, CarvedRecord& record) const;
+
+    void recordCarve(uint64_t offset, const std::string& extension, const CarvedRecord& record);
+
+    // أكبر رقم في أسماء الملفات المستعادة (لمتابعة الترقيم بعد الاستئناف)
+    int highestFileNumber() const;
+
+    // كتابة نقطة الاستئناف إن مضت الفترة المحددة منذ آخر كتابة
+    void maybeSave();
+
+    // كتابة فورية
+    bool save();
+
+    const std::string& getPath() const {
+        return path;
+    }
+
+private:
+    std::string path;
+    std::chrono::seconds interval;
+    std::chrono::steady_clock::time_point lastSave;
+    mutable std::mutex mutex;
+
+    Identity identity;
+    std::vector<size_t> chunkExtent;                                // القطعة -> المقطع
+    std::vector<size_t> extentFirstChunk;
+    std::vector<uint8_t> chunkDone;
+    std::vector<std::vector<SignatureAutomaton::Hit>> chunkHits;
+    std::map<std::pair<uint64_t, std::string>, CarvedRecord> carved;
+
+    void buildChunkMap();
+    size_t chunkForOffset(uint64_t offset) const;     // npos إن كانت خارج المقاطع
+    size_t contiguousDone(size_t extent) const;
+    bool load(const std::vector<const SignatureScanner::FileSignature*>& signatures);
+    bool saveLocked();
+    std::string identityText() const;
+};
@@ -0,0 +1,52 @@
+#include "containment.h"
+
+#include <algorithm>
+
+bool ContainmentIndex::parsePolicy(const std::string& name, Policy& policy) {
+    if (name == "outer") {
+        policy = Policy::OUTER;
+    } else if (name == "inner") {
+        policy = Policy::INNER;
+    } else if (name == "both") {
+        policy = Policy::BOTH;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* ContainmentIndex::policyName(Policy policy) {
+    switch (policy) {
+        case Policy::OUTER: return "outer";
+        case Policy::INNER: return "inner";
+        case Policy::BOTH: return "both";
+    }
+    return "outer";
+}
+
+void ContainmentIndex::add(uint64_t start, uint64_t end, const std::string& filename, bool exact) {
+    if (!lastStart.empty() && lastStart.front().start != start) lastStart.clear();
+    lastStart.push_back({start, end, filename});
+    if (!exact) return;
+
+    ranges.push_back({start, end, filename});
+    size_t index = ranges.size() - 1;
+    if (!widest.empty() && ranges[widest.back()].end >= end) index = widest.back();
+    widest.push_back(index);
+}
+
+const ContainmentIndex::Range* ContainmentIndex::containerOf(uint64_t offset) const {
+    // آخر نطاق يبدأ قبل offset، ثم أبعد نهاية حتى موقعه
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), offset,
+                               [](const Range& range, uint64_t value) { return range.start < value; });
+    if (it == ranges.begin()) return nullptr;
+    const Range& candidate = ranges[widest[static_cast<size_t>(it - ranges.begin()) - 1]];
+    return candidate.end > offset ? &candidate : nullptr;
+}
+
+const ContainmentIndex::Range* ContainmentIndex::duplicateOf(uint64_t start, uint64_t end) const {
+    for (const auto& range : lastStart) {
+        if (range.start == start && range.end == end) return &range;
+    }
+    return nullptr;
+}
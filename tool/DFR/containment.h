@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// احتواء الملفات المستعادة: ZIP داخل ZIP، JPEG داخل PDF، PNG داخل DOCX، صورة مصغرة داخل صورة.
+// يُبنى من نطاقات الملفات المكتوبة مرتبة حسب البداية، ويجيب بلوغاريتم عددها عن أوسع ملف
+// ذي طول دقيق يقع فيه موقع معطى، وعن ملف مكتوب بالنطاق نفسه تمامًا.
+class ContainmentIndex {
+public:
+    // ما يُكتب حين يقع ملف داخل آخر
+    enum class Policy {
+        OUTER,      // الحاوية فقط (الافتراضي)
+        INNER,      // الملفات الداخلية فقط، والحاوية التي فيها إصابات لا تُكتب
+        BOTH        // الحاوية تُكتب والداخلي يُسجَّل كمرجع إليها دون نسخ بياناته
+    };
+
+    struct Range {
+        uint64_t start = 0;
+        uint64_t end = 0;
+        std::string filename;
+    };
+
+    static bool parsePolicy(const std::string& name, Policy& policy);
+    static const char* policyName(Policy policy);
+
+    // إضافة ملف مكتوب؛ البدايات يجب أن تأتي بترتيب غير تنازلي.
+    // ذو الطول الدقيق فقط حاوية لغيره (الطول التقديري لا يعرف أين ينتهي الملف فعلًا)
+    void add(uint64_t start, uint64_t end, const std::string& filename, bool exact = true);
+
+    // أوسع نطاق دقيق يبدأ قبل offset وينتهي بعده، أو nullptr. نهاية الملف الداخلي لا تهم:
+    // طوله التقديري (تذييل مفقود) يتجاوز حاويته غالبًا وهو مع ذلك جزء منها
+    const Range* containerOf(uint64_t offset) const;
+
+    // ملف مكتوب يبدأ عند start وينتهي عند end تمامًا، أو nullptr: قراءة بديلة للبايتات نفسها
+    // (zip وdocx وxlsx وpptx تطابق PK\x03\x04 كلها) تُكتب مرة واحدة
+    const Range* duplicateOf(uint64_t start, uint64_t end) const;
+
+    size_t size() const {
+        return ranges.size();
+    }
+
+private:
+    std::vector<Range> ranges;      // الحاويات (الأطوال الدقيقة)
+    std::vector<size_t> widest;     // widest[i]: فهرس النطاق ذي أبعد نهاية بين ranges[0..i]
+    std::vector<Range> lastStart;   // كل ما كُتب عند آخر بداية (دقيقًا كان أو تقديريًا)
+};
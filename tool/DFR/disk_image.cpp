@@ -0,0 +1,295 @@
+#include "disk_image.h"
+#include "sha256.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef DFR_HAVE_ZLIB
+    #include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kImageMagic[8] = {'D', 'F', 'R', 'I', 'M', 'G', '1', '\n'};
+const size_t kHeaderSize = 16;          // magic + حجم الجهاز
+const size_t kRecordHeaderSize = 24;    // offset + length + compressedSize
+
+void putU64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint64_t getU64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) value = (value << 8) | in[i];
+    return value;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// ImageWriter
+// ---------------------------------------------------------------------------
+
+ImageWriter::ImageWriter(const Options& options)
+    : options(options) {}
+
+bool ImageWriter::open(std::string& error) {
+#ifndef DFR_HAVE_ZLIB
+    if (options.compress) {
+        error = "compressed images need zlib (rebuild with zlib available)";
+        return false;
+    }
+#endif
+
+    std::error_code ec;
+    bool exists = fs::exists(options.path, ec);
+    bool append = options.append && exists;
+
+    if (options.compress && append) {
+        // متابعة صورة مضغوطة: حذف أي سجل مبتور في نهايتها
+        std::ifstream existing(options.path, std::ios::binary);
+        uint64_t existingSize = 0, validEnd = 0;
+        std::vector<CompressedImage::Record> records;
+        if (!CompressedImage::scan(existing, existingSize, records, validEnd) || existingSize != options.deviceSize) {
+            LOG_WARN("Image", "Existing image ", options.path, " does not match this job, recreating it");
+            append = false;
+        } else {
+            existing.close();
+            fs::resize_file(options.path, validEnd, ec);
+        }
+    }
+
+    if (!append) {
+        std::ofstream create(options.path, std::ios::binary | std::ios::trunc);
+        if (!create.is_open()) {
+            error = "cannot create image " + options.path;
+            return false;
+        }
+        if (options.compress) {
+            uint8_t header[kHeaderSize];
+            std::memcpy(header, kImageMagic, sizeof(kImageMagic));
+            putU64(header + 8, options.deviceSize);
+            create.write(reinterpret_cast<const char*>(header), kHeaderSize);
+        }
+    }
+    if (!options.compress) {
+        // الصورة الخام بحجم الجهاز من البداية (ملف متفرق) فتبقى المواقع مطابقة
+        fs::resize_file(options.path, options.deviceSize, ec);
+        if (ec) {
+            error = "cannot size image " + options.path + ": " + ec.message();
+            return false;
+        }
+    }
+
+    image.open(options.path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!image.is_open()) {
+        error = "cannot open image " + options.path;
+        return false;
+    }
+
+    std::string manifestFile = manifestPath(options.path);
+    manifest.open(manifestFile, append ? std::ios::app : std::ios::trunc);
+    if (!manifest.is_open()) {
+        error = "cannot create image manifest " + manifestFile;
+        return false;
+    }
+    if (!append) {
+        manifest << "# DFR image manifest: SHA-256 of each block in write order (later blocks supersede earlier)\n"
+                 << "# device " << options.devicePath << "\n"
+                 << "# device_size " << options.deviceSize << "\n"
+                 << "# format " << (options.compress ? "zlib" : "raw") << "\n"
+                 << "# offset length sha256\n";
+    }
+
+    LOG_INFO("Image", (append ? "Appending to " : "Writing "), (options.compress ? "compressed" : "raw"),
+             " image ", options.path);
+    return true;
+}
+
+bool ImageWriter::write(uint64_t offset, const uint8_t* data, size_t size) {
+    // البصمة والضغط خارج القفل حتى تعمل الخيوط بالتوازي
+    std::string digest = Sha256::hex(data, size);
+
+    std::vector<uint8_t> compressed;
+#ifdef DFR_HAVE_ZLIB
+    if (options.compress) {
+        uLongf compressedSize = compressBound(static_cast<uLong>(size));
+        compressed.resize(kRecordHeaderSize + compressedSize);
+        if (compress2(compressed.data() + kRecordHeaderSize, &compressedSize, data, static_cast<uLong>(size),
+                      options.compressionLevel) != Z_OK) {
+            LOG_ERROR("Image", "Compression failed for block at ", offset);
+            return false;
+        }
+        compressed.resize(kRecordHeaderSize + compressedSize);
+        putU64(compressed.data(), offset);
+        putU64(compressed.data() + 8, size);
+        putU64(compressed.data() + 16, compressedSize);
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (failed) return false;
+
+    if (options.compress) {
+        image.seekp(0, std::ios::end);
+        image.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+    } else {
+        image.seekp(static_cast<std::streamoff>(offset));
+        image.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+    manifest << offset << " " << size << " " << digest << "\n";
+
+    if (!image || !manifest) {
+        failed = true;
+        LOG_ERROR("Image", "Write to image ", options.path, " failed at offset ", offset);
+        return false;
+    }
+    written += size;
+    return true;
+}
+
+bool ImageWriter::finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    image.flush();
+    manifest.flush();
+    return !failed && image && manifest;
+}
+
+// ---------------------------------------------------------------------------
+// CompressedImage
+// ---------------------------------------------------------------------------
+
+bool CompressedImage::isCompressedImage(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(kImageMagic)] = {};
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, kImageMagic, sizeof(magic)) == 0;
+}
+
+bool CompressedImage::scan(std::istream& in, uint64_t& deviceSize, std::vector<Record>& records, uint64_t& validEnd) {
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    uint8_t header[kHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(header), kHeaderSize) ||
+        std::memcmp(header, kImageMagic, sizeof(kImageMagic)) != 0) {
+        return false;
+    }
+    deviceSize = getU64(header + 8);
+    validEnd = kHeaderSize;
+
+    uint8_t recordHeader[kRecordHeaderSize];
+    while (validEnd + kRecordHeaderSize <= fileSize) {
+        in.seekg(static_cast<std::streamoff>(validEnd));
+        if (!in.read(reinterpret_cast<char*>(recordHeader), kRecordHeaderSize)) break;
+
+        Record record;
+        record.offset = getU64(recordHeader);
+        record.length = getU64(recordHeader + 8);
+        record.compressedSize = getU64(recordHeader + 16);
+        record.filePosition = validEnd + kRecordHeaderSize;
+        if (record.length == 0 || record.offset + record.length > deviceSize ||
+            record.filePosition + record.compressedSize > fileSize) {
+            break;  // سجل مبتور أو تالف: نهاية الجزء السليم
+        }
+        records.push_back(record);
+        validEnd = record.filePosition + record.compressedSize;
+    }
+    in.clear();
+    return true;
+}
+
+CompressedImage::CompressedImage(const std::string& path)
+    : path(path), in(path, std::ios::binary) {
+#ifndef DFR_HAVE_ZLIB
+    throw std::runtime_error("Cannot read compressed image " + path + ": built without zlib");
+#endif
+    uint64_t validEnd = 0;
+    if (!in.is_open() || !scan(in, size, records, validEnd)) {
+        throw std::runtime_error("Not a DFR compressed image: " + path);
+    }
+
+    byOffset.resize(records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        byOffset[i] = i;
+        maxRecordLength = std::max(maxRecordLength, records[i].length);
+    }
+    std::stable_sort(byOffset.begin(), byOffset.end(),
+                     [&](size_t a, size_t b) { return records[a].offset < records[b].offset; });
+    LOG_DEBUG("Image", "Opened compressed image ", path, " with ", records.size(), " blocks");
+}
+
+void CompressedImage::read(uint64_t offset, uint8_t* buffer, size_t length) const {
+    std::memset(buffer, 0, length);
+    uint64_t end = offset + length;
+
+    // السجلات المتقاطعة مع النطاق، ثم تطبيقها بترتيب الكتابة
+    uint64_t searchFrom = offset > maxRecordLength ? offset - maxRecordLength : 0;
+    auto it = std::lower_bound(byOffset.begin(), byOffset.end(), searchFrom,
+                               [&](size_t index, uint64_t value) { return records[index].offset < value; });
+    std::vector<size_t> overlapping;
+    for (; it != byOffset.end() && records[*it].offset < end; ++it) {
+        if (records[*it].offset + records[*it].length > offset) overlapping.push_back(*it);
+    }
+    std::sort(overlapping.begin(), overlapping.end());
+
+    for (size_t index : overlapping) {
+        const Record& record = records[index];
+        auto data = load(index);
+        uint64_t from = std::max(offset, record.offset);
+        uint64_t to = std::min(end, record.offset + record.length);
+        std::memcpy(buffer + (from - offset), data->data() + (from - record.offset), static_cast<size_t>(to - from));
+    }
+}
+
+std::shared_ptr<const std::vector<uint8_t>> CompressedImage::load(size_t index) const {
+    CacheShard& shard = cache[index % kCacheShards];
+    auto cached = [&]() -> std::shared_ptr<const std::vector<uint8_t>> {
+        for (auto it = shard.entries.begin(); it != shard.entries.end(); ++it) {
+            if (it->first != index) continue;
+            shard.entries.splice(shard.entries.begin(), shard.entries, it);
+            return it->second;
+        }
+        return nullptr;
+    };
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto data = cached()) return data;
+    }
+
+    const Record& record = records[index];
+    std::vector<uint8_t> compressed(static_cast<size_t>(record.compressedSize));
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        in.seekg(static_cast<std::streamoff>(record.filePosition));
+        if (!in.read(reinterpret_cast<char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()))) {
+            in.clear();
+            throw std::runtime_error("Short read in compressed image " + path);
+        }
+    }
+
+    auto data = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(record.length));
+#ifdef DFR_HAVE_ZLIB
+    uLongf outSize = static_cast<uLongf>(data->size());
+    if (uncompress(data->data(), &outSize, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK ||
+        outSize != data->size()) {
+        throw std::runtime_error("Corrupt block at offset " + std::to_string(record.offset) + " in " + path);
+    }
+#endif
+
+    // خيط آخر ربما فك السجل نفسه في الأثناء: تبقى نسخته
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto existing = cached()) return existing;
+    shard.entries.emplace_front(index, data);
+    shard.bytes += data->size();
+    while (shard.entries.size() > 1 && shard.bytes > kCacheBytes / kCacheShards) {
+        shard.bytes -= shard.entries.back().second->size();
+        shard.entries.pop_back();
+    }
+    return data;
+}
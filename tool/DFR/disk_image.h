@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <array>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+// صورة القرص تُكتب أثناء المسح نفسه (tee) حتى لا يُقرأ الجهاز مرتين.
+// الصيغة الخام: ملف بحجم الجهاز وكل قطعة في موقعها (المناطق غير الممسوحة فجوات متفرقة).
+// الصيغة المضغوطة (zlib): رأس ثم سجلات متتالية [offset, length, compressedSize, data] يقرؤها CompressedImage،
+// والسجل اللاحق يغطي ما قبله عند التداخل (مثل القطاعات المستعادة عند إعادة المحاولة).
+// ملف <image>.sha256 بجانب الصورة يسجل بصمة SHA-256 لكل كتلة بترتيب الكتابة.
+class ImageWriter {
+public:
+    struct Options {
+        std::string path;
+        std::string devicePath;
+        uint64_t deviceSize = 0;
+        bool compress = false;
+        int compressionLevel = 1;       // سرعة الضغط أهم من نسبته هنا
+        bool append = false;            // متابعة صورة مهمة مستأنفة بدل إنشائها من جديد
+    };
+
+    explicit ImageWriter(const Options& options);
+
+    // فتح الصورة وملف البصمات (false مع رسالة الخطأ عند الفشل)
+    bool open(std::string& error);
+
+    // نسخ كتلة مقروءة إلى الصورة عند موقعها وتسجيل بصمتها (آمنة من عدة خيوط)
+    bool write(uint64_t offset, const uint8_t* data, size_t size);
+
+    // تفريغ كل شيء إلى القرص
+    bool finish();
+
+    uint64_t bytesWritten() const {
+        return written;
+    }
+
+    const std::string& getPath() const {
+        return options.path;
+    }
+
+    static std::string manifestPath(const std::string& imagePath) {
+        return imagePath + ".sha256";
+    }
+
+private:
+    Options options;
+    std::mutex mutex;
+    std::fstream image;
+    std::ofstream manifest;
+    uint64_t written = 0;
+    bool failed = false;
+};
+
+// قارئ الصورة المضغوطة: فهرس السجلات في الذاكرة وفك ضغط عند الطلب مع ذاكرة مؤقتة للسجلات المفكوكة
+class CompressedImage {
+public:
+    // سجل واحد في الملف
+    struct Record {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        uint64_t filePosition = 0;      // موقع البيانات المضغوطة
+        uint64_t compressedSize = 0;
+    };
+
+    // هل يبدأ الملف برأس الصورة المضغوطة؟
+    static bool isCompressedImage(const std::string& path);
+
+    // فتح الصورة وبناء الفهرس (يرمي std::runtime_error)
+    explicit CompressedImage(const std::string& path);
+
+    uint64_t deviceSize() const {
+        return size;
+    }
+
+    // قراءة نطاق من الجهاز الأصلي؛ ما لم يُكتب في الصورة يُعاد أصفارًا
+    void read(uint64_t offset, uint8_t* buffer, size_t length) const;
+
+    // قراءة رأس الصورة وسجلاتها؛ validEnd = نهاية آخر سجل سليم (للمتابعة بعد انقطاع)
+    static bool scan(std::istream& in, uint64_t& deviceSize, std::vector<Record>& records, uint64_t& validEnd);
+
+private:
+    std::string path;
+    uint64_t size = 0;
+    uint64_t maxRecordLength = 0;
+    std::vector<Record> records;        // بترتيب الكتابة
+    std::vector<size_t> byOffset;       // فهارس السجلات مرتبة حسب offset
+
+    // الذاكرة المؤقتة مجزأة حسب رقم السجل، لكل جزء قفله وقائمة LRU بحد من البايتات:
+    // العمال على سجلات مختلفة لا ينتظر بعضهم بعضًا ولا يطرد أحدهم سجل غيره، وفك الضغط خارج الأقفال
+    static constexpr size_t kCacheShards = 8;
+    static constexpr uint64_t kCacheBytes = 512ull << 20;
+
+    struct CacheShard {
+        std::mutex mutex;
+        std::list<std::pair<size_t, std::shared_ptr<const std::vector<uint8_t>>>> entries;  // الأحدث أولًا
+        uint64_t bytes = 0;
+    };
+
+    mutable std::array<CacheShard, kCacheShards> cache;
+    mutable std::mutex fileMutex;       // لقراءة البيانات المضغوطة من الملف فقط
+    mutable std::ifstream in;
+
+    std::shared_ptr<const std::vector<uint8_t>> load(size_t record) const;
+};
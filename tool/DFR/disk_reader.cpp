@@ -1,11 +1,15 @@
+#include "disk_reader.h"
+#include "bad_block_map.h"
+#include "disk_image.h"
+#include "scan_stats.h"
+
 #include <iostream>
 #include <fstream>
-#include <vector>
-#include <string>
-#include <cstdint>
 #include <stdexcept>
-#include <memory>
+#include <algorithm>
 #include <cstring>
+#include <chrono>
+#include <filesystem>
 
 // تحديد نظام التشغيل
 #ifdef _WIN32
@@ -13,187 +17,258 @@
 #else
     #include <sys/types.h>
     #include <sys/stat.h>
+    #include <sys/ioctl.h>
     #include <fcntl.h>
     #include <unistd.h>
     #include <errno.h>
+    #ifdef __linux__
+        #include <linux/fs.h>
+    #endif
 #endif
 
-class DiskReader {
-public:
-    // هيكل لتخزين معلومات القرص
-    struct DiskInfo {
-        uint64_t totalSize;
-        size_t sectorSize;
-        std::string devicePath;
-    };
-
-    // نوع بيانات لتخزين البيانات الثنائية
-    using RawData = std::vector<uint8_t>;
-
-private:
-    DiskInfo diskInfo;
-
-public:
-    // البناء باستخدام مسار القرص
-    explicit DiskReader(const std::string& devicePath, size_t sectorSize = 512)
-        : diskInfo({0, sectorSize, devicePath}) {}
-
-    // الحصول على معلومات القرص
-    const DiskInfo& getDiskInfo() const {
-        return diskInfo;
+namespace {
+
+#ifdef _WIN32
+using DeviceHandle = HANDLE;
+
+// الموقع في OVERLAPPED لا في مؤشر الملف المشترك، فتتوازى القراءات على المقبض نفسه
+bool readAt(HANDLE hDevice, uint64_t offset, uint8_t* buffer, size_t size) {
+    OVERLAPPED position = {};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    DWORD bytesRead = 0;
+    return ReadFile(hDevice, buffer, static_cast<DWORD>(size), &bytesRead, &position) && bytesRead == size;
+}
+#else
+using DeviceHandle = int;
+
+// قراءة كاملة من موقع محدد؛ القراءة القصيرة تُستكمل والفشل أو نهاية الملف = خطأ
+bool readAt(int fd, uint64_t offset, uint8_t* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, buffer + done, size - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
     }
+    return true;
+}
+#endif
 
-    // قراءة قطاع واحد
-    RawData readSector(uint64_t sectorNumber) {
-        return readBytes(sectorNumber * diskInfo.sectorSize, diskInfo.sectorSize);
+// تنصيف الكتلة الفاشلة عند حد قطاع حتى يبقى قطاع واحد غير مقروء
+uint64_t splitRead(DeviceHandle device, uint64_t offset, uint8_t* buffer, size_t size,
+                   size_t sectorSize, BadBlockMap& badBlocks) {
+    if (readAt(device, offset, buffer, size)) return 0;
+
+    uint64_t middle = (offset + size / 2 + sectorSize - 1) / sectorSize * sectorSize;
+    if (middle <= offset || middle >= offset + size) {
+        std::memset(buffer, 0, size);
+        badBlocks.add(offset, size);
+        return size;
     }
 
-    // قراءة عدة قطاعات
-    RawData readSectors(uint64_t startSector, size_t count) {
-        return readBytes(startSector * diskInfo.sectorSize, count * diskInfo.sectorSize);
+    size_t head = static_cast<size_t>(middle - offset);
+    return splitRead(device, offset, buffer, head, sectorSize, badBlocks) +
+           splitRead(device, middle, buffer + head, size - head, sectorSize, badBlocks);
+}
+
+} // namespace
+
+struct DiskReader::Device {
+    DeviceHandle handle;
+    std::string error;      // سبب فشل الفتح (المقبض غير صالح)
+
+    explicit Device(const std::string& path) {
+    #ifdef _WIN32
+        handle = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                            OPEN_EXISTING, 0, NULL);
+        if (handle == INVALID_HANDLE_VALUE) error = "Failed to open disk. Error code: " + std::to_string(GetLastError());
+    #else
+        handle = open(path.c_str(), O_RDONLY);
+        if (handle == -1) error = "Failed to open device: " + std::string(strerror(errno));
+    #endif
     }
 
-    // قراءة بيانات من offset معين
-    RawData readBytes(uint64_t offset, size_t size) {
-        RawData buffer(size);
-
-        #ifdef _WIN32
-            HANDLE hDevice = CreateFile(
-                diskInfo.devicePath.c_str(),
-                GENERIC_READ,
-                FILE_SHARE_READ | FILE_SHARE_WRITE,
-                NULL,
-                OPEN_EXISTING,
-                0,
-                NULL);
-
-            if (hDevice == INVALID_HANDLE_VALUE) {
-                throw std::runtime_error("Failed to open disk. Error code: " + std::to_string(GetLastError()));
-            }
+    ~Device() {
+    #ifdef _WIN32
+        if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+    #else
+        if (handle != -1) close(handle);
+    #endif
+    }
 
-            LARGE_INTEGER li;
-            li.QuadPart = static_cast<LONGLONG>(offset);
-            if (!SetFilePointerEx(hDevice, li, NULL, FILE_BEGIN)) {
-                CloseHandle(hDevice);
-                throw std::runtime_error("Failed to set file pointer.");
-            }
+    Device(const Device&) = delete;
+    Device& operator=(const Device&) = delete;
+};
+
+DiskReader::DiskReader(const std::string& devicePath, size_t sectorSize)
+    : diskInfo({0, sectorSize, devicePath}) {
+    // لا يُقرأ رأس الأجهزة الحقيقية هنا، الصور ملفات عادية فقط
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(devicePath, ec) && CompressedImage::isCompressedImage(devicePath)) {
+        compressedImage = std::make_shared<CompressedImage>(devicePath);
+    } else {
+        // الفتح هنا لا عند أول قراءة، فلا يتسابق عليه العمال؛ فشله يظهر عند القراءة
+        device = std::make_shared<Device>(devicePath);
+    }
+}
 
-            DWORD bytesRead;
-            BOOL result = ReadFile(hDevice, buffer.data(), static_cast<DWORD>(size), &bytesRead, nullptr);
-            CloseHandle(hDevice);
+const DiskReader::Device& DiskReader::openDevice() const {
+    if (!device->error.empty()) throw std::runtime_error(device->error);
+    return *device;
+}
 
-            if (!result || bytesRead != size) {
-                throw std::runtime_error("Failed to read from disk. Bytes read: " + std::to_string(bytesRead));
-            }
+DiskReader::RawData DiskReader::readSector(uint64_t sectorNumber) {
+    return readBytes(sectorNumber * diskInfo.sectorSize, diskInfo.sectorSize);
+}
 
-        #else
-            int fd = open(diskInfo.devicePath.c_str(), O_RDONLY);
-            if (fd == -1) {
-                throw std::runtime_error("Failed to open device: " + std::string(strerror(errno)));
-            }
+DiskReader::RawData DiskReader::readSectors(uint64_t startSector, size_t count) {
+    return readBytes(startSector * diskInfo.sectorSize, count * diskInfo.sectorSize);
+}
 
-            off_t seekResult = lseek(fd, static_cast<off_t>(offset), SEEK_SET);
-            if (seekResult == -1) {
-                close(fd);
-                throw std::runtime_error("Failed to seek in device.");
-            }
+DiskReader::RawData DiskReader::readBytes(uint64_t offset, size_t size) {
+    RawData buffer(size);
+    readInto(offset, buffer.data(), size);
+    return buffer;
+}
 
-            ssize_t bytesRead = read(fd, buffer.data(), size);
-            close(fd);
+void DiskReader::readInto(uint64_t offset, uint8_t* buffer, size_t size) {
+    auto readStart = std::chrono::steady_clock::now();
 
-            if (bytesRead != static_cast<ssize_t>(size)) {
-                throw std::runtime_error("Failed to read from device. Bytes read: " + std::to_string(bytesRead));
-            }
-        #endif
+    if (compressedImage) {
+        if (offset + size > compressedImage->deviceSize()) {
+            throw std::runtime_error("Read beyond end of image at offset " + std::to_string(offset));
+        }
+        compressedImage->read(offset, buffer, size);
+        ScanStats::getInstance().recordRead(size, std::chrono::steady_clock::now() - readStart);
+        return;
+    }
 
-        return buffer;
+    if (!readAt(openDevice().handle, offset, buffer, size)) {
+        throw std::runtime_error("Failed to read " + std::to_string(size) + " bytes from device at offset " +
+                                 std::to_string(offset));
     }
 
-    // حساب حجم القرص (متقدم - يعتمد على النظام)
-    bool detectDiskSize() {
-        #ifdef _WIN32
-            HANDLE hDevice = CreateFile(
-                diskInfo.devicePath.c_str(),
-                GENERIC_READ,
-                FILE_SHARE_READ | FILE_SHARE_WRITE,
-                NULL,
-                OPEN_EXISTING,
-                0,
-                NULL);
-
-            if (hDevice == INVALID_HANDLE_VALUE) {
-                return false;
-            }
+    ScanStats::getInstance().recordRead(size, std::chrono::steady_clock::now() - readStart);
+}
 
-            DISK_GEOMETRY geometry;
-            DWORD bytesReturned;
-            BOOL result = DeviceIoControl(
-                hDevice,
-                IOCTL_DISK_GET_DRIVE_GEOMETRY,
-                nullptr, 0,
-                &geometry, sizeof(geometry),
-                &bytesReturned,
-                nullptr);
-
-            if (!result) {
-                CloseHandle(hDevice);
-                return false;
-            }
+uint64_t DiskReader::readTolerant(uint64_t offset, uint8_t* buffer, size_t size, BadBlockMap& badBlocks) {
+    // الصورة المضغوطة لا تحوي قطاعات تالفة (سبق ملؤها بأصفار عند الالتقاط)
+    if (compressedImage) {
+        readInto(offset, buffer, size);
+        return 0;
+    }
+
+    auto readStart = std::chrono::steady_clock::now();
+    size_t sectorSize = std::max<size_t>(diskInfo.sectorSize, 1);
+
+    uint64_t unreadable = splitRead(openDevice().handle, offset, buffer, size, sectorSize, badBlocks);
+
+    ScanStats& stats = ScanStats::getInstance();
+    stats.recordRead(size - unreadable, std::chrono::steady_clock::now() - readStart);
+    if (unreadable) stats.recordUnreadable(unreadable);
+    return unreadable;
+}
 
-            diskInfo.totalSize = geometry.Cylinders.QuadPart *
-                                 geometry.TracksPerCylinder *
-                                 geometry.SectorsPerTrack *
-                                 geometry.BytesPerSector;
+bool DiskReader::detectDiskSize() {
+    if (compressedImage) {
+        diskInfo.totalSize = compressedImage->deviceSize();
+        return true;
+    }
 
-            diskInfo.sectorSize = geometry.BytesPerSector;
+    #ifdef _WIN32
+        HANDLE hDevice = CreateFile(
+            diskInfo.devicePath.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE,
+            NULL,
+            OPEN_EXISTING,
+            0,
+            NULL);
+
+        if (hDevice == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        DISK_GEOMETRY geometry;
+        DWORD bytesReturned;
+        BOOL result = DeviceIoControl(
+            hDevice,
+            IOCTL_DISK_GET_DRIVE_GEOMETRY,
+            nullptr, 0,
+            &geometry, sizeof(geometry),
+            &bytesReturned,
+            nullptr);
+
+        if (!result) {
             CloseHandle(hDevice);
-            return true;
+            return false;
+        }
 
-        #else
-            struct stat st;
-            if (stat(diskInfo.devicePath.c_str(), &st) != 0) {
-                return false;
-            }
+        diskInfo.totalSize = geometry.Cylinders.QuadPart *
+                             geometry.TracksPerCylinder *
+                             geometry.SectorsPerTrack *
+                             geometry.BytesPerSector;
 
-            // في بعض الأنظمة، يمكن استخدام BLKGETSIZE64 للحصول على الحجم
-            int fd = open(diskInfo.devicePath.c_str(), O_RDONLY);
-            if (fd == -1) return false;
+        diskInfo.sectorSize = geometry.BytesPerSector;
+        CloseHandle(hDevice);
+        return true;
 
-            uint64_t size = 0;
-            if (ioctl(fd, BLKGETSIZE64, &size) == 0) {
-                diskInfo.totalSize = size;
-            } else {
-                close(fd);
-                return false;
-            }
+    #else
+        struct stat st;
+        if (stat(diskInfo.devicePath.c_str(), &st) != 0) {
+            return false;
+        }
 
-            close(fd);
+        // صورة قرص في ملف عادي: الحجم من stat مباشرة
+        if (S_ISREG(st.st_mode)) {
+            diskInfo.totalSize = static_cast<uint64_t>(st.st_size);
             return true;
-        #endif
-        return false;
-    }
-
-    // طباعة بداية البيانات بالشكل الهكسى
-    static void hexDump(const RawData& data, size_t limit = 256) {
-        for (size_t i = 0; i < std::min(data.size(), limit); ++i) {
-            printf("%02X ", data[i]);
-            if ((i + 1) % 16 == 0) std::cout << std::endl;
-            else if ((i + 1) % 8 == 0) std::cout << "  ";
         }
-        std::cout << std::endl;
-    }
 
-    // حفظ البيانات إلى ملف ثنائي
-    static bool saveToFile(const RawData& data, const std::string& filename) {
-        std::ofstream outFile(filename, std::ios::binary);
-        if (!outFile) {
-            std::cerr << "[!] Failed to create output file: " << filename << std::endl;
+        // في بعض الأنظمة، يمكن استخدام BLKGETSIZE64 للحصول على الحجم
+        int fd = open(diskInfo.devicePath.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+
+        uint64_t size = 0;
+        if (ioctl(fd, BLKGETSIZE64, &size) == 0) {
+            diskInfo.totalSize = size;
+
+            // حجم القطاع المنطقي الحقيقي (512 أو 4096) لتقسيم القراءات الفاشلة عند حدوده
+            int logicalSector = 0;
+            if (ioctl(fd, BLKSSZGET, &logicalSector) == 0 && logicalSector > 0) {
+                diskInfo.sectorSize = static_cast<size_t>(logicalSector);
+            }
+        } else {
+            close(fd);
             return false;
         }
 
-        outFile.write(reinterpret_cast<const char*>(data.data()), data.size());
-        outFile.close();
-        std::cout << "[+] Data saved to: " << filename << std::endl;
+        close(fd);
         return true;
+    #endif
+    return false;
+}
+
+void DiskReader::hexDump(const RawData& data, size_t limit) {
+    for (size_t i = 0; i < std::min(data.size(), limit); ++i) {
+        printf("%02X ", data[i]);
+        if ((i + 1) % 16 == 0) std::cout << std::endl;
+        else if ((i + 1) % 8 == 0) std::cout << "  ";
+    }
+    std::cout << std::endl;
+}
+
+bool DiskReader::saveToFile(const RawData& data, const std::string& filename) {
+    std::ofstream outFile(filename, std::ios::binary);
+    if (!outFile) {
+        std::cerr << "[!] Failed to create output file: " << filename << std::endl;
+        return false;
     }
-};
\ No newline at end of file
+
+    outFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+    outFile.close();
+    std::cout << "[+] Data saved to: " << filename << std::endl;
+    return true;
+}
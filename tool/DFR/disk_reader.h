@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <memory>
+
+class BadBlockMap;
+class CompressedImage;
+
+class DiskReader {
+public:
+    // هيكل لتخزين معلومات القرص
+    struct DiskInfo {
+        uint64_t totalSize;
+        size_t sectorSize;
+        std::string devicePath;
+    };
+
+    // نوع بيانات لتخزين البيانات الثنائية
+    using RawData = std::vector<uint8_t>;
+
+private:
+    // مقبض الجهاز المفتوح مرة واحدة؛ القراءة من موقع صريح (pread) فيشترك فيه العمال دون قفل
+    struct Device;
+
+    DiskInfo diskInfo;
+    std::shared_ptr<CompressedImage> compressedImage;   // عند القراءة من صورة DFR مضغوطة
+    std::shared_ptr<Device> device;
+
+    // المقبض المفتوح، أو استثناء بسبب فشل الفتح
+    const Device& openDevice() const;
+
+public:
+    // البناء باستخدام مسار القرص (أو صورة خام أو صورة DFR مضغوطة)
+    explicit DiskReader(const std::string& devicePath, size_t sectorSize = 512);
+
+    // الحصول على معلومات القرص
+    const DiskInfo& getDiskInfo() const {
+        return diskInfo;
+    }
+
+    // قراءة قطاع واحد
+    RawData readSector(uint64_t sectorNumber);
+
+    // قراءة عدة قطاعات
+    RawData readSectors(uint64_t startSector, size_t count);
+
+    // قراءة بيانات من offset معين
+    RawData readBytes(uint64_t offset, size_t size);
+
+    // قراءة بيانات من offset معين إلى ذاكرة يملكها المستدعي
+    void readInto(uint64_t offset, uint8_t* buffer, size_t size);
+
+    // قراءة متسامحة مع القطاعات التالفة على طريقة ddrescue: الكتلة كاملة بقراءة واحدة أولًا،
+    // وعند الفشل تُقسم إلى نصفين متتاليين حتى مستوى القطاع. القطاعات غير المقروءة تُملأ بأصفار
+    // وتُسجل في badBlocks. تُرجع عدد البايتات غير المقروءة (ترمي فقط إن تعذر فتح الجهاز)
+    uint64_t readTolerant(uint64_t offset, uint8_t* buffer, size_t size, BadBlockMap& badBlocks);
+
+    // حساب حجم القرص (متقدم - يعتمد على النظام)
+    bool detectDiskSize();
+
+    // طباعة بداية البيانات بالشكل الهكسى
+    static void hexDump(const RawData& data, size_t limit = 256);
+
+    // حفظ البيانات إلى ملف ثنائي
+    static bool saveToFile(const RawData& data, const std::string& filename);
+};
@@ -1,120 +1,392 @@
+#include "file_rebuilder.h"
+#include "logger.h"
+#include "scan_stats.h"
+#include "iso_bmff.h"
+#include "jpeg_markers.h"
+#include "mpeg_audio.h"
+#include "sha256.h"
+
 #include <iostream>
-#include <vector>
-#include <string>
-#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string_view>
+#include <chrono>
 
 namespace fs = std::filesystem;
 
-class FileRebuilder {
-public:
-    struct RecoveredFile {
-        size_t startOffset;
-        size_t endOffset;
-        std::string extension;
-        std::string filename;
-    };
-
-    // إنشاء مجلد الإخراج إذا لم يكن موجودًا
-    static bool createOutputDirectory(const std::string& path) {
-        try {
-            if (!fs::exists(path)) {
-                if (!fs::create_directories(path)) {
-                    std::cerr << "[!] Failed to create output directory: " << path << std::endl;
-                    return false;
-                }
-            }
-        } catch (const fs::filesystem_error& e) {
-            std::cerr << "[!] Filesystem error: " << e.what() << std::endl;
+namespace {
+
+std::atomic<int> fileCounter{0};
+
+uint16_t le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t le64(const uint8_t* p) {
+    return le32(p) | (static_cast<uint64_t>(le32(p + 4)) << 32);
+}
+
+// مدققات الرأس: ترفض الإصابات العشوائية قبل كتابة أي ملف
+using Validator = bool (*)(const uint8_t* p, size_t n);
+
+bool isZipHeader(const uint8_t* p, size_t n) {
+    // إصدار معقول وطول اسم الملف الأول
+    return n >= 30 && le16(p + 4) < 100 && le16(p + 26) >= 1 && le16(p + 26) <= 1024;
+}
+
+// هل يظهر name في أول 64KB (أسماء أوائل ملفات الأرشيف)؟
+bool containsName(const uint8_t* p, size_t n, std::string_view name) {
+    std::string_view head(reinterpret_cast<const char*>(p), std::min<size_t>(n, 64 * 1024));
+    return head.find(name) != std::string_view::npos;
+}
+
+const std::pair<const char*, Validator> kValidators[] = {
+    {"jpeg", [](const uint8_t* p, size_t n) {
+         // SOI ثم علامة حقيقية (APPn أو DQT أو SOF...)
+         return n >= 4 && p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF && p[3] >= 0xC0 && p[3] != 0xFF;
+     }},
+    {"png", [](const uint8_t* p, size_t n) {
+         return n >= 16 && std::memcmp(p + 8, "\x00\x00\x00\x0DIHDR", 8) == 0;
+     }},
+    {"gif", [](const uint8_t* p, size_t n) {
+         return n >= 6 && (std::memcmp(p, "GIF87a", 6) == 0 || std::memcmp(p, "GIF89a", 6) == 0);
+     }},
+    {"bmp", [](const uint8_t* p, size_t n) {
+         // الحجم الكلي يتسع للرأس، والحقول المحجوزة أصفار، والبكسلات بعد الرأس
+         return n >= 26 && le32(p + 2) >= 26 && le32(p + 6) == 0 && le32(p + 10) >= 26 && le32(p + 10) < le32(p + 2);
+     }},
+    {"ico", [](const uint8_t* p, size_t n) {
+         return n >= 22 && le16(p) == 0 && le16(p + 2) == 1 && le16(p + 4) >= 1 && le16(p + 4) <= 256 && p[9] == 0;
+     }},
+    {"pdf", [](const uint8_t* p, size_t n) {
+         return n >= 6 && std::memcmp(p, "%PDF-", 5) == 0 && p[5] >= '1' && p[5] <= '9';
+     }},
+    {"zip", isZipHeader},
+    // مستندات Office Open XML أرشيفات ZIP يميزها مجلد الأجزاء في أسماء أوائل الملفات
+    {"docx", [](const uint8_t* p, size_t n) { return isZipHeader(p, n) && containsName(p, n, "word/"); }},
+    {"xlsx", [](const uint8_t* p, size_t n) { return isZipHeader(p, n) && containsName(p, n, "xl/"); }},
+    {"pptx", [](const uint8_t* p, size_t n) { return isZipHeader(p, n) && containsName(p, n, "ppt/"); }},
+    {"gzip", [](const uint8_t* p, size_t n) {
+         return n >= 10 && p[2] == 8 && (p[3] & 0xE0) == 0;
+     }},
+    {"riff", [](const uint8_t* p, size_t n) {
+         // نوع الحاوية أربعة محارف مطبوعة
+         return n >= 12 && std::all_of(p + 8, p + 12, [](uint8_t c) { return c >= 0x20 && c < 0x7F; });
+     }},
+    {"ftyp", [](const uint8_t* p, size_t n) {
+         // صندوق ftyp أول الملف بحجم معقول
+         return n >= 12 && std::memcmp(p + 4, "ftyp", 4) == 0 && (p[0] | p[1]) == 0 && p[2] < 0x10 &&
+                (static_cast<uint32_t>(p[2]) << 8 | p[3]) >= 16;
+     }},
+    {"mpeg-audio", [](const uint8_t* p, size_t n) {
+         // تزامن 11 بت وحده يظهر كل 2KB في البيانات العشوائية: نطلب ثلاثة إطارات متتالية بالصيغة نفسها
+         return MpegAudio::hasFrames(p, n, 3);
+     }},
+    {"id3", [](const uint8_t* p, size_t n) {
+         return MpegAudio::id3Length(p, n) != 0;
+     }},
+};
+
+Validator findValidator(const std::string& name) {
+    for (const auto& [validatorName, validator] : kValidators) {
+        if (name == validatorName) return validator;
+    }
+    return nullptr;
+}
+
+// مؤشر إلى [offset, offset + size) من المصدر: من المخزن المقروء مسبقًا إن غطاه، وإلا يُقرأ إلى scratch
+const uint8_t* viewSource(const FileRebuilder::Source& source, uint64_t offset, size_t size,
+                          std::pmr::vector<uint8_t>& scratch) {
+    if (source.cached && offset >= source.cachedOffset &&
+        offset + size <= source.cachedOffset + source.cachedSize) {
+        return source.cached + (offset - source.cachedOffset);
+    }
+    scratch.resize(size);
+    source.read(offset, scratch.data(), size);
+    return scratch.data();
+}
+
+// قراءة حتى size بايت (مقصوصة على نهاية المصدر)، وتُرجع عدد المقروء
+size_t readSource(const FileRebuilder::Source& source, uint64_t offset, uint8_t* out, size_t size) {
+    if (offset >= source.size) return 0;
+    size = static_cast<size_t>(std::min<uint64_t>(size, source.size - offset));
+    if (source.cached && offset >= source.cachedOffset && offset + size <= source.cachedOffset + source.cachedSize) {
+        std::memcpy(out, source.cached + (offset - source.cachedOffset), size);
+    } else {
+        source.read(offset, out, size);
+    }
+    return size;
+}
+
+// هل يشير سجل نهاية الدليل المركزي عند eocd إلى دليل أرشيف يبدأ عند start؟
+// سجل أرشيف داخلي مخزن بلا ضغط يشير إلى دليله هو (إزاحته من بداية الأرشيف الداخلي) فلا يطابق
+bool zipEndMatches(const FileRebuilder::Source& source, uint64_t start, uint64_t eocd) {
+    uint8_t record[22];
+    if (readSource(source, eocd, record, sizeof(record)) != sizeof(record)) return false;
+    uint64_t directorySize = le32(record + 12);
+    uint64_t directoryOffset = le32(record + 16);
+    uint64_t directoryEnd = eocd;
+
+    // ZIP64: الحقول مشبعة والقيم في سجل ZIP64 الذي يدل عليه المحدد قبل السجل مباشرة
+    if (directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF) {
+        uint8_t locator[20];
+        if (eocd < start + sizeof(locator) ||
+            readSource(source, eocd - sizeof(locator), locator, sizeof(locator)) != sizeof(locator) ||
+            le32(locator) != 0x07064B50) {
             return false;
         }
-        return true;
+        uint64_t zip64End = start + le64(locator + 8);
+        uint8_t zip64[56];
+        if (zip64End >= eocd || readSource(source, zip64End, zip64, sizeof(zip64)) != sizeof(zip64) ||
+            le32(zip64) != 0x06064B50) {
+            return false;
+        }
+        directorySize = le64(zip64 + 40);
+        directoryOffset = le64(zip64 + 48);
+        directoryEnd = zip64End;
     }
 
-    // إعادة بناء ملف واحد
-    static RecoveredFile rebuildFile(
-        const std::vector<uint8_t>& data,
-        size_t startOffset,
-        const SignatureScanner::FileSignature& signature,
-        const std::string& outputDir,
-        size_t maxFileSize = 10 * 1024 * 1024) {
+    if (directoryOffset > directoryEnd - start || directorySize != directoryEnd - start - directoryOffset) return false;
+    if (directorySize == 0) return true;
+    uint8_t entry[4];
+    return readSource(source, start + directoryOffset, entry, sizeof(entry)) == sizeof(entry) &&
+           le32(entry) == 0x02014B50;
+}
 
-        size_t endOffset = startOffset + signature.magic.size();
+} // namespace
 
-        // البحث عن نهاية الملف إن كان له توقيع نهاية
-        if (signature.hasEndSignature) {
-            endOffset = SignatureScanner::findEndOfSignature(data, signature, startOffset, maxFileSize);
-            if (endOffset == std::string::npos) {
-                endOffset = startOffset + maxFileSize; // حد افتراضي
-            }
-        } else {
-            // بعض الملفات مثل PDF أو ZIP يمكن حساب حجمها من الرأس
-            size_t calculatedSize = calculateFileSizeFromHeader(data, startOffset);
-            if (calculatedSize > 0) {
-                endOffset = startOffset + calculatedSize;
-            } else {
-                endOffset = startOffset + maxFileSize; // حد افتراضي
+bool FileRebuilder::createOutputDirectory(const std::string& path) {
+    try {
+        if (!fs::exists(path)) {
+            if (!fs::create_directories(path)) {
+                std::cerr << "[!] Failed to create output directory: " << path << std::endl;
+                return false;
             }
         }
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "[!] Filesystem error: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
 
-        // ضمان أن النهاية لا تتجاوز البيانات
-        endOffset = std::min(endOffset, data.size());
+FileRebuilder::RecoveredFile FileRebuilder::rebuildFile(
+    const std::vector<uint8_t>& data,
+    size_t startOffset,
+    const SignatureScanner::FileSignature& signature,
+    const std::string& outputDir,
+    size_t maxFileSize) {
 
-        // استخراج البيانات
-        std::vector<uint8_t> fileData(data.begin() + startOffset, data.begin() + endOffset);
+    // المخزن كله مصدر مقروء مسبقًا، فيُقاس الملف كما في الاستعادة المتدفقة (الرأس أو البنية أو توقيع النهاية)
+    Source source;
+    source.read = [](uint64_t, uint8_t*, size_t) {};   // لا قراءة خارج المخزن: حجم المصدر هو حجمه
+    source.size = data.size();
+    source.cached = data.data();
+    source.cachedSize = data.size();
+    Limits limits;
+    limits.fallbackSize = maxFileSize;
+    limits.maxSize = maxFileSize;
+    return carveFile(source, startOffset, signature, outputDir, limits);
+}
 
-        // توليد اسم ملف
-        std::string filename = generateUniqueFilename(signature.extension);
+FileRebuilder::RecoveredFile FileRebuilder::carveFile(const Source& source, uint64_t offset,
+                                                     const SignatureScanner::FileSignature& signature,
+                                                     const std::string& outputDir, const Limits& limits) {
+    Extent extent = measure(source, offset, signature, limits);
+    return writeFile(source, offset, extent, signature, outputDir, reserveFilename(signature.extension));
+}
 
-        // حفظ الملف
-        std::string outputPath = outputDir + "/" + filename;
-        saveToFile(fileData, outputPath);
+FileRebuilder::Extent FileRebuilder::measure(const Source& source, uint64_t offset,
+                                             const SignatureScanner::FileSignature& signature, const Limits& limits) {
+    uint64_t available = source.size - std::min(source.size, offset);
+    uint64_t fallback = std::min(limits.fallbackSize, available);
+    uint64_t size = 0;
+    bool exact = false;
 
-        return {startOffset, endOffset, signature.extension, filename};
+    // الحجم المعلن في الرأس يُقدم على البحث عن النهاية، فلا يقيده الحد الاحتياطي
+    uint64_t declared = sizeFromHeader(source, offset, signature, fallback);
+    if (declared) {
+        size = std::min(declared, limits.maxSize ? limits.maxSize : declared);
+        exact = size == declared;
+    } else if (signature.hasEndSignature) {
+        uint64_t footerEnd = findFooter(source, offset, signature, fallback);
+        if (footerEnd) {
+            size = footerEnd - offset;
+            exact = true;
+        }
     }
+    if (!size) size = fallback;
+    size = std::min(size, available);
+    LOG_DEBUG("Rebuilder", "Measured ", signature.extension, " [", offset, ", ", offset + size, ")",
+              declared ? " (size from header)" : "");
+    return {size, exact};
+}
 
-    // حفظ البيانات إلى ملف ثنائي
-    static bool saveToFile(const std::vector<uint8_t>& data, const std::string& outputPath) {
-        std::ofstream outFile(outputPath, std::ios::binary);
-        if (!outFile) {
-            std::cerr << "[!] Failed to create output file: " << outputPath << std::endl;
-            return false;
-        }
+std::string FileRebuilder::reserveFilename(const std::string& extension) {
+    return generateUniqueFilename(extension);
+}
 
-        outFile.write(reinterpret_cast<const char*>(data.data()), data.size());
-        outFile.close();
-        std::cout << "[+] Saved recovered file: " << outputPath << std::endl;
-        return true;
+FileRebuilder::RecoveredFile FileRebuilder::writeFile(const Source& source, uint64_t offset, const Extent& extent,
+                                                     const SignatureScanner::FileSignature& signature,
+                                                     const std::string& outputDir, const std::string& filename,
+                                                     bool hash) {
+    auto carveStart = std::chrono::steady_clock::now();
+    uint64_t size = extent.size;
+    std::string outputPath = outputDir + "/" + filename;
+    RecoveredFile failed{static_cast<size_t>(offset), static_cast<size_t>(offset), signature.extension, filename};
+    failed.success = false;
+    std::ofstream outFile(outputPath, std::ios::binary);
+    if (!outFile) {
+        LOG_WARN("Rebuilder", "Failed to create output file: ", outputPath);
+        return failed;
     }
 
-private:
-    // توليد اسم ملف فريد
-    static std::string generateUniqueFilename(const std::string& ext) {
-        static int counter = 0;
-        std::ostringstream oss;
-        oss << "recovered_" << std::setw(5) << std::setfill('0') << ++counter << "." << ext;
-        return oss.str();
+    // النسخ بمخزن ثابت الحجم مهما كبر الملف
+    std::pmr::vector<uint8_t> scratch(source.memory);
+    Sha256 digest;
+    for (uint64_t pos = offset; pos < offset + size && outFile;) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(kStreamBlock, offset + size - pos));
+        const uint8_t* block = viewSource(source, pos, len, scratch);
+        outFile.write(reinterpret_cast<const char*>(block), len);
+        if (hash) digest.update(block, len);
+        pos += len;
+    }
+    outFile.close();
+    if (!outFile) {
+        LOG_WARN("Rebuilder", "Failed while writing output file: ", outputPath);
+        std::error_code ec;
+        fs::remove(outputPath, ec);
+        return failed;
     }
+    ScanStats::getInstance().recordCarve(size, std::chrono::steady_clock::now() - carveStart);
+    LOG_INFO("Rebuilder", "[+] Saved recovered file: ", outputPath);
 
-    // حساب الحجم من رأس الملف (مثل PDF)
-    static size_t calculateFileSizeFromHeader(const std::vector<uint8_t>& data, size_t offset) {
-        if (offset + 32 > data.size()) return 0;
+    return {static_cast<size_t>(offset), static_cast<size_t>(offset + size), signature.extension, filename, extent.exact,
+            hash ? Sha256::toHex(digest.finish()) : ""};
+}
 
-        // مثال على PDF: يحتوي على "%PDF-X.Y"
-        const uint8_t* ptr = data.data() + offset;
-        if (ptr[0] == 0x25 && ptr[1] == 0x50 && ptr[2] == 0x44 && ptr[3] == 0x46) { // %PDF
-            // يمكنك هنا قراءة طول الملف من رأس الملف إن أمكن
-            return 1024 * 1024; // مثال افتراضي
-        }
+size_t FileRebuilder::readAt(const Source& source, uint64_t offset, uint8_t* out, size_t size) {
+    return readSource(source, offset, out, size);
+}
+
+uint64_t FileRebuilder::sizeFromHeader(const Source& source, uint64_t offset,
+                                       const SignatureScanner::FileSignature& signature, uint64_t searchLimit) {
+    uint8_t head[32];
+    size_t n = readSource(source, offset, head, sizeof(head));
+    uint64_t available = source.size - std::min(source.size, offset);
 
-        // يمكنك إضافة المزيد من الحالات لـ DOCX/XLSX/PPTX (ZIP-based)
-        if (ptr[0] == 0x50 && ptr[1] == 0x4B && ptr[2] == 0x03 && ptr[3] == 0x04) { // ZIP/DOCX/XLSX
-            return 1024 * 1024 * 5; // 5MB كحد افتراضي
+    // ISO-BMFF (MP4/MOV): سلسلة الصناديق من ftyp حتى أول صندوق غير معروف
+    if (n >= 12 && std::memcmp(head + 4, "ftyp", 4) == 0 &&
+        (signature.validator.empty() || FileRebuilder::validate(signature, head, n))) {
+        return IsoBmff::fileLength(
+            [&](uint64_t at, uint8_t* out, size_t size) { return readSource(source, at, out, size); }, offset,
+            available);
+    }
+
+    // JPEG: تتبع العلامات حتى EOI الخاص بالصورة (لا EOI الصورة المصغرة) ضمن مدى البحث
+    if (n >= 4 && head[0] == 0xFF && head[1] == 0xD8 && head[2] == 0xFF && findValidator("jpeg")(head, n)) {
+        return JpegMarkers::fileLength(
+            [&](uint64_t at, uint8_t* out, size_t size) { return readSource(source, at, out, size); }, offset,
+            std::min(searchLimit, available), source.memory);
+    }
+
+    // MPEG audio: تتبع رؤوس الإطارات من أول إطار أو بعد وسم ID3v2 حتى انقطاع السلسلة
+    if (signature.validator == "id3" || (signature.validator == "mpeg-audio" && MpegAudio::frameLength(head, n))) {
+        return MpegAudio::fileLength(
+            [&](uint64_t at, uint8_t* out, size_t size) { return readSource(source, at, out, size); }, offset,
+            available, source.memory);
+    }
+
+    // RIFF (WAV/AVI): الطول بعد أول 8 بايتات، والحاوية مبطنة إلى عدد زوجي
+    if (n >= 12 && std::memcmp(head, "RIFF", 4) == 0 && findValidator("riff")(head, n)) {
+        uint64_t size = le32(head + 4) + 8ULL;
+        size += size & 1;
+        return size >= 12 ? size : 0;
+    }
+
+    // BMP: الحجم الكلي في الرأس إن كانت بقية الحقول منطقية
+    if (n >= 26 && head[0] == 'B' && head[1] == 'M' && findValidator("bmp")(head, n)) {
+        return le32(head + 2);
+    }
+
+    return 0;
+}
+
+uint64_t FileRebuilder::findFooter(const Source& source, uint64_t offset,
+                                   const SignatureScanner::FileSignature& signature, uint64_t limit) {
+    const auto& footer = signature.endMagic;
+    if (footer.empty()) return 0;
+    uint64_t end = std::min(source.size, offset + limit);
+
+    // البحث بمخازن متتالية يتداخل كل منها مع سابقه بطول التوقيع ناقص واحد
+    std::pmr::vector<uint8_t> scratch(source.memory);
+    for (uint64_t pos = offset; pos + footer.size() <= end;) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(kStreamBlock, end - pos));
+        const uint8_t* block = viewSource(source, pos, len, scratch);
+        for (const uint8_t* from = block;;) {
+            const uint8_t* found = std::search(from, block + len, footer.begin(), footer.end());
+            if (found == block + len) break;
+            uint64_t footerEnd = pos + (found - block) + footer.size();
+
+            // ZIP: سجل نهاية الدليل المركزي 22 بايتًا يليه تعليق بطوله المذكور فيه، ويُقبل فقط إن
+            // أشار دليله إلى بداية هذا الأرشيف (لا نهاية ZIP مخزن بداخله)
+            static const uint8_t kEocd[] = {0x50, 0x4B, 0x05, 0x06};
+            if (footer.size() == 4 && std::equal(footer.begin(), footer.end(), kEocd)) {
+                if (!zipEndMatches(source, offset, footerEnd - 4)) {
+                    from = found + 1;
+                    continue;
+                }
+                uint8_t eocd[22];
+                readSource(source, footerEnd - 4, eocd, sizeof(eocd));
+                footerEnd = footerEnd - 4 + sizeof(eocd) + le16(eocd + 20);
+            }
+            return std::min(footerEnd, source.size);
         }
+        if (len < footer.size() || pos + len >= end) break;
+        pos += len - (footer.size() - 1);
+    }
+    return 0;
+}
 
-        return 0;
+bool FileRebuilder::saveToFile(const std::vector<uint8_t>& data, const std::string& outputPath) {
+    std::ofstream outFile(outputPath, std::ios::binary);
+    if (!outFile) {
+        std::cerr << "[!] Failed to create output file: " << outputPath << std::endl;
+        return false;
     }
-};
\ No newline at end of file
+
+    outFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+    outFile.close();
+    LOG_INFO("Rebuilder", "[+] Saved recovered file: ", outputPath);
+    return true;
+}
+
+std::string FileRebuilder::generateUniqueFilename(const std::string& ext) {
+    std::ostringstream oss;
+    oss << "recovered_" << std::setw(5) << std::setfill('0') << ++fileCounter << "." << ext;
+    return oss.str();
+}
+
+void FileRebuilder::continueNumberingAfter(int number) {
+    int current = fileCounter.load();
+    while (current < number && !fileCounter.compare_exchange_weak(current, number)) {}
+}
+
+bool FileRebuilder::validate(const SignatureScanner::FileSignature& signature, const uint8_t* data, size_t available) {
+    if (signature.validator.empty()) return true;
+    Validator validator = findValidator(signature.validator);
+    return validator && validator(data, available);
+}
+
+bool FileRebuilder::hasValidator(const std::string& name) {
+    return findValidator(name) != nullptr;
+}
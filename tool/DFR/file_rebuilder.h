@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+
+#include "signature_scanner.h"
+
+class FileRebuilder {
+public:
+    struct RecoveredFile {
+        size_t startOffset;
+        size_t endOffset;
+        std::string extension;
+        std::string filename;
+        bool exactSize = false;     // الطول من بنية الملف نفسه (رأسه أو توقيع نهايته) لا من حد احتياطي
+        std::string sha256;         // بصمة المحتوى المكتوب (hex) إن طُلبت
+        bool success = true;        // false: تعذر إنشاء الملف أو كتابته كاملًا (ولا يبقى منه شيء)
+    };
+
+    // مصدر الاستعادة المتدفقة: دالة قراءة من القرص، ومخزن مقروء مسبقًا (دفعة الجدولة) يُخدم منه ما يقع فيه
+    struct Source {
+        std::function<void(uint64_t offset, uint8_t* buffer, size_t size)> read;
+        uint64_t size = 0;                  // نهاية القرص
+        const uint8_t* cached = nullptr;
+        uint64_t cachedOffset = 0;
+        size_t cachedSize = 0;
+        // ذاكرة المخازن المؤقتة (ما لا يغطيه المخزن المقروء ومؤشر JPEG): مجمع العامل في المهام المتوازية
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource();
+    };
+
+    struct Limits {
+        uint64_t fallbackSize = 10 * 1024 * 1024;   // حين لا يُعرف الحجم من الرأس (ومدى البحث عن توقيع النهاية)
+        uint64_t maxSize = 0;                       // سقف الحجم المقروء من الرأس (0 = نهاية القرص)
+    };
+
+    // نطاق الملف المحسوب قبل الكتابة
+    struct Extent {
+        uint64_t size = 0;
+        bool exact = false;         // من بنية الملف (انظر RecoveredFile::exactSize)
+    };
+
+    // حجم المخزن في الاستعادة المتدفقة: ملف بعدة جيجابايت يُنسخ بهذا القدر من الذاكرة
+    static constexpr size_t kStreamBlock = 1024 * 1024;
+
+    // إنشاء مجلد الإخراج إذا لم يكن موجودًا
+    static bool createOutputDirectory(const std::string& path);
+
+    // إعادة بناء ملف واحد
+    static RecoveredFile rebuildFile(
+        const std::vector<uint8_t>& data,
+        size_t startOffset,
+        const SignatureScanner::FileSignature& signature,
+        const std::string& outputDir,
+        size_t maxFileSize = 10 * 1024 * 1024);
+
+    // استعادة ملف يبدأ عند offset بالتدفق من المصدر إلى الإخراج بمخازن محدودة.
+    // الحجم من رأس الملف أو بنيته إن أمكن (طول RIFF، حجم BMP، صناديق MP4، علامات JPEG)، وإلا توقيع النهاية،
+    // وإلا الحد الاحتياطي. الإزاحات في النتيجة مطلقة على القرص
+    static RecoveredFile carveFile(const Source& source, uint64_t offset,
+                                   const SignatureScanner::FileSignature& signature,
+                                   const std::string& outputDir, const Limits& limits);
+
+    // carveFile على مرحلتين لمن يقرر بين القياس والكتابة (مثل سياسة الاحتواء):
+    // حساب الطول دون كتابة، ثم حجز اسم، ثم كتابة النطاق المقيس
+    static Extent measure(const Source& source, uint64_t offset, const SignatureScanner::FileSignature& signature,
+                          const Limits& limits);
+    static std::string reserveFilename(const std::string& extension);
+    // hash: حساب SHA-256 أثناء النسخ نفسه دون قراءة ثانية.
+    // فشل الإنشاء أو الكتابة (قرص ممتلئ) يُرجع success = false ويحذف الملف الجزئي؛ أخطاء القراءة تُرمى
+    static RecoveredFile writeFile(const Source& source, uint64_t offset, const Extent& extent,
+                                   const SignatureScanner::FileSignature& signature, const std::string& outputDir,
+                                   const std::string& filename, bool hash = false);
+
+    // قراءة حتى size بايت من المصدر (من المخزن المقروء إن غطاها)، وتُرجع عدد المقروء
+    static size_t readAt(const Source& source, uint64_t offset, uint8_t* out, size_t size);
+
+    // حفظ البيانات إلى ملف ثنائي
+    static bool saveToFile(const std::vector<uint8_t>& data, const std::string& outputPath);
+
+    // متابعة ترقيم الأسماء بعد رقم معين (عند استئناف مهمة سابقة)
+    static void continueNumberingAfter(int number);
+
+    // فحص رأس الملف بمدقق التوقيع قبل الاستعادة (التوقيع بلا مدقق يمر دائمًا)
+    static bool validate(const SignatureScanner::FileSignature& signature, const uint8_t* data, size_t available);
+
+    // هل يوجد مدقق بهذا الاسم؟ (لقواعد التوقيعات الخارجية)
+    static bool hasValidator(const std::string& name);
+
+private:
+    // توليد اسم ملف فريد
+    static std::string generateUniqueFilename(const std::string& ext);
+
+    // حجم الملف المعلن في رأسه أو المحسوب من بنيته (0 = غير معروف).
+    // searchLimit مدى المسح في الصيغ التي لا تعلن طولها (JPEG)
+    static uint64_t sizeFromHeader(const Source& source, uint64_t offset, const SignatureScanner::FileSignature& signature,
+                                   uint64_t searchLimit);
+
+    // نهاية الملف بعد أول توقيع نهاية ضمن limit بايت (0 = غير موجود)
+    static uint64_t findFooter(const Source& source, uint64_t offset, const SignatureScanner::FileSignature& signature,
+                               uint64_t limit);
+};
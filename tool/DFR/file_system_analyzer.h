@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// تعريفات لأنظمة الملفات
+enum class FileSystemType {
+    UNKNOWN,
+    FAT32,
+    NTFS
+};
+
+class FileSystemAnalyzer {
+public:
+    struct FileEntry {
+        std::string name;
+        uint64_t size;
+        std::string creationTime;
+        std::string modificationTime;
+        bool deleted;
+    };
+
+    // تحليل البيانات وتوقع نوع نظام الملفات
+    static FileSystemType detectFileSystem(const std::vector<uint8_t>& bootSector);
+
+    // اسم نظام الملفات للعرض والتقارير
+    static const char* fileSystemName(FileSystemType type);
+
+    // تحليل FAT32 واستخراج بيانات أولية
+    static std::vector<FileEntry> analyzeFat32(const std::vector<uint8_t>& data);
+
+    // تحليل NTFS واستخراج بيانات أولية (MFT)
+    static std::vector<FileEntry> analyzeNtfs(const std::vector<uint8_t>& data);
+
+private:
+    // أدوات مساعدة للقراءة
+    static uint16_t readUint16LE(const std::vector<uint8_t>& data, size_t offset);
+
+    static uint32_t readUint32LE(const std::vector<uint8_t>& data, size_t offset);
+
+    static uint64_t readUint64LE(const std::vector<uint8_t>& data, size_t offset);
+};
@@ -0,0 +1,335 @@
+#include "hit_index.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kIndexMagic[8] = {'D', 'F', 'R', 'H', 'I', 'T', 'S', '1'};
+const uint32_t kByteOrderMark = 0x01020304;
+const char* const kManifestMagic = "DFR-HIT-INDEX 1";
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t recordSize;
+    uint64_t count;
+    uint64_t deviceSize;
+};
+static_assert(sizeof(IndexHeader) == 32, "IndexHeader must stay 32 bytes");
+
+// المقاطع ناقص ما غُطي منها (كلاهما مرتب وغير متداخل)
+std::vector<ScanExtent> subtract(const std::vector<ScanExtent>& extents, const std::vector<ScanExtent>& covered) {
+    std::vector<ScanExtent> result;
+    for (const auto& extent : extents) {
+        uint64_t cursor = extent.start;
+        for (const auto& block : covered) {
+            if (block.end() <= cursor) continue;
+            if (block.start >= extent.end()) break;
+            if (block.start > cursor) result.push_back({cursor, block.start - cursor, extent.label});
+            cursor = std::max(cursor, block.end());
+            if (cursor >= extent.end()) break;
+        }
+        if (cursor < extent.end()) result.push_back({cursor, extent.end() - cursor, extent.label});
+    }
+    return result;
+}
+
+} // namespace
+
+HitIndex::HitIndex(const std::string& directory, const std::string& devicePath, uint64_t deviceSize)
+    : indexPath(directory + "/hits.idx"), manifestPath(directory + "/hits.manifest"),
+      devicePath(devicePath), deviceSize(deviceSize) {}
+
+HitIndex::~HitIndex() {
+    unmap();
+}
+
+bool HitIndex::load() {
+    table.clear();
+    idByKey.clear();
+    unmap();
+
+    std::ifstream in(manifestPath);
+    if (!in.is_open()) return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != kManifestMagic) {
+        LOG_WARN("Index", "Ignoring unrecognised hit index manifest ", manifestPath);
+        return false;
+    }
+
+    std::string manifestDevice;
+    uint64_t manifestSize = 0;
+    std::vector<SignatureEntry> entries;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string kind;
+        iss >> kind;
+        if (kind == "device") {
+            std::getline(iss >> std::ws, manifestDevice);
+        } else if (kind == "device_size") {
+            iss >> manifestSize;
+        } else if (kind == "signature") {
+            size_t id = 0;
+            std::string key;
+            iss >> id >> key;
+            if (id != entries.size() || key.empty()) return false;
+            entries.push_back({key, {}});
+        } else if (kind == "covered") {
+            size_t id = 0;
+            ScanExtent extent;
+            iss >> id >> extent.start >> extent.length;
+            if (id >= entries.size()) return false;
+            entries[id].covered.push_back(extent);
+        }
+    }
+
+    if (manifestDevice != devicePath || manifestSize != deviceSize) {
+        LOG_WARN("Index", "Hit index in ", manifestPath, " belongs to another device, rebuilding it");
+        return false;
+    }
+
+    table = std::move(entries);
+    for (uint32_t id = 0; id < table.size(); ++id) {
+        table[id].covered = ScanExtents::normalize(table[id].covered, deviceSize);
+        idByKey[table[id].key] = id;
+    }
+    if (!mapIndex()) {
+        // بيان بلا فهرس سليم لا يصلح: مسح كامل من جديد
+        table.clear();
+        idByKey.clear();
+        return false;
+    }
+
+    LOG_INFO("Index", "Loaded hit index with ", count, " hits for ", table.size(), " signatures");
+    return true;
+}
+
+std::vector<ScanExtent> HitIndex::uncovered(const FileSignature& signature,
+                                            const std::vector<ScanExtent>& extents) const {
+    auto it = idByKey.find(keyOf(signature));
+    if (it == idByKey.end()) return extents;
+    return subtract(extents, table[it->second].covered);
+}
+
+bool HitIndex::commit(const std::vector<Hit>& hits, const std::vector<const FileSignature*>& scanned,
+                      const std::vector<ScanExtent>& extents) {
+    std::vector<Record> merged(records, records + count);
+    merged.reserve(count + hits.size());
+    for (const auto& hit : hits) {
+        merged.push_back({hit.offset, idFor(*hit.signature), score(*hit.signature), 0});
+    }
+    std::sort(merged.begin(), merged.end(), [](const Record& a, const Record& b) {
+        return a.offset != b.offset ? a.offset < b.offset : a.signature < b.signature;
+    });
+    merged.erase(std::unique(merged.begin(), merged.end(),
+                             [](const Record& a, const Record& b) {
+                                 return a.offset == b.offset && a.signature == b.signature;
+                             }),
+                 merged.end());
+
+    // تسجيل التغطية بلا أسماء المقاطع حتى تندمج المتلاصقة
+    for (const auto* signature : scanned) {
+        SignatureEntry& entry = table[idFor(*signature)];
+        for (const auto& extent : extents) entry.covered.push_back({extent.start, extent.length, ""});
+        entry.covered = ScanExtents::normalize(entry.covered, deviceSize);
+    }
+
+    std::string tmpPath = indexPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARN("Index", "Cannot write hit index ", tmpPath);
+            return false;
+        }
+        IndexHeader header{};
+        std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+        header.byteOrder = kByteOrderMark;
+        header.recordSize = sizeof(Record);
+        header.count = merged.size();
+        header.deviceSize = deviceSize;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(merged.data()),
+                  static_cast<std::streamsize>(merged.size() * sizeof(Record)));
+        if (!out) {
+            LOG_WARN("Index", "Failed while writing hit index ", tmpPath);
+            return false;
+        }
+    }
+
+    unmap();
+    std::error_code ec;
+    fs::rename(tmpPath, indexPath, ec);
+    if (ec || !saveManifest() || !mapIndex()) {
+        LOG_WARN("Index", "Cannot update hit index ", indexPath);
+        return false;
+    }
+    LOG_INFO("Index", "Hit index now holds ", count, " hits (", hits.size(), " from this scan)");
+    return true;
+}
+
+std::vector<HitIndex::Hit> HitIndex::hits(const std::vector<const FileSignature*>& signatures,
+                                          const std::vector<ScanExtent>& extents) const {
+    std::unordered_map<uint32_t, const FileSignature*> wanted;
+    for (const auto* signature : signatures) {
+        auto it = idByKey.find(keyOf(*signature));
+        if (it != idByKey.end()) wanted[it->second] = signature;
+    }
+
+    std::vector<Hit> result;
+    if (wanted.empty()) return result;
+    for (const auto& extent : extents) {
+        const Record* it = std::lower_bound(records, records + count, extent.start,
+                                            [](const Record& r, uint64_t value) { return r.offset < value; });
+        for (; it != records + count && it->offset < extent.end(); ++it) {
+            auto sig = wanted.find(it->signature);
+            if (sig != wanted.end()) result.push_back({it->offset, sig->second});
+        }
+    }
+    return result;
+}
+
+uint16_t HitIndex::score(const FileSignature& signature) {
+    // البتات الثابتة في الرأس: 64 بتًا أو أكثر = ثقة كاملة
+    size_t fixedBits = signature.magic.size() * 8;
+    if (!signature.mask.empty()) {
+        fixedBits = 0;
+        for (uint8_t m : signature.mask) fixedBits += std::bitset<8>(m).count();
+    }
+    return static_cast<uint16_t>(std::min<size_t>(100, fixedBits * 100 / 64));
+}
+
+std::string HitIndex::keyOf(const FileSignature& signature) {
+    static const char* digits = "0123456789abcdef";
+    std::string key = signature.extension + ":";
+    auto appendHex = [&](const std::vector<uint8_t>& bytes) {
+        for (uint8_t byte : bytes) {
+            key += digits[byte >> 4];
+            key += digits[byte & 0x0f];
+        }
+    };
+    appendHex(signature.magic);
+    // التوقيعات المقنّعة أو المزاحة من قاعدة خارجية مختلفة عن المدمجة بالبايتات نفسها
+    if (!signature.mask.empty()) {
+        key += "&";
+        appendHex(signature.mask);
+    }
+    if (signature.headerOffset) key += "@" + std::to_string(signature.headerOffset);
+    return key;
+}
+
+uint32_t HitIndex::idFor(const FileSignature& signature) {
+    std::string key = keyOf(signature);
+    auto it = idByKey.find(key);
+    if (it != idByKey.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(table.size());
+    table.push_back({key, {}});
+    idByKey[key] = id;
+    return id;
+}
+
+bool HitIndex::mapIndex() {
+    records = nullptr;
+    count = 0;
+
+#ifndef _WIN32
+    int fd = open(indexPath.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(IndexHeader)) {
+        close(fd);
+        return false;
+    }
+    mappingSize = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        mappingSize = 0;
+        return false;
+    }
+    mapping = base;
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+    const auto* bytes = static_cast<const uint8_t*>(mapping);
+    size_t available = mappingSize;
+#else
+    std::ifstream in(indexPath, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(IndexHeader)) return false;
+    fallback.resize((data.size() - sizeof(IndexHeader)) / sizeof(Record));
+    std::memcpy(fallback.data(), data.data() + sizeof(IndexHeader), fallback.size() * sizeof(Record));
+    const uint8_t* bytes = data.data();
+    size_t available = data.size();
+#endif
+
+    IndexHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    bool valid = std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+                 header.byteOrder == kByteOrderMark && header.recordSize == sizeof(Record) &&
+                 header.deviceSize == deviceSize &&
+                 sizeof(IndexHeader) + header.count * sizeof(Record) <= available;
+    if (!valid) {
+        LOG_WARN("Index", "Hit index ", indexPath, " is corrupt or from another device");
+        unmap();
+        return false;
+    }
+
+#ifndef _WIN32
+    records = reinterpret_cast<const Record*>(bytes + sizeof(IndexHeader));
+#else
+    records = fallback.data();
+#endif
+    count = static_cast<size_t>(header.count);
+    return true;
+}
+
+void HitIndex::unmap() {
+#ifndef _WIN32
+    if (mapping) munmap(mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    fallback.clear();
+    records = nullptr;
+    count = 0;
+}
+
+bool HitIndex::saveManifest() const {
+    std::string tmpPath = manifestPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) return false;
+        out << kManifestMagic << "\n"
+            << "device " << devicePath << "\n"
+            << "device_size " << deviceSize << "\n";
+        for (size_t id = 0; id < table.size(); ++id) {
+            out << "signature " << id << " " << table[id].key << "\n";
+        }
+        for (size_t id = 0; id < table.size(); ++id) {
+            for (const auto& extent : table[id].covered) {
+                out << "covered " << id << " " << extent.start << " " << extent.length << "\n";
+            }
+        }
+        if (!out) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, manifestPath, ec);
+    return !ec;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+
+#include "scan_extent.h"
+#include "signature_automaton.h"
+
+// فهرس دائم لإصابات التوقيعات في مجلد الإخراج حتى لا يُعاد مسح القرص:
+//  hits.idx       سجلات ثابتة الحجم مرتبة حسب الموقع (تُحمَّل بـ mmap)
+//  hits.manifest  جدول التوقيعات والمقاطع التي مُسحت لكل توقيع
+// التشغيل التالي يمسح فقط التوقيعات الجديدة أو المقاطع غير المغطاة، والاستعادة تُقاد من الفهرس.
+class HitIndex {
+public:
+    using FileSignature = SignatureScanner::FileSignature;
+    using Hit = SignatureAutomaton::Hit;
+
+    // سجل كما هو في الملف (ترتيب بايتات المعالج؛ الرأس يحمل علامة للتحقق)
+    struct Record {
+        uint64_t offset;
+        uint32_t signature;     // رقم التوقيع في جدول البيان
+        uint16_t score;         // 0..100: مدى تميز التوقيع (كلما قصر النمط زادت الإصابات الكاذبة)
+        uint16_t flags;         // محجوز
+    };
+    static_assert(sizeof(Record) == 16, "HitIndex::Record must stay 16 bytes");
+
+    HitIndex(const std::string& directory, const std::string& devicePath, uint64_t deviceSize);
+    ~HitIndex();
+
+    HitIndex(const HitIndex&) = delete;
+    HitIndex& operator=(const HitIndex&) = delete;
+
+    // تحميل الفهرس إن وُجد وكان للجهاز نفسه (false = فهرس فارغ)
+    bool load();
+
+    // ما لم يُمسح بعد لهذا التوقيع من المقاطع المطلوبة
+    std::vector<ScanExtent> uncovered(const FileSignature& signature, const std::vector<ScanExtent>& extents) const;
+
+    // دمج إصابات مسح مكتمل وتسجيل تغطيته ثم الحفظ (كتابة ذرية ثم إعادة الربط)
+    bool commit(const std::vector<Hit>& hits, const std::vector<const FileSignature*>& scanned,
+                const std::vector<ScanExtent>& extents);
+
+    // إصابات التوقيعات المطلوبة داخل المقاطع، مرتبة حسب الموقع
+    std::vector<Hit> hits(const std::vector<const FileSignature*>& signatures,
+                          const std::vector<ScanExtent>& extents) const;
+
+    // عدد السجلات في الفهرس
+    size_t size() const {
+        return count;
+    }
+
+    const std::string& getPath() const {
+        return indexPath;
+    }
+
+    // درجة الإصابة حسب طول النمط
+    static uint16_t score(const FileSignature& signature);
+
+    // مفتاح ثابت للتوقيع: الامتداد والنمط (والقناع والإزاحة إن وُجدا)، يميز توقيعات النوع الواحد
+    static std::string keyOf(const FileSignature& signature);
+
+private:
+    struct SignatureEntry {
+        std::string key;                    // الامتداد + النمط بالهكس
+        std::vector<ScanExtent> covered;
+    };
+
+    std::string indexPath;
+    std::string manifestPath;
+    std::string devicePath;
+    uint64_t deviceSize = 0;
+
+    std::vector<SignatureEntry> table;
+    std::map<std::string, uint32_t> idByKey;
+
+    // السجلات المربوطة بالذاكرة
+    const Record* records = nullptr;
+    size_t count = 0;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    std::vector<Record> fallback;           // حيث لا يتوفر mmap
+
+    uint32_t idFor(const FileSignature& signature);
+    bool mapIndex();
+    void unmap();
+    bool saveManifest() const;
+};
@@ -0,0 +1,140 @@
+#include "io_buffer.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <new>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef DFR_HAVE_NUMA
+#include <numa.h>
+#endif
+
+IoBuffer::~IoBuffer() {
+    release();
+}
+
+void IoBuffer::release() {
+#ifdef __linux__
+    if (mapping) munmap(mapping, mappingSize);
+#else
+    delete[] static_cast<uint8_t*>(mapping);
+#endif
+    mapping = nullptr;
+    base = nullptr;
+    mappingSize = capacity = length = 0;
+}
+
+void IoBuffer::resize(size_t size) {
+    if (size <= capacity) {
+        length = size;
+        return;
+    }
+    release();
+    if (size == 0) return;
+
+#ifdef __linux__
+    size_t rounded = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    kind = Pages::NORMAL;
+
+    if (wantHuge) {
+        mapping = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+        } else {
+            kind = Pages::HUGETLB;
+            mappingSize = rounded;
+            base = static_cast<uint8_t*>(mapping);
+        }
+    }
+
+    if (!mapping) {
+        // صفحة كبيرة إضافية للمحاذاة على 2MB حتى تغطي الصفحات الشفافة المخزن كاملًا
+        size_t extra = wantHuge ? kHugePageSize : 0;
+        mapping = mmap(nullptr, rounded + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            throw std::bad_alloc();
+        }
+        mappingSize = rounded + extra;
+        uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+        uintptr_t aligned = wantHuge ? (start + kHugePageSize - 1) / kHugePageSize * kHugePageSize : start;
+        base = reinterpret_cast<uint8_t*>(aligned);
+#ifdef MADV_HUGEPAGE
+        if (wantHuge && madvise(base, rounded, MADV_HUGEPAGE) == 0) kind = Pages::TRANSPARENT_HUGE;
+#endif
+    }
+
+#ifdef DFR_HAVE_NUMA
+    // الصفحات تُخصص عند أول لمس، فالربط قبل القراءة يضعها كلها على العقدة
+    if (node >= 0 && NumaTopology::available()) numa_tonode_memory(base, rounded, node);
+#endif
+    capacity = rounded;
+#else
+    (void)node;
+    mapping = new uint8_t[size];
+    mappingSize = capacity = size;
+    base = static_cast<uint8_t*>(mapping);
+#endif
+    length = size;
+}
+
+const char* IoBuffer::pagesName(Pages pages) {
+    switch (pages) {
+        case Pages::HUGETLB: return "2M huge pages (hugetlbfs)";
+        case Pages::TRANSPARENT_HUGE: return "2M transparent huge pages";
+        case Pages::NORMAL: break;
+    }
+    return "4K pages";
+}
+
+bool NumaTopology::available() {
+#ifdef DFR_HAVE_NUMA
+    static const bool multiNode = numa_available() >= 0 && nodes().size() > 1;
+    return multiNode;
+#else
+    return false;
+#endif
+}
+
+const std::vector<int>& NumaTopology::nodes() {
+    static const std::vector<int> list = [] {
+        std::vector<int> found;
+#if defined(DFR_HAVE_NUMA) && defined(__linux__)
+        cpu_set_t allowed;
+        if (numa_available() >= 0 && sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (!CPU_ISSET(cpu, &allowed)) continue;
+                int node = numa_node_of_cpu(cpu);
+                if (node >= 0 && std::find(found.begin(), found.end(), node) == found.end()) found.push_back(node);
+            }
+            std::sort(found.begin(), found.end());
+        }
+#endif
+        if (found.empty()) found.push_back(0);
+        return found;
+    }();
+    return list;
+}
+
+int NumaTopology::nodeForWorker(unsigned worker) {
+    if (!available()) return -1;
+    return nodes()[worker % nodes().size()];
+}
+
+bool NumaTopology::pinCurrentThread(int node) {
+#ifdef DFR_HAVE_NUMA
+    if (node < 0 || !available()) return false;
+    if (numa_run_on_node(node) != 0) {
+        LOG_WARN("Numa", "Cannot pin worker to node ", node);
+        return false;
+    }
+    return true;
+#else
+    (void)node;
+    return false;
+#endif
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// مخزن قراءة كبير لعامل مسح أو استعادة، مخصص بـ mmap لا من الكومة:
+// - بصفحات 2MB إن طُلب (hugetlbfs المحجوزة، وإلا صفحات شفافة بـ madvise، وإلا صفحات عادية)
+//   فلا يضيع مسح مخزن بحجم 64MB أو 1GB في أخطاء TLB
+// - وعلى عقدة NUMA محددة (حين يتوفر libnuma) فيقرأ كل عامل ويمسح ذاكرة مقبسه
+// المحتوى لا يُحفظ عند التكبير: المخزن يُملأ من القرص في كل قطعة
+class IoBuffer {
+public:
+    enum class Pages {
+        NORMAL,
+        TRANSPARENT_HUGE,   // madvise(MADV_HUGEPAGE)
+        HUGETLB             // MAP_HUGETLB من الصفحات المحجوزة
+    };
+
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    // node < 0 = بلا تثبيت على عقدة
+    explicit IoBuffer(bool hugePages = false, int node = -1) : wantHuge(hugePages), node(node) {}
+    ~IoBuffer();
+
+    IoBuffer(const IoBuffer&) = delete;
+    IoBuffer& operator=(const IoBuffer&) = delete;
+
+    // ضمان سعة size بايت (إعادة التخصيص عند التكبير فقط)
+    void resize(size_t size);
+
+    uint8_t* data() {
+        return base;
+    }
+    const uint8_t* data() const {
+        return base;
+    }
+    size_t size() const {
+        return length;
+    }
+    Pages pages() const {
+        return kind;
+    }
+
+    static const char* pagesName(Pages pages);
+
+private:
+    bool wantHuge;
+    int node;
+    uint8_t* base = nullptr;
+    size_t length = 0;
+    size_t capacity = 0;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    Pages kind = Pages::NORMAL;
+
+    void release();
+};
+
+// طوبولوجيا NUMA من libnuma (عقدة واحدة بدونه): توزيع العمال على العقد وتثبيتهم عليها
+class NumaTopology {
+public:
+    // هل يوجد أكثر من عقدة ومكتبة تدعمها؟
+    static bool available();
+
+    // العقد التي فيها معالجات مسموحة لهذه العملية (على الأقل عقدة 0)
+    static const std::vector<int>& nodes();
+
+    // عقدة العامل رقم worker (توزيع دوري)، أو -1 بلا NUMA
+    static int nodeForWorker(unsigned worker);
+
+    // تثبيت الخيط الحالي على معالجات العقدة (يُرجع false إن تعذر)
+    static bool pinCurrentThread(int node);
+};
@@ -0,0 +1,70 @@
+#include "iso_bmff.h"
+#include "logger.h"
+
+#include <cstring>
+
+namespace {
+
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+uint64_t be64(const uint8_t* p) {
+    return (static_cast<uint64_t>(be32(p)) << 32) | be32(p + 4);
+}
+
+} // namespace
+
+bool IsoBmff::isTopLevelBox(const uint8_t* type) {
+    static const char* const kTypes[] = {
+        "ftyp", "styp", "moov", "mdat", "free", "skip", "wide", "uuid", "meta", "pdin",
+        "moof", "mfra", "sidx", "ssix", "prft", "emsg", "pnot", "junk", "jP  "};
+    for (const char* known : kTypes) {
+        if (std::memcmp(type, known, 4) == 0) return true;
+    }
+    return false;
+}
+
+uint64_t IsoBmff::fileLength(const ReadFn& read, uint64_t offset, uint64_t available) {
+    uint64_t pos = 0;
+    bool sawMedia = false;      // moov أو mdat أو moof: ما يجعل الملف قابلًا للتشغيل
+    size_t boxes = 0;
+
+    while (pos + 8 <= available) {
+        uint8_t header[16];
+        size_t n = read(offset + pos, header, sizeof(header));
+        if (n < 8 || !isTopLevelBox(header + 4)) break;
+        if (boxes == 0 && std::memcmp(header + 4, "ftyp", 4) != 0) return 0;
+
+        uint64_t size = be32(header);
+        uint64_t headerSize = 8;
+        if (size == 1) {
+            // largesize: حجم 64 بت بعد النوع (mdat أكبر من 4GB)
+            if (n < 16) break;
+            size = be64(header + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            // الصندوق يمتد حتى نهاية الملف ولا يُعرف أين تكون
+            LOG_DEBUG("IsoBmff", "Box at ", offset + pos, " runs to end of file, length unknown");
+            return 0;
+        }
+        if (size < headerSize) break;
+
+        if (std::memcmp(header + 4, "moov", 4) == 0 || std::memcmp(header + 4, "mdat", 4) == 0 ||
+            std::memcmp(header + 4, "moof", 4) == 0) {
+            sawMedia = true;
+        }
+        ++boxes;
+
+        // صندوق مبتور بنهاية القرص: الملف حتى النهاية
+        if (size > available - pos) {
+            pos = available;
+            break;
+        }
+        pos += size;
+    }
+
+    if (!sawMedia) return 0;
+    LOG_DEBUG("IsoBmff", "Walked ", boxes, " top-level boxes at ", offset, ": ", pos, " bytes");
+    return pos;
+}
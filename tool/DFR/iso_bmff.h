@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+// حاويات ISO-BMFF (MP4/MOV/3GP/HEIF): طول الملف من سلسلة الصناديق في المستوى الأعلى.
+// كل صندوق يُقرأ رأسه فقط (8 أو 16 بايتًا مع largesize) ويُقفز فوق محتواه، فملف بعدة جيجابايت
+// يُقاس بعدد قراءات يساوي عدد صناديقه.
+class IsoBmff {
+public:
+    // قراءة حتى size بايت عند offset، وتُرجع عدد ما قُرئ (أقل عند نهاية القرص)
+    using ReadFn = std::function<size_t(uint64_t offset, uint8_t* out, size_t size)>;
+
+    // طول الملف الذي يبدأ بصندوق ftyp عند offset، أو 0 إن لم تكن السلسلة ملفًا صالحًا
+    // (لا صندوق بيانات أو تعريف بعد ftyp، أو صندوق بحجم "حتى نهاية الملف")
+    static uint64_t fileLength(const ReadFn& read, uint64_t offset, uint64_t available);
+
+    // هل هذا نوع صندوق معروف في المستوى الأعلى؟
+    static bool isTopLevelBox(const uint8_t* type);
+};
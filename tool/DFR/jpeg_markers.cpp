@@ -0,0 +1,123 @@
+#include "jpeg_markers.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// قارئ بمخزن متحرك: المقاطع القصيرة تُخدم من المخزن والقفزات الطويلة تعيد ملأه
+class Cursor {
+public:
+    Cursor(const JpegMarkers::ReadFn& read, uint64_t base, uint64_t limit, std::pmr::memory_resource* memory)
+        : read(read), base(base), limit(limit), block(kBlock, memory) {}
+
+    bool at(uint64_t pos, uint8_t& value) {
+        if (!fill(pos)) return false;
+        value = block[pos - blockStart];
+        return true;
+    }
+
+    // أول FF عند pos أو بعده (memchr يمسح المخزن بتعليمات المتجهات)
+    bool findFF(uint64_t& pos) {
+        while (fill(pos)) {
+            const uint8_t* start = block.data() + (pos - blockStart);
+            size_t remaining = blockLength - (pos - blockStart);
+            const void* found = std::memchr(start, 0xFF, remaining);
+            if (found) {
+                pos += static_cast<const uint8_t*>(found) - start;
+                return true;
+            }
+            pos += remaining;
+        }
+        return false;
+    }
+
+private:
+    static constexpr size_t kBlock = 64 * 1024;
+
+    const JpegMarkers::ReadFn& read;
+    uint64_t base;
+    uint64_t limit;
+    std::pmr::vector<uint8_t> block;
+    uint64_t blockStart = 0;
+    size_t blockLength = 0;
+
+    bool fill(uint64_t pos) {
+        if (pos >= limit) return false;
+        if (pos >= blockStart && pos < blockStart + blockLength) return true;
+        size_t want = static_cast<size_t>(std::min<uint64_t>(kBlock, limit - pos));
+        blockStart = pos;
+        blockLength = read(base + pos, block.data(), want);
+        return blockLength > 0;
+    }
+};
+
+bool isStandalone(uint8_t marker) {
+    return marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7);
+}
+
+// SOFn: كل C0-CF عدا DHT وJPG وDAC
+bool isFrame(uint8_t marker) {
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+} // namespace
+
+uint64_t JpegMarkers::fileLength(const ReadFn& read, uint64_t offset, uint64_t limit,
+                                 std::pmr::memory_resource* memory) {
+    Cursor cursor(read, offset, limit, memory);
+    uint8_t b0 = 0, b1 = 0;
+    if (!cursor.at(0, b0) || !cursor.at(1, b1) || b0 != 0xFF || b1 != 0xD8) return 0;
+
+    uint64_t pos = 2;
+    int depth = 1;          // SOI داخل السلسلة يفتح صورة متداخلة يغلقها EOI الخاص بها
+    bool sawFrame = false, sawScan = false;
+    size_t segments = 0;
+
+    while (true) {
+        uint8_t marker = 0;
+        if (!cursor.at(pos, b0) || b0 != 0xFF) return 0;
+        // بايتات الحشو FF قبل العلامة
+        do {
+            if (!cursor.at(++pos, marker)) return 0;
+        } while (marker == 0xFF);
+        ++pos;
+
+        if (marker == 0xD9) {
+            if (--depth > 0) continue;
+            if (!sawFrame || !sawScan) return 0;
+            LOG_DEBUG("Jpeg", "Walked ", segments, " segments at ", offset, ": ", pos, " bytes");
+            return pos;
+        }
+        if (marker == 0xD8) {
+            ++depth;
+            continue;
+        }
+        if (isStandalone(marker)) continue;
+        if (marker == 0x00) return 0;
+
+        if (!cursor.at(pos, b0) || !cursor.at(pos + 1, b1)) return 0;
+        uint64_t length = (static_cast<uint64_t>(b0) << 8) | b1;
+        if (length < 2) return 0;
+        pos += length;
+        ++segments;
+        sawFrame = sawFrame || isFrame(marker);
+
+        if (marker == 0xDA) {
+            // بيانات المسح: FF 00 بايت محشو، وRSTn فواصل، وFF FF حشو قبل علامة
+            sawScan = true;
+            while (true) {
+                if (!cursor.findFF(pos) || !cursor.at(pos + 1, b1)) return 0;
+                if (b1 == 0xFF) {
+                    ++pos;
+                } else if (b1 == 0x00 || (b1 >= 0xD0 && b1 <= 0xD7)) {
+                    pos += 2;
+                } else {
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+
+// JPEG: طول الملف بتتبع مقاطع العلامات من SOI حتى EOI المطابق.
+// المقاطع ذات الطول (ومنها APP1 الذي يحمل الصورة المصغرة في EXIF) يُقفز فوقها، وبيانات المسح
+// المرمّزة يُبحث فيها عن FF متبوع بعلامة حقيقية (لا 00 ولا RSTn)، فلا تُقطع الصورة عند EOI المصغرة.
+class JpegMarkers {
+public:
+    using ReadFn = std::function<size_t(uint64_t offset, uint8_t* out, size_t size)>;
+
+    // طول الملف الذي يبدأ بـ FF D8 عند offset مع البحث ضمن limit بايت،
+    // أو 0 إن انقطعت السلسلة أو لم يكن فيها إطار ومسح قبل EOI (memory لمخزن القراءة)
+    static uint64_t fileLength(const ReadFn& read, uint64_t offset, uint64_t limit,
+                               std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+};
@@ -1,34 +1,21 @@
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <sstream>
+#include "logger.h"
+
 #include <iomanip>
 #include <ctime>
-#include <mutex>
-
-// مستويات التسجيل
-enum class LogLevel {
-    DEBUG,
-    INFO,
-    WARNING,
-    ERROR
-};
-
-class Logger {
-public:
-    // Singleton Instance
-    static Logger& getInstance() {
-        static Logger instance;
-        return instance;
-    }
+#include <cstring>
 
-    // تحديد مستوى التسجيل الحالي
-    void setLevel(LogLevel level) {
-        currentLevel = level;
-    }
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+Logger& Logger::getInstance() {
+    static Logger instance;
+    return instance;
+}
 
-    // تعيين مسار ملف السجل
-    bool setLogFile(const std::string& path) {
+bool Logger::setLogFile(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
         if (logFile.is_open()) {
             logFile.close();
         }
@@ -40,112 +27,260 @@ public:
         }
 
         logToFileEnabled = true;
-        log("Logger", "Log file opened successfully at " + path, LogLevel::INFO);
-        return true;
     }
+    log("Logger", "Log file opened successfully at " + path, LogLevel::INFO);
+    return true;
+}
 
-    // تسجيل رسالة
-    void log(const std::string& tag, const std::string& message, LogLevel level = LogLevel::INFO) {
-        std::lock_guard<std::mutex> lock(mutex); // Thread-safe
+void Logger::enableAsync() {
+    enableAsync(AsyncConfig());
+}
 
-        if (level < currentLevel) return;
+void Logger::enableAsync(const AsyncConfig& config) {
+    std::lock_guard<std::mutex> control(asyncControl);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (asyncEnabled.load(std::memory_order_acquire)) return;
 
-        std::string levelStr = toString(level);
-        std::string timestamp = getCurrentTimestamp();
+    // لا منتج يحمل الطابور القديم: disableAsync انتظرهم، والجدد يرون الوضع معطلًا حتى نهاية التبديل
 
-        std::ostringstream oss;
-        oss << "[" << timestamp << "] [" << levelStr << "] [" << tag << "] " << message;
+    asyncConfig = config;
+    queue.reset(new MpscRingBuffer<Record>(config.queueCapacity));
+    droppedRecords.store(0, std::memory_order_relaxed);
+    stopRequested.store(false, std::memory_order_relaxed);
+    asyncEnabled.store(true, std::memory_order_release);
+    worker = std::thread(&Logger::asyncLoop, this);
+}
 
-        std::string logMessage = oss.str();
+void Logger::disableAsync() {
+    std::lock_guard<std::mutex> control(asyncControl);
+    if (!asyncEnabled.load(std::memory_order_acquire)) return;
 
-        // طباعة على واجهة CLI
-        printToConsole(level, logMessage);
+    // الرسائل الجديدة تعود للمسار المتزامن؛ من تجاوز الفحص قبل ذلك يُنتظر حتى يُكمل الدفع،
+    // فلا يتوقف الخيط الخلفي إلا وكل ما دُفع في الطابور
+    asyncEnabled.store(false, std::memory_order_seq_cst);
+    while (activeProducers.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    stopRequested.store(true, std::memory_order_release);
 
-        // كتابة إلى ملف إن كان مفعلًا
-        if (logToFileEnabled && logFile.is_open()) {
-            logFile << logMessage << std::endl;
-            logFile.flush();
-        }
+    if (worker.joinable()) worker.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t dropped = droppedRecords.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        writeRecord({LogLevel::WARNING, false,
+                     formatLine("Logger", std::to_string(dropped) + " log messages dropped (queue overflow)",
+                                LogLevel::WARNING)});
+        if (logToFileEnabled && logFile.is_open()) logFile.flush();
     }
+}
 
-    // طباعة رسالة بدون وقت أو علامات (للإخراج المباشر)
-    void rawOutput(const std::string& text) {
+size_t Logger::queueDepth() const {
+    std::lock_guard<std::mutex> control(asyncControl);
+    return isAsync() && queue ? queue->sizeApprox() : 0;
+}
+
+void Logger::flush() {
+    if (!isAsync()) {
         std::lock_guard<std::mutex> lock(mutex);
-        std::cout << text;
-        if (logToFileEnabled && logFile.is_open()) {
-            logFile << text;
-            logFile.flush();
-        }
+        console->flush();
+        if (logToFileEnabled && logFile.is_open()) logFile.flush();
+        return;
     }
 
-private:
-    LogLevel currentLevel = LogLevel::INFO;
-    std::ofstream logFile;
-    bool logToFileEnabled = false;
-    std::mutex mutex;
+    flushRequested.store(true, std::memory_order_release);
+    while (flushRequested.load(std::memory_order_acquire) &&
+           !stopRequested.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
 
-    // بناء كائن غير متاح للإنشاء خارج singleton
-    Logger() = default;
-    ~Logger() {
-        if (logFile.is_open()) {
-            logFile.close();
-        }
+void Logger::log(const std::string& tag, const std::string& message, LogLevel level) {
+    if (!isEnabled(level)) return;
+
+    Record record{level, false, formatLine(tag, message, level)};
+
+    if (tryEnqueue(record)) return;
+
+    std::lock_guard<std::mutex> lock(mutex); // Thread-safe
+    writeRecord(record);
+    if (logToFileEnabled && logFile.is_open()) {
+        logFile.flush();
     }
+}
 
-    // لا يمكن نسخه
-    Logger(const Logger&) = delete;
-    Logger& operator=(const Logger&) = delete;
+void Logger::setConsoleStream(std::ostream& stream) {
+    std::lock_guard<std::mutex> lock(mutex);
+    console = &stream;
+}
 
-    // تحويل مستوى التسجيل إلى سلسلة نصية
-    std::string toString(LogLevel level) {
-        switch (level) {
-            case LogLevel::DEBUG:   return "DEBUG";
-            case LogLevel::INFO:    return "INFO ";
-            case LogLevel::WARNING: return "WARN ";
-            case LogLevel::ERROR:   return "ERROR";
-            default:                return "UNKNOWN";
+void Logger::rawOutput(const std::string& text) {
+    Record record{LogLevel::INFO, true, text};
+    if (tryEnqueue(record)) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    writeRecord(record);
+    if (logToFileEnabled && logFile.is_open()) {
+        logFile.flush();
+    }
+}
+
+Logger::~Logger() {
+    disableAsync();
+    if (logFile.is_open()) {
+        logFile.close();
+    }
+}
+
+bool Logger::tryEnqueue(Record& record) {
+    // العداد يُرفع قبل فحص الوضع: إما أن يرى disableAsync المنتج فينتظره، أو يرى المنتج الوضع معطلًا
+    activeProducers.fetch_add(1, std::memory_order_seq_cst);
+    bool async = asyncEnabled.load(std::memory_order_seq_cst);
+    if (async) enqueue(std::move(record));
+    activeProducers.fetch_sub(1, std::memory_order_release);
+    return async;
+}
+
+void Logger::enqueue(Record&& record) {
+    while (!queue->tryPush(std::move(record))) {
+        if (asyncConfig.overflowPolicy == LogOverflowPolicy::DROP) {
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
+        std::this_thread::yield();
     }
+}
 
-    // طباعة باللون المناسب
-    void printToConsole(const LogLevel level, const std::string& message) {
-        #ifdef _WIN32
-            HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-            WORD color;
-
-            switch (level) {
-                case LogLevel::DEBUG:   color = 8; break;     // رمادي فاتح
-                case LogLevel::INFO:    color = 7; break;     // أبيض
-                case LogLevel::WARNING: color = 14; break;    // أصفر
-                case LogLevel::ERROR:   color = 12; break;    // أحمر
-                default:                color = 7; break;
+void Logger::asyncLoop() {
+    using Clock = std::chrono::steady_clock;
+    auto lastFlush = Clock::now();
+    bool dirty = false;
+    Record record;
+
+    while (true) {
+        size_t batch = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (batch < 1024 && queue->tryPop(record)) {
+                writeRecord(record);
+                ++batch;
             }
+            queue->publishConsumed();
 
-            SetConsoleTextAttribute(hConsole, color);
-            std::cout << message << std::endl;
-            SetConsoleTextAttribute(hConsole, 7); // إعادة اللون الافتراضي
+            dirty = dirty || batch > 0;
+            bool idle = batch == 0;
+            bool due = Clock::now() - lastFlush >= asyncConfig.flushInterval;
+            bool forced = idle && flushRequested.load(std::memory_order_acquire);
 
-        #else
-            const char* colorCode;
-
-            switch (level) {
-                case LogLevel::DEBUG:   colorCode = "\033[1;30m"; break;  // رمادي فاتح
-                case LogLevel::INFO:    colorCode = "\033[0;37m"; break;  // أبيض
-                case LogLevel::WARNING: colorCode = "\033[1;33m"; break;  // أصفر
-                case LogLevel::ERROR:   colorCode = "\033[1;31m"; break;  // أحمر
-                default:                colorCode = "\033[0m"; break;
+            if ((dirty && due) || forced) {
+                console->flush();
+                if (logToFileEnabled && logFile.is_open()) logFile.flush();
+                lastFlush = Clock::now();
+                dirty = false;
             }
+            if (forced) {
+                flushRequested.store(false, std::memory_order_release);
+            }
+            if (idle && stopRequested.load(std::memory_order_acquire)) {
+                console->flush();
+                if (logToFileEnabled && logFile.is_open()) logFile.flush();
+                return;
+            }
+        }
 
-            std::cout << colorCode << message << "\033[0m" << std::endl;
-        #endif
+        if (batch == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+void Logger::writeRecord(const Record& record) {
+    if (record.raw) {
+        *console << record.text;
+        if (logToFileEnabled && logFile.is_open()) logFile << record.text;
+        return;
     }
 
-    // الحصول على الوقت الحالي بصيغة قابلة للقراءة
-    std::string getCurrentTimestamp() {
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %X");
-        return ss.str();
+    // طباعة على واجهة CLI
+    printToConsole(record.level, record.text);
+
+    // كتابة إلى ملف إن كان مفعلًا
+    if (logToFileEnabled && logFile.is_open()) {
+        logFile << record.text << '\n';
+    }
+}
+
+std::string Logger::formatLine(const std::string& tag, const std::string& message, LogLevel level) {
+    std::string line;
+    line.reserve(32 + tag.size() + message.size());
+    line += '[';
+    line += getCurrentTimestamp();
+    line += "] [";
+    line += toString(level);
+    line += "] [";
+    line += tag;
+    line += "] ";
+    line += message;
+    return line;
+}
+
+const char* Logger::toString(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG:   return "DEBUG";
+        case LogLevel::INFO:    return "INFO ";
+        case LogLevel::WARNING: return "WARN ";
+        case LogLevel::ERROR:   return "ERROR";
+        default:                return "UNKNOWN";
+    }
+}
+
+void Logger::printToConsole(const LogLevel level, const std::string& message) {
+    #ifdef _WIN32
+        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+        WORD color;
+
+        switch (level) {
+            case LogLevel::DEBUG:   color = 8; break;     // رمادي فاتح
+            case LogLevel::INFO:    color = 7; break;     // أبيض
+            case LogLevel::WARNING: color = 14; break;    // أصفر
+            case LogLevel::ERROR:   color = 12; break;    // أحمر
+            default:                color = 7; break;
+        }
+
+        SetConsoleTextAttribute(hConsole, color);
+        *console << message << '\n';
+        SetConsoleTextAttribute(hConsole, 7); // إعادة اللون الافتراضي
+
+    #else
+        const char* colorCode;
+
+        switch (level) {
+            case LogLevel::DEBUG:   colorCode = "\033[1;30m"; break;  // رمادي فاتح
+            case LogLevel::INFO:    colorCode = "\033[0;37m"; break;  // أبيض
+            case LogLevel::WARNING: colorCode = "\033[1;33m"; break;  // أصفر
+            case LogLevel::ERROR:   colorCode = "\033[1;31m"; break;  // أحمر
+            default:                colorCode = "\033[0m"; break;
+        }
+
+        *console << colorCode << message << "\033[0m" << '\n';
+    #endif
+}
+
+std::string Logger::getCurrentTimestamp() {
+    thread_local std::time_t cachedSecond = -1;
+    thread_local char cached[32] = {0};
+
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    if (now != cachedSecond) {
+        std::tm tmNow{};
+        #ifdef _WIN32
+            localtime_s(&tmNow, &now);
+        #else
+            localtime_r(&now, &tmNow);
+        #endif
+        std::strftime(cached, sizeof(cached), "%Y-%m-%d %X", &tmNow);
+        cachedSecond = now;
     }
-};
\ No newline at end of file
+    return cached;
+}
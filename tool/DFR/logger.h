@@ -0,0 +1,286 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+// الحد الأدنى لمستوى التسجيل وقت البناء (0=DEBUG, 1=INFO, 2=WARNING, 3=ERROR)
+// الاستدعاءات عبر LOG_* تحت هذا المستوى تُحذف بالكامل ولا تُقيَّم وسائطها
+#ifndef DFR_MIN_LOG_LEVEL
+#define DFR_MIN_LOG_LEVEL 0
+#endif
+
+// مستويات التسجيل
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+// سياسة التعامل مع امتلاء طابور التسجيل غير المتزامن
+enum class LogOverflowPolicy {
+    DROP,   // إسقاط الرسالة وزيادة عداد المفقود
+    BLOCK   // انتظار المنتج حتى يتوفر مكان
+};
+
+// بناء نص الرسالة من وسائط متعددة بدون ostringstream للأنواع الشائعة
+namespace LogFormat {
+    inline void append(std::string& out, const std::string& value) { out += value; }
+    inline void append(std::string& out, std::string_view value) { out += value; }
+    inline void append(std::string& out, const char* value) { out += value ? value : "(null)"; }
+    inline void append(std::string& out, char value) { out += value; }
+
+    template <typename T>
+    void append(std::string& out, const T& value) {
+        if constexpr (std::is_integral_v<T>) {
+            out += std::to_string(value);
+        } else {
+            std::ostringstream oss;
+            oss << value;
+            out += oss.str();
+        }
+    }
+
+    template <typename... Args>
+    std::string concat(const Args&... args) {
+        std::string out;
+        (append(out, args), ...);
+        return out;
+    }
+}
+
+// طابور حلقي محدود متعدد المنتجين / مستهلك واحد بدون أقفال
+// (كل خانة تحمل رقم تسلسل يحدد من يملكها حاليًا)
+template <typename T>
+class MpscRingBuffer {
+public:
+    explicit MpscRingBuffer(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        slots.reset(new Slot[size]);
+        for (size_t i = 0; i < size; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    // إضافة عنصر (آمن لعدة منتجين) - يعيد false إذا كان الطابور ممتلئًا
+    bool tryPush(T&& value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // سحب عنصر (للمستهلك الوحيد فقط)
+    bool tryPop(T& out) {
+        Slot& slot = slots[tail & mask];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(tail + 1) < 0) {
+            return false;
+        }
+
+        out = std::move(slot.value);
+        slot.sequence.store(tail + mask + 1, std::memory_order_release);
+        ++tail;
+        return true;
+    }
+
+    // عدد تقريبي للعناصر المنتظرة
+    size_t sizeApprox() const {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = consumed.load(std::memory_order_relaxed);
+        return h > t ? h - t : 0;
+    }
+
+    // يستدعيه المستهلك بعد معالجة دفعة لتحديث العداد التقريبي
+    void publishConsumed() {
+        consumed.store(tail, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) size_t tail = 0;
+    std::atomic<size_t> consumed{0};
+};
+
+class Logger {
+public:
+    // إعدادات وضع التسجيل غير المتزامن
+    struct AsyncConfig {
+        size_t queueCapacity = 8192;
+        std::chrono::milliseconds flushInterval{250};
+        LogOverflowPolicy overflowPolicy = LogOverflowPolicy::DROP;
+    };
+
+    // Singleton Instance
+    static Logger& getInstance();
+
+    // تحديد مستوى التسجيل الحالي
+    void setLevel(LogLevel level) {
+        currentLevel.store(level, std::memory_order_relaxed);
+    }
+
+    LogLevel getLevel() const {
+        return currentLevel.load(std::memory_order_relaxed);
+    }
+
+    // هل سيُكتب هذا المستوى حاليًا؟ (يُفحص قبل بناء الرسالة)
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= DFR_MIN_LOG_LEVEL && level >= getLevel();
+    }
+
+    // تعيين مسار ملف السجل
+    bool setLogFile(const std::string& path);
+
+    // تفعيل الوضع غير المتزامن: المنتجون يدفعون سجلات جاهزة والخيط الخلفي يكتبها على دفعات
+    void enableAsync();
+    void enableAsync(const AsyncConfig& config);
+
+    // إيقاف الوضع غير المتزامن بعد تفريغ كل السجلات المعلقة
+    void disableAsync();
+
+    bool isAsync() const {
+        return asyncEnabled.load(std::memory_order_acquire);
+    }
+
+    // عدد السجلات المنتظرة في الطابور غير المتزامن
+    size_t queueDepth() const;
+
+    // عدد الرسائل التي أُسقطت بسبب امتلاء الطابور
+    size_t droppedCount() const {
+        return droppedRecords.load(std::memory_order_relaxed);
+    }
+
+    // انتظار كتابة كل السجلات المعلقة وتفريغ الملف
+    void flush();
+
+    // تسجيل رسالة
+    void log(const std::string& tag, const std::string& message, LogLevel level = LogLevel::INFO);
+
+    // تسجيل رسالة من عدة أجزاء، لا تُبنى السلسلة إلا إذا كان المستوى مفعّلًا
+    template <typename... Args>
+    void logf(LogLevel level, const std::string& tag, const Args&... args) {
+        if (!isEnabled(level)) return;
+        log(tag, LogFormat::concat(args...), level);
+    }
+
+    // تحديد مجرى الطباعة على الشاشة (stderr في الوضع الدفعي ليبقى stdout نظيفًا)
+    void setConsoleStream(std::ostream& stream);
+
+    // طباعة رسالة بدون وقت أو علامات (للإخراج المباشر)
+    void rawOutput(const std::string& text);
+
+private:
+    // سجل منسق مسبقًا ينتظر الكتابة
+    struct Record {
+        LogLevel level = LogLevel::INFO;
+        bool raw = false;
+        std::string text;
+    };
+
+    std::atomic<LogLevel> currentLevel{LogLevel::INFO};
+    std::ofstream logFile;
+    std::ostream* console = &std::cout;
+    bool logToFileEnabled = false;
+    std::mutex mutex;
+
+    // حالة الوضع غير المتزامن (التفعيل والإيقاف متسلسلان تحت asyncControl)
+    mutable std::mutex asyncControl;
+    AsyncConfig asyncConfig;
+    std::unique_ptr<MpscRingBuffer<Record>> queue;
+    std::thread worker;
+    std::atomic<bool> asyncEnabled{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> flushRequested{false};
+    std::atomic<size_t> droppedRecords{0};
+    std::atomic<size_t> activeProducers{0};     // منتجون بين فحص الوضع ونهاية الدفع
+
+    // بناء كائن غير متاح للإنشاء خارج singleton
+    Logger() = default;
+    ~Logger();
+
+    // لا يمكن نسخه
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // دفع السجل إن كان الوضع غير متزامن (false = يكتبه المستدعي مباشرة ويبقى السجل كما هو)
+    bool tryEnqueue(Record& record);
+
+    // دفع سجل إلى الطابور حسب سياسة الامتلاء
+    void enqueue(Record&& record);
+
+    // حلقة الخيط الخلفي: سحب دفعات وكتابتها مع تفريغ دوري للملف
+    void asyncLoop();
+
+    // كتابة سجل واحد إلى الشاشة والملف (يُستدعى مع القفل)
+    void writeRecord(const Record& record);
+
+    // تنسيق سطر السجل الكامل
+    std::string formatLine(const std::string& tag, const std::string& message, LogLevel level);
+
+    // تحويل مستوى التسجيل إلى سلسلة نصية
+    static const char* toString(LogLevel level);
+
+    // طباعة باللون المناسب
+    void printToConsole(const LogLevel level, const std::string& message);
+
+    // الحصول على الوقت الحالي بصيغة قابلة للقراءة
+    // (النص مخزن مؤقتًا لكل خيط ويُعاد بناؤه مرة واحدة في الثانية)
+    static std::string getCurrentTimestamp();
+};
+
+// واجهة التسجيل الموصى بها: لا تُقيَّم الوسائط إذا كان المستوى مُرشَّحًا،
+// وتُحذف بالكامل وقت البناء إذا كانت دون DFR_MIN_LOG_LEVEL
+#define DFR_LOG(level, tag, ...)                                              \
+    do {                                                                      \
+        if constexpr (static_cast<int>(level) >= DFR_MIN_LOG_LEVEL) {         \
+            Logger& dfrLogger_ = Logger::getInstance();                       \
+            if (dfrLogger_.isEnabled(level)) {                                \
+                dfrLogger_.logf(level, tag, __VA_ARGS__);                     \
+            }                                                                 \
+        }                                                                     \
+    } while (0)
+
+#define LOG_DEBUG(tag, ...) DFR_LOG(LogLevel::DEBUG, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...)  DFR_LOG(LogLevel::INFO, tag, __VA_ARGS__)
+#define LOG_WARN(tag, ...)  DFR_LOG(LogLevel::WARNING, tag, __VA_ARGS__)
+#define LOG_ERROR(tag, ...) DFR_LOG(LogLevel::ERROR, tag, __VA_ARGS__)
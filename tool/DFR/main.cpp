@@ -1,35 +1,39 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <cstdint>
-#include <thread>
-#include <chrono>
-
-// تضمين ملفات المشروع
-#include "disk_reader.cpp"
-#include "signature_scanner.cpp"
-#include "file_rebuilder.cpp"
-#include "output_manager.cpp"
-#include "metadata_extractor.cpp"
-#include "file_system_analyzer.cpp"
-#include "logger.cpp"
-#include "utils.cpp"
-#include "ui_cli.cpp"
-
-// نقطة الدخول
-int main() {
+
+// وحدات المشروع
+#include "logger.h"
+#include "utils.h"
+#include "scan_stats.h"
+#include "output_manager.h"
+#include "ui_cli.h"
+#include "scan_extent.h"
+#include "recovery_job.h"
+#include "batch_cli.h"
+
+// نقطة الدخول: أي معامل في سطر الأوامر يعني وضع الدفعات بلا أسئلة
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return BatchCli::run(argc, argv);
+    }
+
     // إعداد المسجل
     Logger& logger = Logger::getInstance();
     logger.setLevel(LogLevel::INFO);
     logger.setLogFile("file_rescue.log");
+    logger.enableAsync();
 
     CliUI ui;
     ui.showBanner();
 
     std::string diskPath, outputPath;
     std::vector<std::string> selectedTypes;
+    std::vector<ScanExtent> scanExtents = {{0, 1024ull * 1024 * 1024, ""}}; // افتراضيًا أول 1GB
+    bool usePartitions = false;
 
     while (true) {
+        logger.flush(); // عدم تداخل السجلات المعلقة مع القائمة
         ui.showMainMenu();
         int choice = ui.getUserChoice();
 
@@ -44,27 +48,40 @@ int main() {
                     break;
                 }
 
-                logger.log("Main", "Starting disk scan on " + diskPath, LogLevel::INFO);
+                LOG_INFO("Main", "Starting disk scan on ", diskPath);
 
-                // قراءة أول 1GB من القرص
-                DiskReader reader(diskPath);
-                auto rawData = reader.readBytes(0, 1024 * 1024 * 1024); // 1GB
-                if (rawData.empty()) {
-                    logger.log("Main", "Failed to read disk data", LogLevel::ERROR);
-                    break;
-                }
-
-                // مسح التوقيعات
-                logger.log("Main", "Scanning for file signatures...", LogLevel::INFO);
-                auto foundSignatures = SignatureScanner::scan(rawData);
+                ScanStats& stats = ScanStats::getInstance();
+                stats.reset();
 
                 OutputManager output(outputPath);
                 output.setupDirectories();
 
-                logger.log("Main", "Rebuilding files...", LogLevel::INFO);
-                for (const auto& [offset, signature] : foundSignatures) {
-                    auto recoveredFile = FileRebuilder::rebuildFile(rawData, offset, signature, outputPath);
-                    output.addRecoveredFile(recoveredFile.filename, signature.extension, recoveredFile.endOffset - offset);
+                // مسح المقاطع المختارة فقط بالتوازي على قطع
+                RecoveryJob::Options options;
+                options.devicePath = diskPath;
+                options.outputDir = outputPath;
+                options.fileTypes = selectedTypes;
+                options.extents = scanExtents;
+                options.usePartitionTable = usePartitions;
+
+                RecoveryJob::Summary summary;
+                {
+                    ProgressReporter progress(ui);
+                    try {
+                        summary = RecoveryJob(options).run(output);
+                    } catch (const std::exception& e) {
+                        summary.error = e.what();
+                    }
+                }
+
+                if (!summary.success) {
+                    LOG_ERROR("Main", "Scan failed: ", summary.error);
+                    break;
+                }
+
+                std::string statsPath = outputPath + "/scan_stats.json";
+                if (stats.writeJson(statsPath)) {
+                    LOG_INFO("Main", "Scan statistics written to ", statsPath);
                 }
 
                 output.printRecoverySummary();
@@ -73,7 +90,13 @@ int main() {
 
             case 2: { // عرض الملفات المستعادة
                 logger.log("Main", "Displaying recovered files...", LogLevel::INFO);
+                if (outputPath.empty()) outputPath = ui.getOutputPathInput();
                 OutputManager output(outputPath);
+                if (!output.loadRecoveredIndex()) {
+                    std::cout << "[!] No recovered files indexed in " << outputPath << "\n";
+                    break;
+                }
+                output.printRecoveredFiles(50);
                 output.printRecoverySummary();
                 break;
             }
@@ -84,12 +107,30 @@ int main() {
                     ui.showSettingsMenu();
                     settingChoice = ui.getUserChoice();
                     switch (settingChoice) {
-                        case 1:
-                            logger.log("Main", "Custom scan size not implemented yet.", LogLevel::WARNING);
+                        case 1: {
+                            std::string current = ScanExtents::describe(scanExtents) + (usePartitions ? " by partition" : "");
+                            std::string input = ui.getScanExtentsInput(current);
+                            try {
+                                if (input == "partitions") {
+                                    usePartitions = !usePartitions;
+                                    LOG_INFO("Main", "Partition-aware scanning ", usePartitions ? "enabled" : "disabled");
+                                    break;
+                                } else if (input == "all") {
+                                    scanExtents.clear();
+                                } else if (!input.empty() && input[0] == '@') {
+                                    scanExtents = ScanExtents::loadFile(input.substr(1));
+                                } else if (!input.empty()) {
+                                    scanExtents = ScanExtents::parseList(input);
+                                }
+                                LOG_INFO("Main", "Scan extents set to ", ScanExtents::describe(scanExtents));
+                            } catch (const std::exception& e) {
+                                LOG_WARN("Main", "Invalid scan extents: ", e.what());
+                            }
                             break;
+                        }
                         case 2:
                             logger.setLevel(logger.getLevel() == LogLevel::DEBUG ? LogLevel::INFO : LogLevel::DEBUG);
-                            logger.log("Main", "Debug mode toggled to " + std::to_string(static_cast<int>(logger.getLevel())), LogLevel::INFO);
+                            LOG_INFO("Main", "Debug mode toggled to ", static_cast<int>(logger.getLevel()));
                             break;
                         case 3:
                             break;
@@ -102,6 +143,7 @@ int main() {
 
             case 4: // الخروج
                 logger.log("Main", "Exiting application", LogLevel::INFO);
+                logger.disableAsync();
                 return 0;
 
             default:
@@ -110,4 +152,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
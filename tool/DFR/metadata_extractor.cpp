@@ -1,202 +1,249 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <cstdint>
-#include <unordered_map>
-#include <sstream>
-#include <iomanip>
-#include <ctime>
-
-class MetadataExtractor {
-public:
-    // هيكل لتخزين البيانات الوصفية
-    struct Metadata {
-        std::unordered_map<std::string, std::string> values;
-
-        void add(const std::string& key, const std::string& value) {
-            values[key] = value;
-        }
+#include "metadata_extractor.h"
 
-        std::string get(const std::string& key, const std::string& defaultValue = "") const {
-            auto it = values.find(key);
-            return (it != values.end()) ? it->second : defaultValue;
-        }
+#include <algorithm>
+#include <cstring>
 
-        void print() const {
-            if (values.empty()) {
-                std::cout << "No metadata found.\n";
-                return;
-            }
+namespace {
 
-            std::cout << "[Metadata]\n";
-            for (const auto& [key, value] : values) {
-                std::cout << " - " << key << ": " << value << "\n";
-            }
-        }
-    };
-
-    // استخراج البيانات بناءً على نوع الملف
-    static Metadata extract(const std::vector<uint8_t>& data, const std::string& extension) {
-        Metadata meta;
-
-        if (extension == "jpg" || extension == "jpeg") {
-            extractJpegMetadata(data, meta);
-        } else if (extension == "png") {
-            extractPngMetadata(data, meta);
-        } else if (extension == "pdf") {
-            extractPdfMetadata(data, meta);
-        } else if (extension == "mp3") {
-            extractMp3Metadata(data, meta);
-        } else if (extension == "docx" || extension == "xlsx" || extension == "pptx") {
-            extractOfficeMetadata(data, meta);
-        }
+// قراءة حقول TIFF داخل كتلة EXIF بترتيب البايتات المعلن في رأسها
+struct TiffReader {
+    const uint8_t* data;
+    size_t size;
+    bool littleEndian;
 
-        return meta;
+    bool has(size_t offset, size_t length) const {
+        return offset <= size && length <= size - offset;
+    }
+    uint16_t u16(size_t offset) const {
+        return littleEndian ? static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8))
+                            : static_cast<uint16_t>((data[offset] << 8) | data[offset + 1]);
+    }
+    uint32_t u32(size_t offset) const {
+        uint32_t a = data[offset], b = data[offset + 1], c = data[offset + 2], d = data[offset + 3];
+        return littleEndian ? (a | (b << 8) | (c << 16) | (d << 24)) : ((a << 24) | (b << 16) | (c << 8) | d);
     }
 
-private:
-    // --- JPG / JPEG ---
-    static void extractJpegMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
-        // البحث عن قسم EXIF
-        size_t offset = findSubVector(data, {0xFF, 0xE1}, 0);
-        if (offset != std::string::npos) {
-            meta.add("Format", "JPEG");
-            meta.add("Has_EXIF", "Yes");
+    // نص ASCII لمدخل IFD (قصير داخل المدخل أو بإزاحة)
+    std::string ascii(size_t entry) const {
+        uint32_t count = u32(entry + 4);
+        size_t offset = count <= 4 ? entry + 8 : u32(entry + 8);
+        if (!has(offset, count)) return "";
+        std::string value(reinterpret_cast<const char*>(data + offset), count);
+        value = value.substr(0, value.find('\0'));
+        while (!value.empty() && value.back() == ' ') value.pop_back();
+        return value;
+    }
 
-            // يمكن توسيعه لقراءة EXIF بالكامل لاحقًا
-        } else {
-            meta.add("Format", "JPEG");
-            meta.add("Has_EXIF", "No");
+    // استدعاء visit(tag, entry) لكل مدخل في IFD عند offset
+    template <typename Visit>
+    void forEachEntry(size_t offset, Visit visit) const {
+        if (!has(offset, 2)) return;
+        uint16_t count = u16(offset);
+        for (uint16_t i = 0; i < count && has(offset + 2 + i * 12u, 12); ++i) {
+            size_t entry = offset + 2 + i * 12u;
+            visit(u16(entry), entry);
         }
     }
+};
+
+} // namespace
+
+MetadataExtractor::Metadata MetadataExtractor::extract(const std::vector<uint8_t>& data, const std::string& extension) {
+    Metadata meta;
+
+    if (extension == "jpg" || extension == "jpeg") {
+        extractJpegMetadata(data, meta);
+    } else if (extension == "png") {
+        extractPngMetadata(data, meta);
+    } else if (extension == "pdf") {
+        extractPdfMetadata(data, meta);
+    } else if (extension == "mp3") {
+        extractMp3Metadata(data, meta);
+    } else if (extension == "docx" || extension == "xlsx" || extension == "pptx") {
+        extractOfficeMetadata(data, meta);
+    }
 
-    // --- PNG ---
-    static void extractPngMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
-        meta.add("Format", "PNG");
-
-        // البحث عن كتل النص (tEXt)
-        size_t pos = 8; // بداية الرأس بعد التوقيع
-        while (pos + 8 < data.size()) {
-            uint32_t chunkLength = readUint32BE(data, pos);
-            std::string chunkType = readString(data, pos + 4, 4);
+    return meta;
+}
+
+void MetadataExtractor::extractJpegMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
+    // البحث عن قسم EXIF
+    meta.add("Format", "JPEG");
+    size_t offset = findSubVector(data, {0xFF, 0xE1}, 0);
+    if (offset == std::string::npos || offset + 10 > data.size() ||
+        std::memcmp(data.data() + offset + 4, "Exif\0\0", 6) != 0) {
+        meta.add("Has_EXIF", "No");
+        return;
+    }
+    meta.add("Has_EXIF", "Yes");
+
+    // رأس TIFF بعد "Exif\0\0": ترتيب البايتات ثم إزاحة IFD0 (الإزاحات كلها نسبة إليه)
+    size_t segmentLength = (static_cast<size_t>(data[offset + 2]) << 8) | data[offset + 3];
+    size_t tiffStart = offset + 10;
+    size_t tiffSize = std::min(data.size(), offset + 2 + segmentLength) - std::min(data.size(), tiffStart);
+    if (tiffSize < 8) return;
+    TiffReader tiff{data.data() + tiffStart, tiffSize, data[tiffStart] == 'I'};
+    if (tiff.u16(2) != 42) return;
+
+    size_t exifIfd = 0, gpsIfd = 0;
+    tiff.forEachEntry(tiff.u32(4), [&](uint16_t tag, size_t entry) {
+        switch (tag) {
+            case 0x010F: meta.add("Make", tiff.ascii(entry)); break;
+            case 0x0110: meta.add("Model", tiff.ascii(entry)); break;
+            case 0x013B: meta.add("Artist", tiff.ascii(entry)); break;
+            case 0x0132: meta.add("DateTime", tiff.ascii(entry)); break;
+            case 0x8769: exifIfd = tiff.u32(entry + 8); break;
+            case 0x8825: gpsIfd = tiff.u32(entry + 8); break;
+        }
+    });
 
-            if (chunkType == "tEXt") {
-                std::string keyword = readNullTerminatedString(data, pos + 8);
-                std::string text = readString(data, pos + 8 + keyword.size() + 1, chunkLength - keyword.size() - 1);
-                meta.add(keyword, text);
-            }
+    // وقت الالتقاط يُقدم على وقت آخر تعديل
+    if (exifIfd) {
+        tiff.forEachEntry(exifIfd, [&](uint16_t tag, size_t entry) {
+            if (tag == 0x9003) meta.add("DateTime", tiff.ascii(entry));
+        });
+    }
 
-            pos += 12 + chunkLength;
-        }
+    // الموقع موجود إن حوى GPS IFD خط العرض (الوسم 2)
+    bool hasGps = false;
+    if (gpsIfd) {
+        tiff.forEachEntry(gpsIfd, [&](uint16_t tag, size_t) { hasGps = hasGps || tag == 2; });
     }
+    meta.add("GPS", hasGps ? "Yes" : "No");
+}
+
+void MetadataExtractor::extractPngMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
+    meta.add("Format", "PNG");
+
+    // البحث عن كتل النص (tEXt)
+    size_t pos = 8; // بداية الرأس بعد التوقيع
+    while (pos + 8 < data.size()) {
+        uint32_t chunkLength = readUint32BE(data, pos);
+        std::string chunkType = readString(data, pos + 4, 4);
+
+        if (chunkType == "tEXt") {
+            std::string keyword = readNullTerminatedString(data, pos + 8);
+            std::string text = readString(data, pos + 8 + keyword.size() + 1, chunkLength - keyword.size() - 1);
+            meta.add(keyword, text);
+        }
 
-    // --- PDF ---
-    static void extractPdfMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
-        meta.add("Format", "PDF");
+        pos += 12 + chunkLength;
+    }
+}
 
-        std::string pdfVersion(reinterpret_cast<const char*>(data.data()), 8);
-        meta.add("Version", pdfVersion);
+void MetadataExtractor::extractPdfMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
+    meta.add("Format", "PDF");
 
-        // البحث عن %%DocumentData
-        std::string content(reinterpret_cast<const char*>(data.data()), std::min<size_t>(data.size(), 1024 * 64));
-        size_t creatorPos = content.find("/Creator");
-        if (creatorPos != std::string::npos) {
-            std::string creator = extractPdfValue(content, creatorPos);
-            meta.add("Creator", creator);
-        }
+    std::string pdfVersion(reinterpret_cast<const char*>(data.data()), 8);
+    meta.add("Version", pdfVersion);
 
-        size_t authorPos = content.find("/Author");
-        if (authorPos != std::string::npos) {
-            std::string author = extractPdfValue(content, authorPos);
-            meta.add("Author", author);
-        }
+    // البحث عن %%DocumentData
+    std::string content(reinterpret_cast<const char*>(data.data()), std::min<size_t>(data.size(), 1024 * 64));
+    size_t creatorPos = content.find("/Creator");
+    if (creatorPos != std::string::npos) {
+        std::string creator = extractPdfValue(content, creatorPos);
+        meta.add("Creator", creator);
     }
 
-    // --- MP3 (ID3 Tags) ---
-    static void extractMp3Metadata(const std::vector<uint8_t>& data, Metadata& meta) {
-        meta.add("Format", "MP3");
+    size_t authorPos = content.find("/Author");
+    if (authorPos != std::string::npos) {
+        std::string author = extractPdfValue(content, authorPos);
+        meta.add("Author", author);
+    }
 
-        if (data.size() < 10 || data[0] != 'I' || data[1] != 'D' || data[2] != '3') {
-            meta.add("Has_ID3", "No");
-            return;
-        }
+    size_t titlePos = content.find("/Title");
+    if (titlePos != std::string::npos) meta.add("Title", extractPdfValue(content, titlePos));
 
-        meta.add("Has_ID3", "Yes");
-        meta.add("Version", std::to_string(data[3]) + "." + std::to_string(data[4]));
+    // D:YYYYMMDDHHmmSS
+    size_t datePos = content.find("/CreationDate");
+    if (datePos != std::string::npos) {
+        std::string date = extractPdfValue(content, datePos);
+        meta.add("DateTime", date.rfind("D:", 0) == 0 ? date.substr(2) : date);
+    }
+}
 
-        if (data.size() >= 128) {
-            std::string title = readString(data, data.size() - 128 + 3, 30);
-            std::string artist = readString(data, data.size() - 128 + 33, 30);
-            std::string album = readString(data, data.size() - 128 + 63, 30);
-            std::string year = readString(data, data.size() - 128 + 93, 4);
+void MetadataExtractor::extractMp3Metadata(const std::vector<uint8_t>& data, Metadata& meta) {
+    meta.add("Format", "MP3");
 
-            meta.add("Title", title);
-            meta.add("Artist", artist);
-            meta.add("Album", album);
-            meta.add("Year", year);
-        }
+    if (data.size() < 10 || data[0] != 'I' || data[1] != 'D' || data[2] != '3') {
+        meta.add("Has_ID3", "No");
+        return;
     }
 
-    // --- DOCX/XLSX/PPTX ---
-    static void extractOfficeMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
-        meta.add("Format", "ZIP-Based Document");
+    meta.add("Has_ID3", "Yes");
+    meta.add("Version", std::to_string(data[3]) + "." + std::to_string(data[4]));
 
-        // يمكنك هنا إضافة دعم لفتح XML داخلي لاستخراج بيانات أوتوبيغرافيك
-        // لكن هذا يتطلب ضغط ZIP Parser (يمكن تطويره لاحقًا)
+    // ID3v1 في آخر 128 بايتًا إن وُجد وسم TAG
+    if (data.size() >= 128 && readString(data, data.size() - 128, 3) == "TAG") {
+        std::string title = readString(data, data.size() - 128 + 3, 30);
+        std::string artist = readString(data, data.size() - 128 + 33, 30);
+        std::string album = readString(data, data.size() - 128 + 63, 30);
+        std::string year = readString(data, data.size() - 128 + 93, 4);
+
+        meta.add("Title", title);
+        meta.add("Artist", artist);
+        meta.add("Album", album);
+        meta.add("Year", year);
     }
+}
 
-    // أدوات مساعدة داخلية
-    static size_t findSubVector(const std::vector<uint8_t>& data, const std::vector<uint8_t>& pattern, size_t startPos) {
-        if (pattern.empty() || data.size() < pattern.size() || startPos > data.size() - pattern.size()) {
-            return std::string::npos;
-        }
+void MetadataExtractor::extractOfficeMetadata(const std::vector<uint8_t>& data, Metadata& meta) {
+    meta.add("Format", "ZIP-Based Document");
 
-        for (size_t i = startPos; i <= data.size() - pattern.size(); ++i) {
-            bool match = true;
-            for (size_t j = 0; j < pattern.size(); ++j) {
-                if (data[i + j] != pattern[j]) {
-                    match = false;
-                    break;
-                }
-            }
-            if (match) return i;
-        }
+    // يمكنك هنا إضافة دعم لفتح XML داخلي لاستخراج بيانات أوتوبيغرافيك
+    // لكن هذا يتطلب ضغط ZIP Parser (يمكن تطويره لاحقًا)
+}
 
+size_t MetadataExtractor::findSubVector(const std::vector<uint8_t>& data, const std::vector<uint8_t>& pattern, size_t startPos) {
+    if (pattern.empty() || data.size() < pattern.size() || startPos > data.size() - pattern.size()) {
         return std::string::npos;
     }
 
-    static uint32_t readUint32BE(const std::vector<uint8_t>& data, size_t offset) {
-        return (static_cast<uint32_t>(data[offset]) << 24) |
-               (static_cast<uint32_t>(data[offset + 1]) << 16) |
-               (static_cast<uint32_t>(data[offset + 2]) << 8) |
-               static_cast<uint32_t>(data[offset + 3]);
-    }
-
-    static std::string readString(const std::vector<uint8_t>& data, size_t offset, size_t length) {
-        std::string result;
-        for (size_t i = 0; i < length && offset + i < data.size(); ++i) {
-            if (data[offset + i] == 0) break;
-            result += static_cast<char>(data[offset + i]);
+    for (size_t i = startPos; i <= data.size() - pattern.size(); ++i) {
+        bool match = true;
+        for (size_t j = 0; j < pattern.size(); ++j) {
+            if (data[i + j] != pattern[j]) {
+                match = false;
+                break;
+            }
         }
-        return result;
+        if (match) return i;
     }
 
-    static std::string readNullTerminatedString(const std::vector<uint8_t>& data, size_t offset) {
-        std::string result;
-        for (size_t i = 0; offset + i < data.size(); ++i) {
-            if (data[offset + i] == 0) break;
-            result += static_cast<char>(data[offset + i]);
-        }
-        return result;
+    return std::string::npos;
+}
+
+uint32_t MetadataExtractor::readUint32BE(const std::vector<uint8_t>& data, size_t offset) {
+    return (static_cast<uint32_t>(data[offset]) << 24) |
+           (static_cast<uint32_t>(data[offset + 1]) << 16) |
+           (static_cast<uint32_t>(data[offset + 2]) << 8) |
+           static_cast<uint32_t>(data[offset + 3]);
+}
+
+std::string MetadataExtractor::readString(const std::vector<uint8_t>& data, size_t offset, size_t length) {
+    std::string result;
+    for (size_t i = 0; i < length && offset + i < data.size(); ++i) {
+        if (data[offset + i] == 0) break;
+        result += static_cast<char>(data[offset + i]);
     }
+    return result;
+}
+
+std::string MetadataExtractor::readNullTerminatedString(const std::vector<uint8_t>& data, size_t offset) {
+    std::string result;
+    for (size_t i = 0; offset + i < data.size(); ++i) {
+        if (data[offset + i] == 0) break;
+        result += static_cast<char>(data[offset + i]);
+    }
+    return result;
+}
 
-    static std::string extractPdfValue(const std::string& content, size_t pos) {
-        size_t start = content.find('(', pos);
-        if (start == std::string::npos) return "";
+std::string MetadataExtractor::extractPdfValue(const std::string& content, size_t pos) {
+    size_t start = content.find('(', pos);
+    if (start == std::string::npos) return "";
 
-        size_t end = content.find(')', start);
-        if (end == std::string::npos) return "";
+    size_t end = content.find(')', start);
+    if (end == std::string::npos) return "";
 
-        return content.substr(start + 1, end - start - 1);
-    }
-};
\ No newline at end of file
+    return content.substr(start + 1, end - start - 1);
+}
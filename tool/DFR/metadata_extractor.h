@@ -0,0 +1,66 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+class MetadataExtractor {
+public:
+    // هيكل لتخزين البيانات الوصفية
+    struct Metadata {
+        std::unordered_map<std::string, std::string> values;
+
+        void add(const std::string& key, const std::string& value) {
+            values[key] = value;
+        }
+
+        std::string get(const std::string& key, const std::string& defaultValue = "") const {
+            auto it = values.find(key);
+            return (it != values.end()) ? it->second : defaultValue;
+        }
+
+        void print() const {
+            if (values.empty()) {
+                std::cout << "No metadata found.\n";
+                return;
+            }
+
+            std::cout << "[Metadata]\n";
+            for (const auto& [key, value] : values) {
+                std::cout << " - " << key << ": " << value << "\n";
+            }
+        }
+    };
+
+    // استخراج البيانات بناءً على نوع الملف
+    static Metadata extract(const std::vector<uint8_t>& data, const std::string& extension);
+
+private:
+    // --- JPG / JPEG ---
+    static void extractJpegMetadata(const std::vector<uint8_t>& data, Metadata& meta);
+
+    // --- PNG ---
+    static void extractPngMetadata(const std::vector<uint8_t>& data, Metadata& meta);
+
+    // --- PDF ---
+    static void extractPdfMetadata(const std::vector<uint8_t>& data, Metadata& meta);
+
+    // --- MP3 (ID3 Tags) ---
+    static void extractMp3Metadata(const std::vector<uint8_t>& data, Metadata& meta);
+
+    // --- DOCX/XLSX/PPTX ---
+    static void extractOfficeMetadata(const std::vector<uint8_t>& data, Metadata& meta);
+
+    // أدوات مساعدة داخلية
+    static size_t findSubVector(const std::vector<uint8_t>& data, const std::vector<uint8_t>& pattern, size_t startPos);
+
+    static uint32_t readUint32BE(const std::vector<uint8_t>& data, size_t offset);
+
+    static std::string readString(const std::vector<uint8_t>& data, size_t offset, size_t length);
+
+    static std::string readNullTerminatedString(const std::vector<uint8_t>& data, size_t offset);
+
+    static std::string extractPdfValue(const std::string& content, size_t pos);
+};
@@ -0,0 +1,104 @@
+#include "mpeg_audio.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBlock = 64 * 1024;
+constexpr size_t kId3v1 = 128;
+
+// الإطار التالي يكمل السلسلة إن حمل الإصدار والطبقة ومعدل العينة نفسها
+bool sameStream(const uint8_t* first, const uint8_t* next) {
+    return next[1] == first[1] && (next[2] & 0x0C) == (first[2] & 0x0C);
+}
+
+} // namespace
+
+size_t MpegAudio::frameLength(const uint8_t* p, size_t n) {
+    static const uint16_t kBitrates[5][16] = {
+        {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0},   // MPEG1 Layer I
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 0},      // MPEG1 Layer II
+        {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0},       // MPEG1 Layer III
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256, 0},      // MPEG2/2.5 Layer I
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},           // MPEG2/2.5 Layer II/III
+    };
+    static const uint32_t kSampleRates[4][3] = {
+        {11025, 12000, 8000}, {0, 0, 0}, {22050, 24000, 16000}, {44100, 48000, 32000}};
+
+    if (n < 4 || p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return 0;
+    int version = (p[1] >> 3) & 3;     // 3 = MPEG1، 2 = MPEG2، 0 = MPEG2.5
+    int layer = (p[1] >> 1) & 3;       // 3 = I، 2 = II، 1 = III
+    int bitrateIndex = p[2] >> 4;
+    int rateIndex = (p[2] >> 2) & 3;
+    int padding = (p[2] >> 1) & 1;
+    if (version == 1 || layer == 0 || rateIndex == 3) return 0;
+
+    int table = version == 3 ? 3 - layer : (layer == 3 ? 3 : 4);
+    uint32_t bitrate = kBitrates[table][bitrateIndex] * 1000u;
+    uint32_t sampleRate = kSampleRates[version][rateIndex];
+    if (bitrate == 0) return 0;
+
+    if (layer == 3) return (12 * bitrate / sampleRate + padding) * 4;
+    uint32_t factor = (layer == 1 && version != 3) ? 72 : 144;
+    return factor * bitrate / sampleRate + padding;
+}
+
+bool MpegAudio::hasFrames(const uint8_t* p, size_t n, int frames) {
+    size_t pos = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        size_t length = frameLength(p + pos, n - pos);
+        if (length == 0 || (frame && !sameStream(p, p + pos))) return false;
+        pos += length;
+        if (frame + 1 < frames && pos + 4 > n) return false;
+    }
+    return true;
+}
+
+size_t MpegAudio::id3Length(const uint8_t* p, size_t n) {
+    // "ID3" ثم الإصدار 2-4 والمراجعة والأعلام ثم الحجم بأربعة بايتات من 7 بتات
+    if (n < 10 || std::memcmp(p, "ID3", 3) != 0 || p[3] < 2 || p[3] > 4 || p[4] == 0xFF) return 0;
+    if ((p[6] | p[7] | p[8] | p[9]) & 0x80) return 0;
+    size_t size = (static_cast<size_t>(p[6]) << 21) | (p[7] << 14) | (p[8] << 7) | p[9];
+    return 10 + size + ((p[5] & 0x10) ? 10 : 0);
+}
+
+uint64_t MpegAudio::fileLength(const ReadFn& read, uint64_t offset, uint64_t limit,
+                               std::pmr::memory_resource* memory) {
+    // قراءة بمخزن متحرك: الإطارات بضع مئات من البايتات فيخدم المخزن الواحد مئات منها
+    std::pmr::vector<uint8_t> block(kBlock, memory);
+    uint64_t blockStart = 0;
+    size_t blockLength = 0;
+    auto view = [&](uint64_t pos, size_t size) -> const uint8_t* {
+        if (pos + size > limit) return nullptr;
+        if (pos < blockStart || pos + size > blockStart + blockLength) {
+            blockStart = pos;
+            blockLength = read(offset + pos, block.data(), static_cast<size_t>(std::min<uint64_t>(kBlock, limit - pos)));
+            if (blockLength < size) return nullptr;
+        }
+        return block.data() + (pos - blockStart);
+    };
+
+    uint64_t pos = 0;
+    const uint8_t* p = view(0, 10);
+    if (p && std::memcmp(p, "ID3", 3) == 0) {
+        pos = id3Length(p, 10);
+        if (pos == 0) return 0;
+    }
+
+    uint8_t first[4];
+    uint64_t frames = 0;
+    while ((p = view(pos, 4)) != nullptr) {
+        size_t length = frameLength(p, 4);
+        if (length == 0 || (frames && !sameStream(first, p)) || pos + length > limit) break;
+        if (frames == 0) std::memcpy(first, p, sizeof(first));
+        pos += length;
+        ++frames;
+    }
+    if (frames < 3) return 0;
+
+    // وسم ID3v1 بعد آخر إطار
+    if ((p = view(pos, 3)) != nullptr && std::memcmp(p, "TAG", 3) == 0 && pos + kId3v1 <= limit) pos += kId3v1;
+    return pos;
+}
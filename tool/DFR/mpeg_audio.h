@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+
+// MPEG audio (MP3): الملف سلسلة إطارات يُعرف طول كل منها من رأسه، فطول التيار بتتبع الرؤوس
+// من أول إطار (أو من وسم ID3v2 قبله) حتى أول رأس لا يكمل السلسلة، مع وسم ID3v1 في آخره إن وُجد.
+// كل إطار في التيار يطابق توقيع mp3 أيضًا، وهذا الطول الدقيق هو ما يسقطها كإصابات محتواة.
+class MpegAudio {
+public:
+    using ReadFn = std::function<size_t(uint64_t offset, uint8_t* out, size_t size)>;
+
+    // طول الإطار من رأسه ذي الأربعة بايتات (0 = رأس غير صالح أو معدل بت حر)
+    static size_t frameLength(const uint8_t* p, size_t n);
+
+    // هل تبدأ عند p إطارات متتالية بالصيغة نفسها عددها frames على الأقل؟
+    static bool hasFrames(const uint8_t* p, size_t n, int frames);
+
+    // طول وسم ID3v2 الذي يبدأ عند p (مع التذييل إن وُجد)، أو 0
+    static size_t id3Length(const uint8_t* p, size_t n);
+
+    // طول التيار الذي يبدأ عند offset ضمن limit بايت، أو 0 إن لم تتوالَ ثلاثة إطارات
+    static uint64_t fileLength(const ReadFn& read, uint64_t offset, uint64_t limit,
+                               std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+};
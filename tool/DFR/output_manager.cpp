@@ -1,219 +1,230 @@
+#include "output_manager.h"
+#include "recovered_index.h"
+
+#include <algorithm>
 #include <iostream>
-#include <fstream>
-#include <vector>
-#include <string>
-#include <map>
-#include <set>
-#include <filesystem>
 #include <sstream>
 #include <iomanip>
+#include <chrono>
 #include <ctime>
 
 namespace fs = std::filesystem;
 
-class OutputManager {
-public:
-    // هيكل لتخزين معلومات الملف المستعاد
-    struct RecoveredFileInfo {
-        std::string filename;
-        std::string extension;
-        size_t fileSize;
-        std::string recoveryTime;
-        std::string path;
-    };
-
-    // تصنيفات الملفات
-    enum class FileCategory {
-        IMAGE,
-        DOCUMENT,
-        AUDIO,
-        VIDEO,
-        ARCHIVE,
-        UNKNOWN
-    };
-
-    // إعداد مسار الإخراج الرئيسي
-    explicit OutputManager(const std::string& baseOutputPath)
-        : baseOutputDir(baseOutputPath), logStream(nullptr) {}
-
-    // إعداد وتوليد المجلدات الفرعية
-    bool setupDirectories() {
-        try {
-            if (!fs::exists(baseOutputDir)) {
-                if (!fs::create_directories(baseOutputDir)) {
-                    std::cerr << "[!] Failed to create base output directory: " << baseOutputDir << std::endl;
-                    return false;
-                }
-            }
+OutputManager::OutputManager(const std::string& baseOutputPath)
+    : baseOutputDir(baseOutputPath), logStream(nullptr) {}
 
-            for (const auto& [category, folder] : categoryFolders) {
-                fs::path fullPath = baseOutputDir / folder;
-                if (!fs::exists(fullPath)) {
-                    fs::create_directories(fullPath);
-                }
-            }
+OutputManager::~OutputManager() {
+    if (logStream) logStream->flush();
+    delete logStream;
+}
 
-            // إنشاء ملف Log
-            logFilePath = baseOutputDir / "recovery_log.txt";
-            logStream = new std::ofstream(logFilePath);
-            if (!logStream->is_open()) {
-                std::cerr << "[!] Failed to open log file." << std::endl;
+bool OutputManager::setupDirectories() {
+    try {
+        if (!fs::exists(baseOutputDir)) {
+            if (!fs::create_directories(baseOutputDir)) {
+                std::cerr << "[!] Failed to create base output directory: " << baseOutputDir << std::endl;
                 return false;
             }
+        }
 
-            writeLogHeader();
+        for (const auto& [category, folder] : categoryFolders) {
+            fs::path fullPath = baseOutputDir / folder;
+            if (!fs::exists(fullPath)) {
+                fs::create_directories(fullPath);
+            }
+        }
 
-        } catch (const fs::filesystem_error& e) {
-            std::cerr << "[!] Filesystem error: " << e.what() << std::endl;
+        // إنشاء ملف Log
+        logFilePath = baseOutputDir / "recovery_log.txt";
+        logStream = new std::ofstream(logFilePath);
+        if (!logStream->is_open()) {
+            std::cerr << "[!] Failed to open log file." << std::endl;
             return false;
         }
 
-        return true;
-    }
-
-    // إضافة ملف إلى التقارير وإدارته في المجلد الصحيح
-    void addRecoveredFile(const std::string& originalFilename, const std::string& extension, size_t fileSize) {
-        FileCategory category = classifyFileByExtension(extension);
-
-        fs::path targetDir = baseOutputDir / getCategoryFolder(category);
-        fs::path filePath = targetDir / originalFilename;
-
-        // تحديث معلومات الملف
-        RecoveredFileInfo info;
-        info.filename = originalFilename;
-        info.extension = extension;
-        info.fileSize = fileSize;
-        info.path = filePath.string();
-        info.recoveryTime = getCurrentTimestamp();
+        writeLogHeader();
 
-        recoveredFiles.push_back(info);
-
-        *logStream << "[RECOVERED] "
-                   << info.filename << " | "
-                   << info.extension << " | "
-                   << formatFileSize(info.fileSize) << " | "
-                   << info.recoveryTime << " | "
-                   << info.path << "\n";
-
-        logStream->flush();
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "[!] Filesystem error: " << e.what() << std::endl;
+        return false;
     }
 
-    // كتابة رأس التقرير
-    void writeLogHeader() {
-        time_t now = time(0);
-        char buffer[80];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localtime(&now));
-
-        *logStream << "=== FILE RECOVERY REPORT ===\n"
-                   << "Generated at: " << buffer << "\n"
-                   << "Base Directory: " << baseOutputDir << "\n"
-                   << "-------------------------------\n"
-                   << "FILENAME | EXT | SIZE | TIME | PATH\n";
+    return true;
+}
+
+void OutputManager::addRecoveredFile(const std::string& originalFilename, const std::string& extension, size_t fileSize) {
+    FileCategory category = classifyFileByExtension(extension);
+
+    fs::path targetDir = baseOutputDir / getCategoryFolder(category);
+    fs::path filePath = targetDir / originalFilename;
+
+    // تحديث معلومات الملف
+    RecoveredFileInfo info;
+    info.filename = originalFilename;
+    info.extension = extension;
+    info.fileSize = fileSize;
+    info.path = filePath.string();
+    info.recoveryTime = getCurrentTimestamp();
+    info.category = category;
+
+    recoveredFiles.push_back(info);
+
+    *logStream << "[RECOVERED] "
+               << info.filename << " | "
+               << info.extension << " | "
+               << formatFileSize(info.fileSize) << " | "
+               << info.recoveryTime << " | "
+               << info.path << "\n";
+
+    maybeFlushLog();
+}
+
+void OutputManager::addContainedFile(const std::string& extension, size_t fileSize, const std::string& containerFilename,
+                                     uint64_t offsetInContainer) {
+    *logStream << "[CONTAINED] "
+               << extension << " | "
+               << formatFileSize(fileSize) << " | "
+               << getCurrentTimestamp() << " | "
+               << containerFilename << " +" << offsetInContainer << "\n";
+
+    maybeFlushLog();
+}
+
+void OutputManager::maybeFlushLog() {
+    // سطر لكل ملف مع flush لكل سطر يصبح استدعاء نظام لكل ملف في مهمة بملايين الملفات
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastFlush < kLogFlushInterval) return;
+    logStream->flush();
+    lastFlush = now;
+}
+
+void OutputManager::writeLogHeader() {
+    time_t now = time(0);
+    char buffer[80];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localtime(&now));
+
+    *logStream << "=== FILE RECOVERY REPORT ===\n"
+               << "Generated at: " << buffer << "\n"
+               << "Base Directory: " << baseOutputDir << "\n"
+               << "-------------------------------\n"
+               << "FILENAME | EXT | SIZE | TIME | PATH\n";
+}
+
+void OutputManager::printRecoverySummary() const {
+    std::map<FileCategory, int> categoryCount;
+    size_t totalSize = 0;
+    if (logStream) logStream->flush();
+
+    for (const auto& file : recoveredFiles) {
+        categoryCount[file.category]++;
+        totalSize += file.fileSize;
     }
 
-    // عرض تقرير مختصر عن الملفات المستعادة
-    void printRecoverySummary() const {
-        std::map<FileCategory, int> categoryCount;
-        size_t totalSize = 0;
+    std::cout << "\n[+] Recovery Summary:\n";
+    std::cout << " - Total files recovered: " << recoveredFiles.size() << "\n";
+    std::cout << " - Total data recovered: " << formatFileSize(totalSize) << "\n";
+    std::cout << " - Categories:\n";
 
-        for (const auto& file : recoveredFiles) {
-            FileCategory cat = classifyFileByExtension(file.extension);
-            categoryCount[cat]++;
-            totalSize += file.fileSize;
-        }
-
-        std::cout << "\n[+] Recovery Summary:\n";
-        std::cout << " - Total files recovered: " << recoveredFiles.size() << "\n";
-        std::cout << " - Total data recovered: " << formatFileSize(totalSize) << "\n";
-        std::cout << " - Categories:\n";
+    for (const auto& [cat, count] : categoryCount) {
+        std::cout << "   - " << getCategoryName(cat) << ": " << count << "\n";
+    }
 
-        for (const auto& [cat, count] : categoryCount) {
-            std::cout << "   - " << getCategoryName(cat) << ": " << count << "\n";
-        }
+    if (!logFilePath.empty()) std::cout << " - Log saved to: " << logFilePath.string() << "\n";
+}
 
-        std::cout << " - Log saved to: " << logFilePath.string() << "\n";
+size_t OutputManager::loadRecoveredIndex() {
+    RecoveredIndex index;
+    try {
+        if (!index.load((baseOutputDir / "recovered.idx").string())) return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "[!] " << e.what() << std::endl;
+        return 0;
     }
 
-private:
-    std::string baseOutputDir;
-    std::string logFilePath;
-    std::ofstream* logStream;
-    std::vector<RecoveredFileInfo> recoveredFiles;
-
-    // تصنيفات المجلدات
-    const std::map<FileCategory, std::string> categoryFolders = {
-        {FileCategory::IMAGE, "images"},
-        {FileCategory::DOCUMENT, "documents"},
-        {FileCategory::AUDIO, "audio"},
-        {FileCategory::VIDEO, "videos"},
-        {FileCategory::ARCHIVE, "archives"},
-        {FileCategory::UNKNOWN, "others"}
-    };
-
-    // تصنيف الملف حسب الامتداد
-    FileCategory classifyFileByExtension(const std::string& ext) const {
-        static const std::map<std::string, FileCategory> extensionMap = {
-            {"jpg", FileCategory::IMAGE}, {"jpeg", FileCategory::IMAGE},
-            {"png", FileCategory::IMAGE}, {"gif", FileCategory::IMAGE},
-            {"bmp", FileCategory::IMAGE}, {"ico", FileCategory::IMAGE},
+    for (size_t row : index.select({})) {
+        RecoveredIndex::Entry entry = index.row(row);
+        RecoveredFileInfo info;
+        info.filename = entry.filename;
+        info.extension = entry.type;
+        info.fileSize = static_cast<size_t>(entry.size);
+        info.path = (baseOutputDir / entry.filename).string();
+        info.category = classifyFileByExtension(entry.type);
+        recoveredFiles.push_back(info);
+    }
+    return index.size();
+}
+
+void OutputManager::printRecoveredFiles(size_t limit) const {
+    size_t shown = limit ? std::min(limit, recoveredFiles.size()) : recoveredFiles.size();
+    std::cout << "\n[+] Recovered Files:\n";
+    for (size_t i = 0; i < shown; ++i) {
+        const auto& file = recoveredFiles[i];
+        std::cout << " - " << std::left << std::setw(24) << file.filename << std::right << std::setw(10)
+                  << formatFileSize(file.fileSize) << "  " << file.path << "\n";
+    }
+    if (shown < recoveredFiles.size()) {
+        std::cout << " ... " << recoveredFiles.size() - shown << " more (dfr --query <output> lists them all)\n";
+    }
+}
 
-            {"pdf", FileCategory::DOCUMENT}, {"docx", FileCategory::DOCUMENT},
-            {"xlsx", FileCategory::DOCUMENT}, {"pptx", FileCategory::DOCUMENT},
+OutputManager::FileCategory OutputManager::classifyFileByExtension(const std::string& ext) const {
+    static const std::map<std::string, FileCategory> extensionMap = {
+        {"jpg", FileCategory::IMAGE}, {"jpeg", FileCategory::IMAGE},
+        {"png", FileCategory::IMAGE}, {"gif", FileCategory::IMAGE},
+        {"bmp", FileCategory::IMAGE}, {"ico", FileCategory::IMAGE},
 
-            {"mp3", FileCategory::AUDIO}, {"wav", FileCategory::AUDIO},
-            {"ogg", FileCategory::AUDIO}, {"flac", FileCategory::AUDIO},
+        {"pdf", FileCategory::DOCUMENT}, {"docx", FileCategory::DOCUMENT},
+        {"xlsx", FileCategory::DOCUMENT}, {"pptx", FileCategory::DOCUMENT},
 
-            {"mp4", FileCategory::VIDEO}, {"avi", FileCategory::VIDEO},
-            {"mkv", FileCategory::VIDEO}, {"mov", FileCategory::VIDEO},
+        {"mp3", FileCategory::AUDIO}, {"wav", FileCategory::AUDIO},
+        {"ogg", FileCategory::AUDIO}, {"flac", FileCategory::AUDIO},
 
-            {"zip", FileCategory::ARCHIVE}, {"rar", FileCategory::ARCHIVE},
-            {"gz", FileCategory::ARCHIVE}, {"tar", FileCategory::ARCHIVE}
-        };
+        {"mp4", FileCategory::VIDEO}, {"avi", FileCategory::VIDEO},
+        {"mkv", FileCategory::VIDEO}, {"mov", FileCategory::VIDEO},
 
-        auto it = extensionMap.find(ext);
-        return (it != extensionMap.end()) ? it->second : FileCategory::UNKNOWN;
-    }
+        {"zip", FileCategory::ARCHIVE}, {"rar", FileCategory::ARCHIVE},
+        {"gz", FileCategory::ARCHIVE}, {"tar", FileCategory::ARCHIVE}
+    };
 
-    // الحصول على اسم المجلد بناءً على التصنيف
-    std::string getCategoryFolder(FileCategory cat) const {
-        for (const auto& [c, folder] : categoryFolders) {
-            if (c == cat) return folder;
-        }
-        return "others";
-    }
+    auto it = extensionMap.find(ext);
+    return (it != extensionMap.end()) ? it->second : FileCategory::UNKNOWN;
+}
 
-    // اسم التصنيف باللغة الإنجليزية
-    std::string getCategoryName(FileCategory cat) const {
-        switch (cat) {
-            case FileCategory::IMAGE: return "Images";
-            case FileCategory::DOCUMENT: return "Documents";
-            case FileCategory::AUDIO: return "Audio";
-            case FileCategory::VIDEO: return "Video";
-            case FileCategory::ARCHIVE: return "Archives";
-            default: return "Unknown";
-        }
+std::string OutputManager::getCategoryFolder(FileCategory cat) const {
+    for (const auto& [c, folder] : categoryFolders) {
+        if (c == cat) return folder;
     }
-
-    // وقت الاسترجاع الحالي
-    std::string getCurrentTimestamp() const {
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
-        return ss.str();
+    return "others";
+}
+
+std::string OutputManager::getCategoryName(FileCategory cat) const {
+    switch (cat) {
+        case FileCategory::IMAGE: return "Images";
+        case FileCategory::DOCUMENT: return "Documents";
+        case FileCategory::AUDIO: return "Audio";
+        case FileCategory::VIDEO: return "Video";
+        case FileCategory::ARCHIVE: return "Archives";
+        default: return "Unknown";
     }
-
-    // تحويل الحجم إلى صيغة قابلة للقراءة
-    std::string formatFileSize(size_t bytes) const {
-        const std::string units[] = {"B", "KB", "MB", "GB"};
-        int i = 0;
-        double size = static_cast<double>(bytes);
-        while (size >= 1024 && i < 3) {
-            size /= 1024;
-            ++i;
-        }
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(2) << size << " " << units[i];
-        return oss.str();
+}
+
+std::string OutputManager::getCurrentTimestamp() const {
+    auto now = std::chrono::system_clock::now();
+    auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+std::string OutputManager::formatFileSize(size_t bytes) const {
+    const std::string units[] = {"B", "KB", "MB", "GB"};
+    int i = 0;
+    double size = static_cast<double>(bytes);
+    while (size >= 1024 && i < 3) {
+        size /= 1024;
+        ++i;
     }
-};
\ No newline at end of file
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << size << " " << units[i];
+    return oss.str();
+}
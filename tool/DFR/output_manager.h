@@ -0,0 +1,98 @@
+#pragma once
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <filesystem>
+#include <chrono>
+
+class OutputManager {
+public:
+    // هيكل لتخزين معلومات الملف المستعاد
+    // تصنيفات الملفات
+    enum class FileCategory {
+        IMAGE,
+        DOCUMENT,
+        AUDIO,
+        VIDEO,
+        ARCHIVE,
+        UNKNOWN
+    };
+
+    struct RecoveredFileInfo {
+        std::string filename;
+        std::string extension;
+        size_t fileSize;
+        std::string recoveryTime;
+        std::string path;
+        FileCategory category = FileCategory::UNKNOWN;  // يُحسب مرة عند الإضافة
+    };
+
+    // أقصى مدة يبقى فيها سطر في مخزن السجل قبل كتابته
+    static constexpr std::chrono::milliseconds kLogFlushInterval{1000};
+
+    // إعداد مسار الإخراج الرئيسي
+    explicit OutputManager(const std::string& baseOutputPath);
+    ~OutputManager();
+
+    OutputManager(const OutputManager&) = delete;
+    OutputManager& operator=(const OutputManager&) = delete;
+
+    // إعداد وتوليد المجلدات الفرعية
+    bool setupDirectories();
+
+    // إضافة ملف إلى التقارير وإدارته في المجلد الصحيح
+    void addRecoveredFile(const std::string& originalFilename, const std::string& extension, size_t fileSize);
+
+    // تسجيل ملف داخل ملف مستعاد آخر كمرجع إليه دون نسخ بياناته
+    void addContainedFile(const std::string& extension, size_t fileSize, const std::string& containerFilename,
+                          uint64_t offsetInContainer);
+
+    // كتابة رأس التقرير
+    void writeLogHeader();
+
+    // عرض تقرير مختصر عن الملفات المستعادة
+    void printRecoverySummary() const;
+
+    // تحميل ملفات تشغيل سابق من فهرس مجلد الإخراج (recovered.idx). تُرجع عددها
+    size_t loadRecoveredIndex();
+
+    // عرض أول limit ملف مستعاد (0 = الكل)
+    void printRecoveredFiles(size_t limit = 0) const;
+
+private:
+    std::filesystem::path baseOutputDir;
+    std::filesystem::path logFilePath;
+    std::ofstream* logStream;
+    std::chrono::steady_clock::time_point lastFlush;
+    std::vector<RecoveredFileInfo> recoveredFiles;
+
+    // تصنيفات المجلدات
+    const std::map<FileCategory, std::string> categoryFolders = {
+        {FileCategory::IMAGE, "images"},
+        {FileCategory::DOCUMENT, "documents"},
+        {FileCategory::AUDIO, "audio"},
+        {FileCategory::VIDEO, "videos"},
+        {FileCategory::ARCHIVE, "archives"},
+        {FileCategory::UNKNOWN, "others"}
+    };
+
+    // تفريغ السجل إن مضى kLogFlushInterval على آخر تفريغ
+    void maybeFlushLog();
+
+    // تصنيف الملف حسب الامتداد
+    FileCategory classifyFileByExtension(const std::string& ext) const;
+
+    // الحصول على اسم المجلد بناءً على التصنيف
+    std::string getCategoryFolder(FileCategory cat) const;
+
+    // اسم التصنيف باللغة الإنجليزية
+    std::string getCategoryName(FileCategory cat) const;
+
+    // وقت الاسترجاع الحالي
+    std::string getCurrentTimestamp() const;
+
+    // تحويل الحجم إلى صيغة قابلة للقراءة
+    std::string formatFileSize(size_t bytes) const;
+};
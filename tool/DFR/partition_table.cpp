@@ -0,0 +1,393 @@
+#include "partition_table.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+uint32_t readLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t readLE64(const uint8_t* p) {
+    return static_cast<uint64_t>(readLE32(p)) | (static_cast<uint64_t>(readLE32(p + 4)) << 32);
+}
+
+bool hasBootSignature(const std::vector<uint8_t>& sector) {
+    return sector.size() >= 512 && sector[510] == 0x55 && sector[511] == 0xAA;
+}
+
+// CRC-32 (IEEE 802.3) كما يحسبه رأس GPT لنفسه ولمصفوفة مدخلاته
+uint32_t crc32(const uint8_t* p, size_t n) {
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// حدود أمان ضد الجداول التالفة
+constexpr int kMaxLogicalPartitions = 128;
+constexpr uint32_t kMaxGptEntries = 1024;
+constexpr uint32_t kMaxGptEntrySize = 4096;
+
+} // namespace
+
+PartitionTable::Layout PartitionTable::read(DiskReader& reader, uint64_t diskSize) {
+    Layout layout;
+    layout.diskSize = diskSize;
+    layout.sectorSize = reader.getDiskInfo().sectorSize;
+
+    std::vector<uint8_t> sector0;
+    try {
+        sector0 = reader.readBytes(0, 512);
+    } catch (const std::exception& e) {
+        LOG_WARN("Partitions", "Cannot read sector 0: ", e.what());
+        computeGaps(layout);
+        return layout;
+    }
+
+    // قطاع إقلاع نظام ملفات في القطاع 0 يعني أن الجهاز قسم واحد بلا جدول
+    // (قطاعات FAT تحمل أيضًا 55AA فيجب فحصها قبل MBR)
+    FileSystemType volume = FileSystemAnalyzer::detectFileSystem(sector0);
+    if (volume != FileSystemType::UNKNOWN) {
+        Partition whole;
+        whole.index = 1;
+        whole.length = diskSize;
+        whole.type = "volume";
+        whole.fileSystem = volume;
+        layout.partitions.push_back(whole);
+    } else if (hasBootSignature(sector0)) {
+        if (!readMbr(reader, sector0, layout)) {
+            LOG_WARN("Partitions", "MBR signature present but no usable partition entries");
+        }
+        detectFileSystems(reader, layout);
+    }
+
+    computeGaps(layout);
+    LOG_INFO("Partitions", schemeName(layout.scheme), ": ", layout.partitions.size(), " partitions, ",
+             layout.gaps.size(), " unpartitioned gaps");
+    return layout;
+}
+
+bool PartitionTable::readMbr(DiskReader& reader, const std::vector<uint8_t>& sector0, Layout& layout) {
+    const uint64_t sector = layout.sectorSize;
+    bool protective = false;
+
+    for (int i = 0; i < 4; ++i) {
+        const uint8_t* entry = sector0.data() + 446 + i * 16;
+        uint8_t type = entry[4];
+        uint64_t firstLba = readLE32(entry + 8);
+        uint64_t sectors = readLE32(entry + 12);
+        if (type == 0 || sectors == 0) continue;
+
+        if (type == 0xEE) {
+            protective = true;
+            continue;
+        }
+        if (isExtendedType(type)) {
+            readExtended(reader, firstLba * sector, layout);
+            continue;
+        }
+
+        if (layout.diskSize && firstLba * sector >= layout.diskSize) {
+            LOG_WARN("Partitions", "MBR entry ", i + 1, " starts beyond the end of the device, ignored");
+            continue;
+        }
+
+        char code[8];
+        std::snprintf(code, sizeof(code), "0x%02X", type);
+        Partition partition;
+        partition.index = i + 1;
+        partition.start = firstLba * sector;
+        partition.length = sectors * sector;
+        partition.type = code;
+        layout.partitions.push_back(partition);
+    }
+
+    if (protective && readGpt(reader, layout)) {
+        return true;
+    }
+
+    layout.scheme = Scheme::MBR;
+    std::sort(layout.partitions.begin(), layout.partitions.end(),
+              [](const Partition& a, const Partition& b) { return a.start < b.start; });
+    return !layout.partitions.empty();
+}
+
+void PartitionTable::readExtended(DiskReader& reader, uint64_t extendedStart, Layout& layout) {
+    // سلسلة EBR: المدخل الأول قسم منطقي نسبةً إلى EBR الحالي، والثاني رابط للـ EBR التالي نسبةً لبداية الممتد
+    const uint64_t sector = layout.sectorSize;
+    uint64_t ebr = extendedStart;
+    int logicalIndex = 5;
+
+    for (int guard = 0; guard < kMaxLogicalPartitions; ++guard) {
+        std::vector<uint8_t> record;
+        try {
+            record = reader.readBytes(ebr, 512);
+        } catch (const std::exception& e) {
+            LOG_WARN("Partitions", "Cannot read EBR at ", ebr, ": ", e.what());
+            return;
+        }
+        if (!hasBootSignature(record)) return;
+
+        const uint8_t* logical = record.data() + 446;
+        const uint8_t* next = record.data() + 462;
+        if (logical[4] != 0 && readLE32(logical + 12) != 0) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "0x%02X", logical[4]);
+            Partition partition;
+            partition.index = logicalIndex++;
+            partition.start = ebr + static_cast<uint64_t>(readLE32(logical + 8)) * sector;
+            partition.length = static_cast<uint64_t>(readLE32(logical + 12)) * sector;
+            partition.type = code;
+            layout.partitions.push_back(partition);
+        }
+
+        if (!isExtendedType(next[4]) || readLE32(next + 8) == 0) return;
+        ebr = extendedStart + static_cast<uint64_t>(readLE32(next + 8)) * sector;
+    }
+    LOG_WARN("Partitions", "Extended partition chain too long, stopping at ", kMaxLogicalPartitions, " entries");
+}
+
+bool PartitionTable::readGpt(DiskReader& reader, Layout& layout) {
+    // رأس GPT في LBA 1؛ نجرب قطاعات 512 ثم 4096. الرأس التالف يُستبدل بالنسخة الاحتياطية
+    // في آخر القرص، وإن فشلت الاثنتان يُمسح القرص كبيانات خام
+    for (uint64_t sector : {uint64_t(512), uint64_t(4096)}) {
+        std::vector<uint8_t> primary;
+        bool primaryValid = readGptHeader(reader, sector, 1, layout, primary);
+        if (primaryValid && readGptEntries(reader, sector, primary, layout)) {
+            layout.sectorSize = sector;
+            return true;
+        }
+
+        uint64_t backupLba = layout.diskSize >= 2 * sector ? layout.diskSize / sector - 1 : 0;
+        if (primaryValid) backupLba = readLE64(primary.data() + 32);
+        std::vector<uint8_t> backup;
+        if (backupLba > 1 && readGptHeader(reader, sector, backupLba, layout, backup) &&
+            readGptEntries(reader, sector, backup, layout)) {
+            LOG_WARN("Partitions", "Primary GPT is damaged, using the backup header at LBA ", backupLba);
+            layout.sectorSize = sector;
+            return true;
+        }
+    }
+    LOG_WARN("Partitions", "Protective MBR without a valid GPT header, scanning the device as raw data");
+    return false;
+}
+
+bool PartitionTable::readGptHeader(DiskReader& reader, uint64_t sector, uint64_t lba, const Layout& layout,
+                                   std::vector<uint8_t>& header) {
+    if (lba > UINT64_MAX / sector || (layout.diskSize && (lba + 1) * sector > layout.diskSize)) return false;
+    try {
+        header = reader.readBytes(lba * sector, static_cast<size_t>(sector));
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (header.size() < 92 || std::memcmp(header.data(), "EFI PART", 8) != 0) return false;
+
+    uint32_t headerSize = readLE32(header.data() + 12);
+    if (headerSize < 92 || headerSize > header.size()) {
+        LOG_WARN("Partitions", "GPT header at LBA ", lba, " has an invalid size ", headerSize);
+        return false;
+    }
+    // الـ CRC محسوب على الرأس وحقله نفسه أصفار
+    std::vector<uint8_t> copy(header.begin(), header.begin() + headerSize);
+    std::memset(copy.data() + 16, 0, 4);
+    if (crc32(copy.data(), copy.size()) != readLE32(header.data() + 16)) {
+        LOG_WARN("Partitions", "GPT header at LBA ", lba, " fails its CRC32 check");
+        return false;
+    }
+
+    uint32_t entryCount = readLE32(header.data() + 80);
+    uint32_t entrySize = readLE32(header.data() + 84);
+    if (readLE64(header.data() + 24) != lba || entryCount == 0 || entryCount > kMaxGptEntries ||
+        entrySize < 128 || entrySize % 8 != 0 || entrySize > kMaxGptEntrySize) {
+        LOG_WARN("Partitions", "GPT header at LBA ", lba, " has invalid fields (", entryCount, " entries of ",
+                 entrySize, " bytes)");
+        return false;
+    }
+    return true;
+}
+
+bool PartitionTable::readGptEntries(DiskReader& reader, uint64_t sector, const std::vector<uint8_t>& header,
+                                    Layout& layout) {
+    uint64_t entriesLba = readLE64(header.data() + 72);
+    uint32_t entryCount = readLE32(header.data() + 80);
+    uint32_t entrySize = readLE32(header.data() + 84);
+    size_t entriesBytes = static_cast<size_t>(entryCount) * entrySize;
+    if (entriesLba > UINT64_MAX / sector ||
+        (layout.diskSize && entriesLba * sector + entriesBytes > layout.diskSize)) {
+        LOG_WARN("Partitions", "GPT entries at LBA ", entriesLba, " lie outside the device");
+        return false;
+    }
+
+    std::vector<uint8_t> entries;
+    try {
+        entries = reader.readBytes(entriesLba * sector, entriesBytes);
+    } catch (const std::exception& e) {
+        LOG_WARN("Partitions", "Cannot read GPT entries: ", e.what());
+        return false;
+    }
+    if (entries.size() < entriesBytes || crc32(entries.data(), entriesBytes) != readLE32(header.data() + 88)) {
+        LOG_WARN("Partitions", "GPT entries at LBA ", entriesLba, " fail their CRC32 check");
+        return false;
+    }
+
+    std::vector<Partition> partitions;
+    size_t rejected = 0;
+    static const uint8_t zeroGuid[16] = {};
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        const uint8_t* entry = entries.data() + static_cast<size_t>(i) * entrySize;
+        if (std::memcmp(entry, zeroGuid, 16) == 0) continue;
+
+        uint64_t firstLba = readLE64(entry + 32);
+        uint64_t lastLba = readLE64(entry + 40);
+        // مدخلات تالفة: نهاية قبل البداية أو خارج القرص
+        if (lastLba < firstLba || lastLba > UINT64_MAX / sector ||
+            (layout.diskSize && (lastLba + 1) * sector > layout.diskSize)) {
+            ++rejected;
+            continue;
+        }
+
+        // الاسم UTF-16LE؛ نحتفظ بالجزء ASCII فقط
+        std::string name;
+        for (size_t c = 0; c < 36; ++c) {
+            uint16_t ch = entry[56 + c * 2] | (entry[57 + c * 2] << 8);
+            if (ch == 0) break;
+            name += ch < 0x80 ? static_cast<char>(ch) : '?';
+        }
+
+        Partition partition;
+        partition.index = static_cast<int>(i) + 1;
+        partition.start = firstLba * sector;
+        partition.length = (lastLba - firstLba + 1) * sector;
+        partition.type = formatGuid(entry);
+        partition.name = name;
+        partitions.push_back(partition);
+    }
+
+    if (rejected) {
+        LOG_WARN("Partitions", "Ignored ", rejected, " GPT entries outside the device");
+    }
+    std::sort(partitions.begin(), partitions.end(),
+              [](const Partition& a, const Partition& b) { return a.start < b.start; });
+    layout.partitions = std::move(partitions);
+    layout.scheme = Scheme::GPT;
+    return true;
+}
+
+void PartitionTable::detectFileSystems(DiskReader& reader, Layout& layout) {
+    for (auto& partition : layout.partitions) {
+        try {
+            partition.fileSystem = FileSystemAnalyzer::detectFileSystem(reader.readBytes(partition.start, 512));
+        } catch (const std::exception& e) {
+            LOG_WARN("Partitions", "Cannot read boot sector of partition ", partition.index, ": ", e.what());
+        }
+    }
+}
+
+void PartitionTable::computeGaps(Layout& layout) {
+    layout.gaps.clear();
+    if (layout.diskSize == 0) return;
+
+    uint64_t cursor = 0;
+    for (const auto& partition : layout.partitions) {
+        if (partition.start > cursor) {
+            layout.gaps.push_back({cursor, std::min(partition.start, layout.diskSize) - cursor, "gap"});
+        }
+        cursor = std::max(cursor, partition.start + partition.length);
+        if (cursor >= layout.diskSize) return;
+    }
+    if (cursor < layout.diskSize) {
+        layout.gaps.push_back({cursor, layout.diskSize - cursor, "gap"});
+    }
+}
+
+std::vector<ScanExtent> PartitionTable::toExtents(const Layout& layout, bool includeGaps) {
+    std::vector<ScanExtent> extents;
+    for (const auto& partition : layout.partitions) {
+        std::string label = "p" + std::to_string(partition.index);
+        if (partition.fileSystem != FileSystemType::UNKNOWN) {
+            label += std::string(" ") + FileSystemAnalyzer::fileSystemName(partition.fileSystem);
+        }
+        extents.push_back({partition.start, partition.length, label});
+    }
+    if (includeGaps) {
+        extents.insert(extents.end(), layout.gaps.begin(), layout.gaps.end());
+    }
+    return extents;
+}
+
+std::vector<ScanExtent> PartitionTable::intersect(const std::vector<ScanExtent>& layoutExtents,
+                                                  const std::vector<ScanExtent>& requested) {
+    std::vector<ScanExtent> result;
+    for (const auto& region : layoutExtents) {
+        for (const auto& wanted : requested) {
+            uint64_t wantedEnd = wanted.length ? wanted.end() : UINT64_MAX;
+            uint64_t start = std::max(region.start, wanted.start);
+            uint64_t end = std::min(region.end(), wantedEnd);
+            if (start < end) result.push_back({start, end - start, region.label});
+        }
+    }
+    return result;
+}
+
+const char* PartitionTable::schemeName(Scheme scheme) {
+    switch (scheme) {
+        case Scheme::MBR: return "mbr";
+        case Scheme::GPT: return "gpt";
+        default:          return "none";
+    }
+}
+
+std::string PartitionTable::toJson(const Layout& layout) {
+    std::ostringstream json;
+    json << "{\"scheme\": \"" << schemeName(layout.scheme) << "\""
+         << ", \"sector_size\": " << layout.sectorSize
+         << ", \"disk_size\": " << layout.diskSize
+         << ", \"partitions\": [";
+    for (size_t i = 0; i < layout.partitions.size(); ++i) {
+        const auto& p = layout.partitions[i];
+        json << (i ? ", " : "") << "{\"index\": " << p.index
+             << ", \"start\": " << p.start
+             << ", \"length\": " << p.length
+             << ", \"type\": \"" << Utils::jsonEscape(p.type) << "\""
+             << ", \"name\": \"" << Utils::jsonEscape(p.name) << "\""
+             << ", \"file_system\": \"" << FileSystemAnalyzer::fileSystemName(p.fileSystem) << "\"}";
+    }
+    json << "], \"gaps\": [";
+    for (size_t i = 0; i < layout.gaps.size(); ++i) {
+        json << (i ? ", " : "") << "{\"start\": " << layout.gaps[i].start
+             << ", \"length\": " << layout.gaps[i].length << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+std::string PartitionTable::formatGuid(const uint8_t* guid) {
+    // أول ثلاثة حقول مخزنة little-endian
+    char text[37];
+    std::snprintf(text, sizeof(text),
+                  "%02X%02X%02X%02X-%02X%02X-%02X%02X-%02X%02X-%02X%02X%02X%02X%02X%02X",
+                  guid[3], guid[2], guid[1], guid[0], guid[5], guid[4], guid[7], guid[6],
+                  guid[8], guid[9], guid[10], guid[11], guid[12], guid[13], guid[14], guid[15]);
+    return text;
+}
+
+bool PartitionTable::isExtendedType(uint8_t type) {
+    return type == 0x05 || type == 0x0F || type == 0x85;
+}
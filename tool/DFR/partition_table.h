@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "disk_reader.h"
+#include "file_system_analyzer.h"
+#include "scan_extent.h"
+
+// قراءة جدول الأقسام (MBR مع الأقسام الممتدة، أو GPT خلف MBR الحماية)
+// وتحديد نظام الملفات عند بداية كل قسم والفجوات غير المقسمة بينها.
+class PartitionTable {
+public:
+    enum class Scheme {
+        NONE,       // لا يوجد جدول: الجهاز قسم واحد (أو بيانات خام)
+        MBR,
+        GPT
+    };
+
+    struct Partition {
+        int index = 0;              // رقم القسم بدءًا من 1
+        uint64_t start = 0;         // بالبايت
+        uint64_t length = 0;
+        std::string type;           // رمز MBR مثل 0x07 أو GUID النوع في GPT
+        std::string name;           // اسم القسم في GPT
+        FileSystemType fileSystem = FileSystemType::UNKNOWN;
+    };
+
+    struct Layout {
+        Scheme scheme = Scheme::NONE;
+        uint64_t diskSize = 0;
+        size_t sectorSize = 512;
+        std::vector<Partition> partitions;      // مرتبة حسب البداية
+        std::vector<ScanExtent> gaps;           // مناطق غير مقسمة تُمسح كبيانات خام
+    };
+
+    // قراءة التخطيط من القرص (diskSize = 0 يعني مجهول: لا تُحسب الفجوة الأخيرة)
+    static Layout read(DiskReader& reader, uint64_t diskSize);
+
+    // مقاطع المسح: قسم لكل مقطع باسم "pN <fs>" ثم الفجوات باسم "gap"
+    static std::vector<ScanExtent> toExtents(const Layout& layout, bool includeGaps = true);
+
+    // تقاطع مقاطع التخطيط مع مقاطع حددها المستخدم (مع الإبقاء على الأسماء)
+    static std::vector<ScanExtent> intersect(const std::vector<ScanExtent>& layoutExtents,
+                                             const std::vector<ScanExtent>& requested);
+
+    static const char* schemeName(Scheme scheme);
+
+    // تمثيل التخطيط ككائن JSON في سطر واحد
+    static std::string toJson(const Layout& layout);
+
+private:
+    static bool readMbr(DiskReader& reader, const std::vector<uint8_t>& sector0, Layout& layout);
+    static bool readGpt(DiskReader& reader, Layout& layout);
+    // رأس GPT في lba بعد فحص التوقيع وCRC32 وحدود المدخلات (false = غائب أو تالف)
+    static bool readGptHeader(DiskReader& reader, uint64_t sector, uint64_t lba, const Layout& layout,
+                              std::vector<uint8_t>& header);
+    // مصفوفة المدخلات التي يشير إليها رأس سليم بعد فحص CRC32 الخاص بها
+    static bool readGptEntries(DiskReader& reader, uint64_t sector, const std::vector<uint8_t>& header,
+                               Layout& layout);
+    static void readExtended(DiskReader& reader, uint64_t extendedStart, Layout& layout);
+    static void detectFileSystems(DiskReader& reader, Layout& layout);
+    static void computeGaps(Layout& layout);
+
+    static std::string formatGuid(const uint8_t* guid);
+    static bool isExtendedType(uint8_t type);
+};
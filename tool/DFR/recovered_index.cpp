@@ -0,0 +1,502 @@
+#include "recovered_index.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+const char kMagic[8] = {'D', 'F', 'R', 'R', 'I', 'D', 'X', '1'};
+
+// أنواع الأعمدة في الملف
+enum ColumnKind : uint8_t {
+    U64 = 1,
+    I64 = 2,
+    U8 = 3,
+    DIGEST = 4,
+    STRINGS = 5,
+    DICT = 6
+};
+
+template <typename T>
+void put(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putString(std::string& out, const std::string& value) {
+    put(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+template <typename T>
+void putArray(std::string& out, const std::vector<T>& values) {
+    out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+// قراءة متتابعة من حمولة عمود مع التحقق من الحدود
+struct Cursor {
+    std::string_view data;
+    size_t pos = 0;
+
+    template <typename T>
+    T get() {
+        T value;
+        need(sizeof(T));
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+    std::string getString() {
+        uint32_t length = get<uint32_t>();
+        need(length);
+        std::string value(data.substr(pos, length));
+        pos += length;
+        return value;
+    }
+    template <typename T>
+    void getArray(std::vector<T>& values, size_t count) {
+        need(count * sizeof(T));
+        values.resize(count);
+        std::memcpy(values.data(), data.data() + pos, count * sizeof(T));
+        pos += count * sizeof(T);
+    }
+    void need(size_t bytes) const {
+        if (bytes > data.size() - pos) throw std::runtime_error("truncated column");
+    }
+};
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+bool compareWith(const std::string& op, int cmp) {
+    if (op == "=") return cmp == 0;
+    if (op == "!=") return cmp != 0;
+    if (op == "<") return cmp < 0;
+    if (op == "<=") return cmp <= 0;
+    if (op == ">") return cmp > 0;
+    return cmp >= 0;
+}
+
+bool isNumericField(const std::string& field) {
+    return field == "offset" || field == "size" || field == "date" || field == "year";
+}
+
+} // namespace
+
+uint32_t RecoveredIndex::DictColumn::intern(const std::string& value) {
+    auto it = ids.find(value);
+    if (it != ids.end()) return it->second;
+    uint32_t id = static_cast<uint32_t>(values.size());
+    values.push_back(value);
+    ids.emplace(value, id);
+    return id;
+}
+
+void RecoveredIndex::applyMetadata(Entry& entry, const MetadataExtractor::Metadata& metadata) {
+    entry.date = parseDate(metadata.get("DateTime", metadata.get("Year")));
+    entry.gps = metadata.get("GPS") == "Yes";
+    entry.author = metadata.get("Artist", metadata.get("Author", metadata.get("Creator")));
+    entry.make = metadata.get("Make");
+    entry.model = metadata.get("Model");
+    entry.title = metadata.get("Title");
+}
+
+int64_t RecoveredIndex::parseDate(const std::string& text) {
+    std::string digits;
+    for (char c : text) {
+        if (std::isdigit(static_cast<unsigned char>(c))) digits += c;
+        if (digits.size() == 14) break;
+    }
+    if (digits.size() < 4) return 0;
+    digits.resize(14, '0');
+    return std::stoll(digits);
+}
+
+void RecoveredIndex::add(const Entry& entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    indexNamesLocked();
+    auto existing = rowByName.find(entry.filename);
+    size_t row = existing != rowByName.end() ? existing->second : offsets.size();
+    if (row == offsets.size()) {
+        offsets.emplace_back();
+        sizes.emplace_back();
+        dates.emplace_back();
+        flags.emplace_back();
+        hashes.emplace_back();
+        names.emplace_back(entry.filename);
+        for (DictColumn* column : {&types, &authors, &makes, &models, &titles}) column->rows.emplace_back();
+        rowByName[entry.filename] = row;
+    }
+
+    offsets[row] = entry.offset;
+    sizes[row] = entry.size;
+    dates[row] = entry.date;
+    flags[row] = (entry.gps ? kGps : 0);
+    hashes[row] = {};
+    if (entry.sha256.size() == 64) {
+        for (size_t i = 0; i < 32; ++i) hashes[row][i] = static_cast<uint8_t>(std::stoi(entry.sha256.substr(i * 2, 2), nullptr, 16));
+        flags[row] |= kHashed;
+    }
+    types.rows[row] = types.intern(entry.type);
+    authors.rows[row] = authors.intern(entry.author);
+    makes.rows[row] = makes.intern(entry.make);
+    models.rows[row] = models.intern(entry.model);
+    titles.rows[row] = titles.intern(entry.title);
+}
+
+size_t RecoveredIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return offsets.size();
+}
+
+bool RecoveredIndex::find(const std::string& filename, Entry& entry) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    indexNamesLocked();
+    auto it = rowByName.find(filename);
+    if (it == rowByName.end()) return false;
+    entry = rowLocked(it->second);
+    return true;
+}
+
+void RecoveredIndex::indexNamesLocked() const {
+    // خريطة الأسماء تُبنى عند أول إضافة أو بحث بالاسم فقط، فالاستعلام لا يدفع ثمنها
+    if (rowByName.size() == names.size()) return;
+    rowByName.clear();
+    for (size_t r = 0; r < names.size(); ++r) rowByName[names[r]] = r;
+}
+
+RecoveredIndex::Entry RecoveredIndex::row(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return rowLocked(index);
+}
+
+RecoveredIndex::Entry RecoveredIndex::rowLocked(size_t index) const {
+    Entry entry;
+    entry.filename = names[index];
+    entry.type = types.values[types.rows[index]];
+    entry.offset = offsets[index];
+    entry.size = sizes[index];
+    if (flags[index] & kHashed) entry.sha256 = Sha256::toHex(hashes[index]);
+    entry.date = dates[index];
+    entry.gps = flags[index] & kGps;
+    entry.author = authors.values[authors.rows[index]];
+    entry.make = makes.values[makes.rows[index]];
+    entry.model = models.values[models.rows[index]];
+    entry.title = titles.values[titles.rows[index]];
+    return entry;
+}
+
+bool RecoveredIndex::save(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        auto column = [&](const char* name, ColumnKind kind, const std::string& payload) {
+            std::string header;
+            put(header, static_cast<uint8_t>(std::strlen(name)));
+            header += name;
+            put(header, static_cast<uint8_t>(kind));
+            put(header, static_cast<uint64_t>(payload.size()));
+            out << header << payload;
+        };
+        auto dict = [](const DictColumn& source) {
+            std::string payload;
+            put(payload, static_cast<uint32_t>(source.values.size()));
+            for (const auto& value : source.values) putString(payload, value);
+            putArray(payload, source.rows);
+            return payload;
+        };
+
+        std::string header(kMagic, sizeof(kMagic));
+        put(header, static_cast<uint64_t>(offsets.size()));
+        put(header, static_cast<uint32_t>(11));
+        out << header;
+
+        std::string payload;
+        putArray(payload, offsets);
+        column("offset", U64, payload);
+        payload.clear();
+        putArray(payload, sizes);
+        column("size", U64, payload);
+        payload.clear();
+        putArray(payload, dates);
+        column("date", I64, payload);
+        payload.clear();
+        putArray(payload, flags);
+        column("flags", U8, payload);
+        payload.clear();
+        for (const auto& digest : hashes) payload.append(reinterpret_cast<const char*>(digest.data()), digest.size());
+        column("sha256", DIGEST, payload);
+        payload.clear();
+        for (const auto& name : names) putString(payload, name);
+        column("name", STRINGS, payload);
+        column("type", DICT, dict(types));
+        column("author", DICT, dict(authors));
+        column("make", DICT, dict(makes));
+        column("model", DICT, dict(models));
+        column("title", DICT, dict(titles));
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+bool RecoveredIndex::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(kMagic) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error(path + ": not a recovered-files index");
+    }
+    Cursor cursor{data, sizeof(kMagic)};
+    size_t rows = static_cast<size_t>(cursor.get<uint64_t>());
+    uint32_t columns = cursor.get<uint32_t>();
+    // كل صف يشغل بايتًا على الأقل في عمود flags، فعدد أكبر من حجم الملف تلف
+    if (rows > data.size()) throw std::runtime_error(path + ": bad row count");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    clearLocked(rows);
+    try {
+        loadColumns(data, cursor.pos, rows, columns);
+    } catch (const std::runtime_error& e) {
+        clearLocked(0);
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    return true;
+}
+
+void RecoveredIndex::clearLocked(size_t rows) {
+    offsets.assign(rows, 0);
+    sizes.assign(rows, 0);
+    dates.assign(rows, 0);
+    flags.assign(rows, 0);
+    hashes.assign(rows, {});
+    names.assign(rows, "");
+    for (DictColumn* column : {&types, &authors, &makes, &models, &titles}) *column = DictColumn{};
+    for (DictColumn* column : {&types, &authors, &makes, &models, &titles}) column->rows.assign(rows, 0);
+    rowByName.clear();
+}
+
+void RecoveredIndex::loadColumns(std::string_view data, size_t pos, size_t rows, uint32_t columns) {
+    Cursor cursor{data, pos};
+
+    for (uint32_t c = 0; c < columns; ++c) {
+        uint8_t nameLength = cursor.get<uint8_t>();
+        cursor.need(nameLength);
+        std::string name(data.substr(cursor.pos, nameLength));
+        cursor.pos += nameLength;
+        uint8_t kind = cursor.get<uint8_t>();
+        uint64_t bytes = cursor.get<uint64_t>();
+        cursor.need(bytes);
+        Cursor column{data.substr(cursor.pos, bytes)};
+        cursor.pos += bytes;
+
+        if (name == "offset" && kind == U64) {
+            column.getArray(offsets, rows);
+        } else if (name == "size" && kind == U64) {
+            column.getArray(sizes, rows);
+        } else if (name == "date" && kind == I64) {
+            column.getArray(dates, rows);
+        } else if (name == "flags" && kind == U8) {
+            column.getArray(flags, rows);
+        } else if (name == "sha256" && kind == DIGEST) {
+            column.getArray(hashes, rows);
+        } else if (name == "name" && kind == STRINGS) {
+            for (size_t r = 0; r < rows; ++r) names[r] = column.getString();
+        } else if (DictColumn* target = kind == DICT ? dictColumn(name) : nullptr) {
+            uint32_t count = column.get<uint32_t>();
+            target->values.clear();
+            target->ids.clear();
+            for (uint32_t i = 0; i < count; ++i) {
+                target->values.push_back(column.getString());
+                target->ids.emplace(target->values.back(), i);
+            }
+            if (target->values.empty()) throw std::runtime_error("empty dictionary in column " + name);
+            column.getArray(target->rows, rows);
+            for (uint32_t id : target->rows) {
+                if (id >= count) throw std::runtime_error("bad dictionary id in column " + name);
+            }
+        }
+        // الأعمدة غير المعروفة (من إصدار أحدث) تُتخطى
+    }
+
+}
+
+RecoveredIndex::Filter RecoveredIndex::parseFilter(const std::string& expression) {
+    static const char* const kOps[] = {"!=", "<=", ">=", "=", "<", ">", "~"};
+    Filter filter;
+    size_t best = std::string::npos;
+    for (const char* op : kOps) {
+        size_t pos = expression.find(op);
+        if (pos != std::string::npos && (best == std::string::npos || pos < best)) {
+            best = pos;
+            filter.op = op;
+        }
+    }
+    filter.field = lower(Utils::trim(expression.substr(0, best)));
+    if (best != std::string::npos) filter.value = Utils::trim(expression.substr(best + filter.op.size()));
+
+    const auto& known = fields();
+    if (std::find(known.begin(), known.end(), filter.field) == known.end()) {
+        throw std::invalid_argument("unknown field '" + filter.field + "' in '" + expression + "'");
+    }
+    if (!filter.op.empty() && filter.value.empty()) {
+        throw std::invalid_argument("missing value in '" + expression + "'");
+    }
+    return filter;
+}
+
+const std::vector<std::string>& RecoveredIndex::fields() {
+    static const std::vector<std::string> list = {"name",   "type",   "offset", "size",  "date", "year",
+                                                  "gps",    "author", "make",   "model", "title", "hash"};
+    return list;
+}
+
+RecoveredIndex::DictColumn* RecoveredIndex::dictColumn(const std::string& field) {
+    return const_cast<DictColumn*>(static_cast<const RecoveredIndex*>(this)->dictColumn(field));
+}
+
+const RecoveredIndex::DictColumn* RecoveredIndex::dictColumn(const std::string& field) const {
+    if (field == "type") return &types;
+    if (field == "author") return &authors;
+    if (field == "make") return &makes;
+    if (field == "model") return &models;
+    if (field == "title") return &titles;
+    return nullptr;
+}
+
+void RecoveredIndex::filterRows(const Filter& filter, std::vector<uint8_t>& keep) const {
+    size_t rows = keep.size();
+
+    if (isNumericField(filter.field)) {
+        const std::vector<uint64_t>* unsignedColumn = filter.field == "offset" ? &offsets
+                                                      : filter.field == "size" ? &sizes
+                                                                               : nullptr;
+        int64_t value = 0;
+        if (!filter.op.empty()) {
+            if (unsignedColumn) value = static_cast<int64_t>(Utils::parseSize(filter.value));
+            else if (filter.field == "date") value = parseDate(filter.value);
+            else value = std::stoll(filter.value);
+        }
+        for (size_t r = 0; r < rows; ++r) {
+            if (!keep[r]) continue;
+            int64_t v = unsignedColumn ? static_cast<int64_t>((*unsignedColumn)[r])
+                        : filter.field == "date" ? dates[r]
+                                                 : dates[r] / 10000000000LL;
+            keep[r] = filter.op.empty() ? v != 0 : compareWith(filter.op, (v > value) - (v < value));
+        }
+        return;
+    }
+
+    if (filter.field == "gps") {
+        bool wanted = filter.op.empty() || (lower(filter.value) != "no" && filter.value != "0");
+        if (filter.op == "!=") wanted = !wanted;
+        for (size_t r = 0; r < rows; ++r) keep[r] = keep[r] && ((flags[r] & kGps) != 0) == wanted;
+        return;
+    }
+
+    // النصوص: مقارنة أو احتواء بلا حساسية لحالة الأحرف
+    std::string needle = lower(filter.value);
+    auto matches = [&](const std::string& text) {
+        if (filter.op.empty()) return !text.empty();
+        std::string value = lower(text);
+        if (filter.op == "~") return value.find(needle) != std::string::npos;
+        return compareWith(filter.op, value.compare(needle));
+    };
+
+    if (const DictColumn* column = dictColumn(filter.field)) {
+        // الشرط يُحسب مرة لكل قيمة في القاموس ثم يُطبق على أرقام الصفوف
+        std::vector<uint8_t> idMatches(column->values.size());
+        for (size_t id = 0; id < column->values.size(); ++id) idMatches[id] = matches(column->values[id]);
+        for (size_t r = 0; r < rows; ++r) keep[r] = keep[r] && idMatches[column->rows[r]];
+        return;
+    }
+
+    for (size_t r = 0; r < rows; ++r) {
+        if (!keep[r]) continue;
+        if (filter.field == "name") {
+            keep[r] = matches(names[r]);
+        } else {
+            // البصمة: = تقبل بادئة
+            std::string hash = (flags[r] & kHashed) ? Sha256::toHex(hashes[r]) : "";
+            keep[r] = filter.op == "=" ? !needle.empty() && hash.compare(0, needle.size(), needle) == 0
+                                       : matches(hash);
+        }
+    }
+}
+
+std::vector<size_t> RecoveredIndex::select(const std::vector<Filter>& filters, const std::string& sortField,
+                                           bool descending, size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<uint8_t> keep(offsets.size(), 1);
+    for (const auto& filter : filters) filterRows(filter, keep);
+
+    std::vector<size_t> selected;
+    for (size_t r = 0; r < keep.size(); ++r) {
+        if (keep[r]) selected.push_back(r);
+    }
+
+    // مفتاح الترتيب رقمي لكل صف (النصوص برتبة قيمتها في القاموس المرتب)
+    std::string field = sortField.empty() ? "offset" : lower(sortField);
+    std::vector<int64_t> key(offsets.size());
+    if (field == "offset" || field == "size") {
+        const auto& column = field == "offset" ? offsets : sizes;
+        for (size_t r : selected) key[r] = static_cast<int64_t>(column[r]);
+    } else if (field == "date" || field == "year") {
+        for (size_t r : selected) key[r] = dates[r];
+    } else if (field == "gps") {
+        for (size_t r : selected) key[r] = flags[r] & kGps;
+    } else if (const DictColumn* column = dictColumn(field)) {
+        std::vector<uint32_t> order(column->values.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&](uint32_t a, uint32_t b) { return column->values[a] < column->values[b]; });
+        std::vector<int64_t> rank(order.size());
+        for (size_t i = 0; i < order.size(); ++i) rank[order[i]] = static_cast<int64_t>(i);
+        for (size_t r : selected) key[r] = rank[column->rows[r]];
+    } else if (field == "name" || field == "hash") {
+        std::vector<size_t> order = selected;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return field == "name" ? names[a] < names[b] : hashes[a] < hashes[b];
+        });
+        for (size_t i = 0; i < order.size(); ++i) key[order[i]] = static_cast<int64_t>(i);
+    } else {
+        throw std::invalid_argument("unknown sort field '" + sortField + "'");
+    }
+
+    std::stable_sort(selected.begin(), selected.end(), [&](size_t a, size_t b) {
+        return descending ? key[a] > key[b] : key[a] < key[b];
+    });
+    if (limit && selected.size() > limit) selected.resize(limit);
+    return selected;
+}
+
+std::string RecoveredIndex::toJson(const Entry& entry) {
+    std::ostringstream oss;
+    oss << "{\"name\": \"" << Utils::jsonEscape(entry.filename) << "\""
+        << ", \"type\": \"" << Utils::jsonEscape(entry.type) << "\""
+        << ", \"offset\": " << entry.offset
+        << ", \"size\": " << entry.size
+        << ", \"sha256\": \"" << entry.sha256 << "\""
+        << ", \"date\": " << entry.date
+        << ", \"gps\": " << (entry.gps ? "true" : "false")
+        << ", \"author\": \"" << Utils::jsonEscape(entry.author) << "\""
+        << ", \"make\": \"" << Utils::jsonEscape(entry.make) << "\""
+        << ", \"model\": \"" << Utils::jsonEscape(entry.model) << "\""
+        << ", \"title\": \"" << Utils::jsonEscape(entry.title) << "\"}";
+    return oss.str();
+}
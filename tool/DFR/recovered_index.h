@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+#include "sha256.h"
+#include "metadata_extractor.h"
+
+// فهرس الملفات المستعادة في مجلد الإخراج (recovered.idx): عمود لكل حقل بدل سجل لكل ملف،
+// فالتصفية على النوع أو السنة أو وجود GPS تمر على مصفوفة أعداد متتالية، والنصوص المتكررة
+// (النوع، المؤلف، الكاميرا) تُخزن مرة في قاموس ويشير إليها كل صف برقم.
+// الملف ثنائي يُكتب إلى ملف مؤقت ثم يُعاد تسميته، والأعمدة غير المعروفة تُتخطى عند التحميل.
+class RecoveredIndex {
+public:
+    // ما يُقرأ من بداية كل ملف لاستخراج بياناته الوصفية
+    static constexpr size_t kMetadataHead = 256 * 1024;
+
+    // صف واحد بصيغة مقروءة (للإضافة والعرض)
+    struct Entry {
+        std::string filename;
+        std::string type;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        std::string sha256;         // hex، فارغ إن لم تُحسب البصمة
+        int64_t date = 0;           // YYYYMMDDhhmmss (0 = غير معروف)
+        bool gps = false;
+        std::string author;
+        std::string make;
+        std::string model;
+        std::string title;
+    };
+
+    // شرط تصفية: FIELD OP VALUE، أو FIELD وحده (صحيح/غير فارغ)
+    struct Filter {
+        std::string field;
+        std::string op;             // = != < <= > >= ~ (يحتوي، بلا حساسية لحالة الأحرف) أو فارغ
+        std::string value;
+    };
+
+    // تعبئة حقول الوصف من مستخرج البيانات الوصفية
+    static void applyMetadata(Entry& entry, const MetadataExtractor::Metadata& metadata);
+
+    // "2023:05:01 10:20:30" أو "20230501102030" أو "2023-05" إلى YYYYMMDDhhmmss
+    static int64_t parseDate(const std::string& text);
+
+    // إضافة صف (الاسم الموجود يُستبدل صفه)؛ آمنة من عدة خيوط
+    void add(const Entry& entry);
+
+    size_t size() const;
+
+    // الصف المسجل بهذا الاسم إن وُجد
+    bool find(const std::string& filename, Entry& entry) const;
+
+    Entry row(size_t index) const;
+
+    bool save(const std::string& path) const;
+
+    // تحميل فهرس محفوظ (يرمي std::runtime_error إن كان تالفًا)
+    bool load(const std::string& path);
+
+    // تحليل "type=jpg" أو "year>=2023" أو "gps" (يرمي std::invalid_argument)
+    static Filter parseFilter(const std::string& expression);
+
+    // الصفوف المطابقة لكل الشروط مرتبة حسب sortField (فارغ = الموقع على القرص) ومقصوصة على limit (0 = الكل)
+    std::vector<size_t> select(const std::vector<Filter>& filters, const std::string& sortField = "",
+                               bool descending = false, size_t limit = 0) const;
+
+    // الحقول المتاحة للتصفية والترتيب
+    static const std::vector<std::string>& fields();
+
+    static std::string toJson(const Entry& entry);
+
+private:
+    // عمود نصي بقاموس: الرقم 0 للنص الفارغ
+    struct DictColumn {
+        std::vector<std::string> values{""};
+        std::unordered_map<std::string, uint32_t> ids{{"", 0}};
+        std::vector<uint32_t> rows;
+
+        uint32_t intern(const std::string& value);
+    };
+
+    enum Flag : uint8_t {
+        kGps = 1,
+        kHashed = 2
+    };
+
+    mutable std::mutex mutex;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> sizes;
+    std::vector<int64_t> dates;
+    std::vector<uint8_t> flags;
+    std::vector<Sha256::Digest> hashes;
+    std::vector<std::string> names;
+    DictColumn types, authors, makes, models, titles;
+    mutable std::unordered_map<std::string, size_t> rowByName;     // تُبنى عند الحاجة (indexNamesLocked)
+
+    Entry rowLocked(size_t index) const;
+    void indexNamesLocked() const;
+    void clearLocked(size_t rows);
+    void loadColumns(std::string_view data, size_t pos, size_t rows, uint32_t columns);
+    DictColumn* dictColumn(const std::string& field);
+    const DictColumn* dictColumn(const std::string& field) const;
+    void filterRows(const Filter& filter, std::vector<uint8_t>& keep) const;
+};
@@ -0,0 +1,911 @@
+#include "recovery_job.h"
+#include "logger.h"
+#include "utils.h"
+#include "scan_stats.h"
+#include "file_rebuilder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+std::string RecoveryJob::Summary::toJson() const {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\"success\": " << (success ? "true" : "false")
+         << ", \"error\": \"" << Utils::jsonEscape(error) << "\""
+         << ", \"device\": \"" << Utils::jsonEscape(devicePath) << "\""
+         << ", \"output_dir\": \"" << Utils::jsonEscape(outputDir) << "\""
+         << ", \"extents\": [";
+    for (size_t i = 0; i < extents.size(); ++i) {
+        json << (i ? ", " : "") << "{\"start\": " << extents[i].start << ", \"length\": " << extents[i].length;
+        if (i < extentHits.size()) json << ", \"hits\": " << extentHits[i];
+        if (!extents[i].label.empty()) json << ", \"label\": \"" << Utils::jsonEscape(extents[i].label) << "\"";
+        json << "}";
+    }
+    json << "]";
+    if (!layout.partitions.empty() || layout.scheme != PartitionTable::Scheme::NONE) {
+        json << ", \"partition_table\": " << PartitionTable::toJson(layout);
+    }
+    json
+         << ", \"bytes_scanned\": " << bytesScanned
+         << ", \"hits\": " << hits
+         << ", \"files_recovered\": " << filesRecovered
+         << ", \"bytes_recovered\": " << bytesRecovered
+         << ", \"read_errors\": " << readErrors
+         << ", \"write_errors\": " << writeErrors
+         << ", \"unreadable_bytes\": " << unreadableBytes
+         << ", \"bytes_recovered_on_retry\": " << bytesRecoveredOnRetry
+         << ", \"bad_block_map\": \"" << Utils::jsonEscape(badBlockMapPath) << "\""
+         << ", \"bytes_resumed\": " << bytesResumed
+         << ", \"files_resumed\": " << filesResumed
+         << ", \"interrupted\": " << (interrupted ? "true" : "false")
+         << ", \"checkpoint\": \"" << Utils::jsonEscape(checkpointPath) << "\""
+         << ", \"image\": \"" << Utils::jsonEscape(imagePath) << "\""
+         << ", \"bytes_imaged\": " << bytesImaged
+         << ", \"hit_index\": \"" << Utils::jsonEscape(indexPath) << "\""
+         << ", \"bytes_from_index\": " << bytesFromIndex
+         << ", \"carve_reads\": " << carveReads
+         << ", \"hits_rejected\": " << hitsRejected
+         << ", \"hits_contained\": " << hitsContained
+         << ", \"bytes_skipped\": " << bytesSkipped
+         << ", \"bytes_high_entropy\": " << bytesHighEntropy
+         << ", \"usage_map\": \"" << Utils::jsonEscape(usageMapPath) << "\""
+         << ", \"recovered_index\": \"" << Utils::jsonEscape(recoveredIndexPath) << "\""
+         << ", \"reports\": [";
+    for (size_t i = 0; i < reportPaths.size(); ++i) {
+        json << (i ? ", " : "") << "\"" << Utils::jsonEscape(reportPaths[i]) << "\"";
+    }
+    json << "]"
+         << ", \"elapsed_seconds\": " << elapsedSeconds
+         << ", \"files_per_type\": {";
+    bool first = true;
+    for (const auto& [extension, count] : filesPerType) {
+        json << (first ? "" : ", ") << "\"" << Utils::jsonEscape(extension) << "\": " << count;
+        first = false;
+    }
+    json << "}}";
+    return json.str();
+}
+
+std::atomic<bool> RecoveryJob::stopFlag{false};
+
+RecoveryJob::RecoveryJob(const Options& options)
+    : options(options) {}
+
+RecoveryJob::Summary RecoveryJob::run(OutputManager& output) {
+    auto jobStart = std::chrono::steady_clock::now();
+    Summary summary;
+    summary.devicePath = options.devicePath;
+    summary.outputDir = options.outputDir;
+    stopFlag.store(false, std::memory_order_relaxed);
+
+    ScanStats& stats = ScanStats::getInstance();
+    DiskReader reader(options.devicePath);
+
+    // مطابقة المقاطع المطلوبة مع حجم القرص؛ إن تعذر معرفة الحجم يجب أن تكون كل المقاطع محددة الطول
+    uint64_t diskSize = reader.detectDiskSize() ? reader.getDiskInfo().totalSize : 0;
+    if (diskSize == 0) {
+        bool bounded = !options.extents.empty();
+        for (const auto& extent : options.extents) {
+            bounded = bounded && extent.length != 0;
+            diskSize = std::max(diskSize, extent.end());
+        }
+        if (!bounded) {
+            summary.error = "Cannot determine size of " + options.devicePath + "; pass explicit extents";
+            return summary;
+        }
+    }
+
+    // مع جدول الأقسام: كل قسم وكل فجوة مقطع مستقل، مقاطعةً مع ما طلبه المستخدم
+    std::vector<ScanExtent> requested = options.extents;
+    if (options.usePartitionTable) {
+        summary.layout = PartitionTable::read(reader, diskSize);
+        std::vector<ScanExtent> regions = PartitionTable::toExtents(summary.layout, options.scanGaps);
+        if (regions.empty()) {
+            LOG_WARN("Job", "No partitions found, scanning requested extents as raw data");
+        } else {
+            requested = requested.empty() ? regions : PartitionTable::intersect(regions, requested);
+            if (requested.empty()) {
+                summary.error = "Requested extents do not overlap any partition or gap";
+                return summary;
+            }
+        }
+    }
+
+    summary.extents = ScanExtents::normalize(requested, diskSize);
+    if (summary.extents.empty()) {
+        summary.error = "All requested extents lie beyond the end of the device";
+        return summary;
+    }
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    LOG_INFO("Job", "Scanning ", options.devicePath, " (", ScanExtents::describe(summary.extents), ") with ",
+             threads, " threads, chunk ", Utils::formatFileSize(options.chunkSize));
+    if (options.numa) {
+        if (NumaTopology::available()) {
+            LOG_INFO("Job", "Workers pinned round-robin to ", NumaTopology::nodes().size(), " NUMA nodes");
+        } else {
+            LOG_INFO("Job", "NUMA placement requested but only one node is available");
+        }
+    }
+
+    SignatureAutomaton automaton = SignatureAutomaton::compile(options.fileTypes);
+    if (automaton.empty()) {
+        summary.error = "No known signatures match the selected file types";
+        return summary;
+    }
+    LOG_INFO("Job", "Scanner built for ", automaton.signatures().size(), " signatures (",
+             SignatureAutomaton::presetName(automaton.preset()), ")");
+
+    // فهرس الإصابات: يُمسح لكل توقيع ما لم يُغطَّ بعد فقط (الصورة تحتاج المقاطع كاملة)
+    HitIndex index(options.outputDir, options.devicePath, diskSize);
+    if (options.useIndex) index.load();
+    summary.indexPath = index.getPath();
+
+    std::vector<std::string> types;
+    std::vector<ScanExtent> scanPlan;
+    size_t pendingSignatures = 0;
+    for (const auto* signature : automaton.signatures()) {
+        auto gaps = options.imagePath.empty() ? index.uncovered(*signature, summary.extents) : summary.extents;
+        if (gaps.empty()) continue;
+        ++pendingSignatures;
+        types.push_back(signature->extension);
+        scanPlan.insert(scanPlan.end(), gaps.begin(), gaps.end());
+    }
+    std::sort(types.begin(), types.end());
+    types.erase(std::unique(types.begin(), types.end()), types.end());
+    if (!scanPlan.empty()) scanPlan = ScanExtents::normalize(scanPlan, diskSize);
+    summary.bytesFromIndex = ScanExtents::totalLength(summary.extents) - ScanExtents::totalLength(scanPlan);
+
+    // الماسح الكامل (بمطابقاته الجاهزة) إن لم يغطِّ الفهرس أي توقيع
+    SignatureAutomaton scanner = pendingSignatures == automaton.signatures().size()
+                                     ? automaton : SignatureAutomaton::compile(types);
+    if (scanPlan.empty()) {
+        LOG_INFO("Job", "All requested signatures and extents are already indexed, skipping the scan");
+    } else if (summary.bytesFromIndex || pendingSignatures < automaton.signatures().size()) {
+        LOG_INFO("Job", "Hit index covers part of the job: scanning ", ScanExtents::describe(scanPlan), " for ",
+                 scanner.signatures().size(), " signatures");
+    }
+
+    // نقطة الاستئناف: تُعرَّف المهمة بالجهاز والأنواع والمقاطع الممسوحة وحجم القطعة
+    Checkpoint::Identity identity;
+    identity.devicePath = options.devicePath;
+    identity.deviceSize = diskSize;
+    for (const auto& type : types) identity.types += (identity.types.empty() ? "" : ",") + type;
+    identity.chunkSize = std::max<uint64_t>(options.chunkSize, 4096);
+    identity.extents = scanPlan;
+    identity.image = options.imagePath;
+
+    Checkpoint checkpoint(options.outputDir + "/checkpoint.dfr", std::chrono::seconds(options.checkpointInterval));
+    summary.checkpointPath = checkpoint.getPath();
+    bool resumed = checkpoint.begin(identity, options.resume, scanner.signatures());
+
+    // خريطة القطاعات التالفة: تُحمَّل مع نقطة الاستئناف حتى تُعاد محاولتها في النهاية
+    std::string badBlockPath = options.outputDir + "/badblocks.map";
+    if (resumed) badBlocks.load(badBlockPath);
+    // خريطة الاستخدام تتراكم عبر التشغيلات (الاستئناف والمسح التزايدي)
+    std::string usagePath = options.outputDir + "/usage.map";
+    if (options.prefilter) usage.load(usagePath);
+    // فهرس الملفات المستعادة يتراكم كذلك؛ التالف يُعاد بناؤه من هذا التشغيل
+    std::string recoveredPath = options.outputDir + "/recovered.idx";
+    try {
+        recoveredIndex.load(recoveredPath);
+    } catch (const std::exception& e) {
+        LOG_WARN("Job", "Ignoring damaged recovered index ", e.what());
+    }
+
+    auto saveBadBlocks = [&]() {
+        summary.unreadableBytes = badBlocks.totalBytes();
+        if (!badBlocks.empty() || Utils::fileExists(badBlockPath)) {
+            badBlocks.save(badBlockPath, options.devicePath);
+            summary.badBlockMapPath = badBlockPath;
+        }
+    };
+
+    // الصورة تُكتب من القطع المقروءة نفسها؛ مع الاستئناف تُتابَع الصورة السابقة
+    if (!options.imagePath.empty()) {
+        ImageWriter::Options imageOptions;
+        imageOptions.path = options.imagePath;
+        imageOptions.devicePath = options.devicePath;
+        imageOptions.deviceSize = diskSize;
+        imageOptions.compress = options.compressImage;
+        imageOptions.append = resumed;
+        image = std::make_unique<ImageWriter>(imageOptions);
+        std::string error;
+        if (!image->open(error)) {
+            summary.error = "Cannot write image: " + error;
+            return summary;
+        }
+        summary.imagePath = options.imagePath;
+    }
+
+    // التقارير تُكتب من جديد في كل تشغيل؛ ملفات التشغيلات السابقة تظهر فيها كسجلات resumed
+    for (ReportWriter::Format format : options.reports) {
+        std::string path = options.outputDir + "/report." + ReportWriter::extension(format);
+        auto writer = std::make_unique<ReportWriter>(path, format, options.devicePath);
+        std::string error;
+        if (!writer->open(error)) {
+            summary.error = "Cannot write report: " + error;
+            return summary;
+        }
+        reports.push_back(std::move(writer));
+    }
+
+    std::vector<Hit> hits = scanExtents(reader, scanner, scanPlan, threads, checkpoint, summary);
+    if (!stopRequested()) retryBadBlocks(reader, scanner, scanPlan, hits, checkpoint, summary);
+    saveBadBlocks();
+    if (!usage.empty() && usage.save(usagePath, options.devicePath)) {
+        summary.usageMapPath = usagePath;
+        summary.bytesHighEntropy = usage.totalBytes(BlockClassifier::Kind::HIGH_ENTROPY);
+        LOG_INFO("Job", "Prefilter skipped ", Utils::formatFileSize(summary.bytesSkipped), " of uniform blocks, ",
+                 Utils::formatFileSize(summary.bytesHighEntropy), " high-entropy; usage map in ", usagePath);
+    }
+    if (image) {
+        bool imageOk = image->finish() && !imageFailed;
+        summary.bytesImaged = image->bytesWritten();
+        if (!imageOk) {
+            checkpoint.save();
+            summary.error = "Writing image " + options.imagePath + " failed";
+            return summary;
+        }
+    }
+    if (stopRequested()) {
+        checkpoint.save();
+        summary.interrupted = true;
+        summary.error = "Interrupted during scan; run the same job again to resume";
+        return summary;
+    }
+
+    // الاستعادة تُقاد من الفهرس: إصابات هذا المسح مع ما سبق فهرسته
+    if (!scanPlan.empty() && !index.commit(hits, scanner.signatures(), scanPlan)) {
+        LOG_WARN("Job", "Hit index not updated, carving only hits from this scan");
+    } else {
+        hits = index.hits(automaton.signatures(), summary.extents);
+    }
+    summary.hits = hits.size();
+
+    // توزيع الإصابات على المقاطع (كلاهما مرتب حسب الموقع)
+    summary.extentHits.assign(summary.extents.size(), 0);
+    for (size_t e = 0, h = 0; e < summary.extents.size(); ++e) {
+        while (h < hits.size() && hits[h].offset < summary.extents[e].start) ++h;
+        while (h < hits.size() && hits[h].offset < summary.extents[e].end()) {
+            ++summary.extentHits[e];
+            ++h;
+        }
+    }
+    LOG_INFO("Job", "Found ", hits.size(), " signature hits");
+
+    // صورة تغطي الجهاز كاملًا تكفي للاستعادة دون لمس المصدر مرة أخرى
+    std::unique_ptr<DiskReader> imageReader;
+    if (image && scanPlan.size() == 1 && scanPlan[0].start == 0 && scanPlan[0].length == diskSize) {
+        LOG_INFO("Job", "Carving from image ", options.imagePath, " instead of the source device");
+        imageReader = std::make_unique<DiskReader>(options.imagePath);
+    }
+
+    FileRebuilder::continueNumberingAfter(checkpoint.highestFileNumber());
+    carveHits(imageReader ? *imageReader : reader, hits, diskSize, threads, checkpoint, output, summary);
+    checkpoint.save();
+    for (auto& writer : reports) {
+        if (writer->close()) {
+            summary.reportPaths.push_back(writer->getPath());
+        } else {
+            LOG_WARN("Job", "Writing report ", writer->getPath(), " failed");
+        }
+    }
+    if (recoveredIndex.size()) {
+        if (recoveredIndex.save(recoveredPath)) {
+            summary.recoveredIndexPath = recoveredPath;
+        } else {
+            LOG_WARN("Job", "Cannot write recovered index ", recoveredPath);
+        }
+    }
+    saveBadBlocks();
+    summary.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - jobStart).count();
+    if (stopRequested()) {
+        summary.interrupted = true;
+        summary.error = "Interrupted during carving; run the same job again to resume";
+        return summary;
+    }
+    stats.setPhase(ScanStats::Phase::DONE, 0);
+
+    summary.success = true;
+    return summary;
+}
+
+std::vector<RecoveryJob::Hit> RecoveryJob::scanExtents(DiskReader& reader, const SignatureAutomaton& automaton,
+                                                       const std::vector<ScanExtent>& extents, unsigned threads,
+                                                       Checkpoint& checkpoint, Summary& summary) {
+    // تداخل بين القطع حتى لا يضيع توقيع يقع على الحد
+    size_t overlap = automaton.maxPatternLength() - 1;
+
+    uint64_t chunkSize = std::max<uint64_t>(options.chunkSize, 4096);
+    std::vector<Chunk> chunks;
+    for (const auto& extent : extents) {
+        for (uint64_t pos = extent.start; pos < extent.end(); pos += chunkSize) {
+            chunks.push_back({pos, std::min(chunkSize, extent.end() - pos), extent.end()});
+        }
+    }
+    uint64_t chunkCount = chunks.size();
+    threads = static_cast<unsigned>(std::max<uint64_t>(1, std::min<uint64_t>(threads, chunkCount)));
+
+    ScanStats& stats = ScanStats::getInstance();
+    stats.setPhase(ScanStats::Phase::SCAN, ScanExtents::totalLength(extents));
+
+    // كتلة موحدة تُتخطى ما لم يكن أحد التوقيعات المطلوبة مكونًا من بايتها فقط
+    std::array<bool, 256> skippableFill;
+    skippableFill.fill(true);
+    for (size_t fill = 0; fill < 256; ++fill) {
+        std::vector<uint8_t> block(automaton.maxPatternLength(), static_cast<uint8_t>(fill));
+        for (const auto* sig : automaton.signatures()) {
+            if (SignatureScanner::matchesAt(*sig, block.data(), block.size())) skippableFill[fill] = false;
+        }
+    }
+
+    // القطع الممسوحة في تشغيل سابق (الترقيم نفسه في نقطة الاستئناف)
+    for (uint64_t index = 0; index < chunkCount; ++index) {
+        if (checkpoint.isChunkDone(index)) summary.bytesResumed += chunks[index].length;
+    }
+    if (summary.bytesResumed) {
+        LOG_INFO("Job", "Resuming scan: ", Utils::formatFileSize(summary.bytesResumed), " already scanned");
+        stats.advance(summary.bytesResumed);
+    }
+
+    std::atomic<uint64_t> nextChunk{0};
+    std::atomic<uint64_t> bytesScanned{0};
+    std::atomic<uint64_t> readErrors{0};
+    std::atomic<uint64_t> bytesSkipped{0};
+    std::atomic<uint64_t> rejected{0};
+    bool anyValidator = std::any_of(automaton.signatures().begin(), automaton.signatures().end(),
+                                    [](const SignatureScanner::FileSignature* sig) { return !sig->validator.empty(); });
+
+    // مناطق المصنف مؤقتة لكل قطعة: تُحجز من ساحة العامل وتُهمل كلها دفعة واحدة بين القطع
+    size_t runsPerChunk = options.chunkSize / BlockClassifier::kBlockSize + 2;
+
+    std::once_flag reportPages;
+    auto worker = [&](unsigned id) {
+        IoBuffer buffer(options.hugePages, placeWorker(id));
+        std::vector<Hit> local;
+        WorkerArena arena(runsPerChunk * sizeof(BlockClassifier::Run) + 4096);
+        for (uint64_t index = nextChunk.fetch_add(1); index < chunkCount; index = nextChunk.fetch_add(1)) {
+            if (stopRequested()) break;
+            if (checkpoint.isChunkDone(index)) continue;
+
+            uint64_t chunkStart = chunks[index].start;
+            uint64_t chunkLen = chunks[index].length;
+            uint64_t readLen = std::min<uint64_t>(chunkLen + overlap, chunks[index].extentEnd - chunkStart);
+
+            buffer.resize(readLen);
+            std::call_once(reportPages, [&] {
+                if (options.hugePages) LOG_INFO("Job", "Scan buffers use ", IoBuffer::pagesName(buffer.pages()));
+            });
+            try {
+                uint64_t unreadable = readRegion(reader, chunkStart, buffer.data(), readLen);
+                if (unreadable) {
+                    readErrors.fetch_add(1, std::memory_order_relaxed);
+                    LOG_WARN("Job", "Chunk at ", chunkStart, " has ", unreadable, " unreadable bytes, zero-filled");
+                }
+                teeToImage(chunkStart, buffer.data(), chunkLen);
+            } catch (const std::exception& e) {
+                readErrors.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARN("Job", "Skipping unreadable chunk at ", chunkStart, ": ", e.what());
+                stats.advance(chunkLen);
+                continue;
+            }
+
+            // الإصابات في منطقة التداخل يتكفل بها الجزء التالي
+            local.clear();
+            if (options.prefilter) {
+                std::pmr::vector<BlockClassifier::Run> runs(arena.reset());
+                runs.reserve(runsPerChunk);
+                BlockClassifier::classifyRegion(buffer.data(), chunkLen, chunkStart, runs);
+                bytesSkipped.fetch_add(scanBlocks(automaton, buffer.data(), readLen, chunkLen, chunkStart, runs,
+                                                  skippableFill, local),
+                                       std::memory_order_relaxed);
+                usage.add(runs);
+            } else {
+                automaton.scan(buffer.data(), readLen, chunkLen, chunkStart, local);
+            }
+            if (anyValidator) {
+                rejected.fetch_add(dropInvalidHits(buffer.data(), buffer.size(), chunkStart, local),
+                                   std::memory_order_relaxed);
+            }
+            bytesScanned.fetch_add(chunkLen, std::memory_order_relaxed);
+
+            checkpoint.completeChunk(index, local);
+            checkpoint.maybeSave();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; ++i) pool.emplace_back(worker, i);
+    for (auto& t : pool) t.join();
+
+    summary.bytesScanned = bytesScanned.load();
+    summary.bytesSkipped = bytesSkipped.load();
+    summary.hitsRejected += rejected.load();
+    summary.readErrors += readErrors.load();
+    return checkpoint.completedHits();
+}
+
+size_t RecoveryJob::dropInvalidHits(const uint8_t* buffer, size_t size, uint64_t bufferOffset, std::vector<Hit>& hits) {
+    // إطارات MPEG وأمثالها تحتاج بضعة كيلوبايتات؛ الإصابة قرب نهاية القطعة تُدقق عند الاستعادة
+    const size_t kValidateBytes = 8 * 1024;
+
+    size_t kept = 0;
+    for (const auto& hit : hits) {
+        size_t pos = static_cast<size_t>(hit.offset - bufferOffset);
+        size_t available = size - pos;
+        if (!hit.signature->validator.empty() && available >= kValidateBytes &&
+            !FileRebuilder::validate(*hit.signature, buffer + pos, available)) {
+            continue;
+        }
+        hits[kept++] = hit;
+    }
+    size_t dropped = hits.size() - kept;
+    hits.resize(kept);
+    return dropped;
+}
+
+uint64_t RecoveryJob::scanBlocks(const SignatureAutomaton& automaton, const uint8_t* data, size_t size, size_t limit,
+                                 uint64_t baseOffset, const std::pmr::vector<BlockClassifier::Run>& runs,
+                                 const std::array<bool, 256>& skippableFill, std::vector<Hit>& hits) {
+    size_t lookback = automaton.maxPatternLength() ? automaton.maxPatternLength() - 1 : 0;
+    uint64_t skipped = 0;
+    size_t scannedEnd = 0;      // ما قبله أُبلغ عن إصاباته
+
+    // مسح [start, end) مع بدء المسح قبله بطول أطول نمط والقراءة بعده بالقدر نفسه
+    auto scanSpan = [&](size_t start, size_t end) {
+        size_t from = std::max(scannedEnd, start > lookback ? start - lookback : 0);
+        size_t to = std::min(size, end + lookback);
+        if (end > from) automaton.scan(data + from, to - from, end - from, baseOffset + from, hits);
+        scannedEnd = end;
+    };
+
+    size_t spanStart = 0;
+    bool inSpan = false;
+    for (const auto& run : runs) {
+        size_t start = static_cast<size_t>(run.offset - baseOffset);
+        bool skip = (run.kind == BlockClassifier::Kind::ZERO || run.kind == BlockClassifier::Kind::UNIFORM) &&
+                    skippableFill[run.fill];
+        if (!skip) {
+            if (!inSpan) spanStart = start;
+            inSpan = true;
+            continue;
+        }
+        if (inSpan) scanSpan(spanStart, start);
+        inSpan = false;
+        skipped += run.length;
+    }
+    if (inSpan) {
+        scanSpan(spanStart, limit);
+    } else if (size > limit) {
+        // توقيع يبدأ في آخر كتلة متخطاة ويمتد إلى القطعة التالية
+        scanSpan(limit, limit);
+    }
+    return skipped;
+}
+
+void RecoveryJob::report(const ReportWriter::Record& record) {
+    for (auto& writer : reports) writer->write(record);
+}
+
+void RecoveryJob::teeToImage(uint64_t offset, const uint8_t* data, size_t size) {
+    if (!image || imageFailed) return;
+    if (!image->write(offset, data, size)) {
+        // صورة ناقصة بلا تنبيه أسوأ من إيقاف المهمة
+        imageFailed = true;
+        requestStop();
+    }
+}
+
+int RecoveryJob::placeWorker(unsigned worker) const {
+    if (!options.numa) return -1;
+    int node = NumaTopology::nodeForWorker(worker);
+    if (node >= 0) NumaTopology::pinCurrentThread(node);
+    return node;
+}
+
+uint64_t RecoveryJob::readRegion(DiskReader& reader, uint64_t offset, uint8_t* buffer, size_t size) {
+    if (!options.tolerateBadSectors) {
+        reader.readInto(offset, buffer, size);
+        return 0;
+    }
+    return reader.readTolerant(offset, buffer, size, badBlocks);
+}
+
+void RecoveryJob::retryBadBlocks(DiskReader& reader, const SignatureAutomaton& automaton,
+                                 const std::vector<ScanExtent>& extents, std::vector<Hit>& hits,
+                                 Checkpoint& checkpoint, Summary& summary) {
+    if (!options.tolerateBadSectors || options.badSectorRetries == 0 || badBlocks.empty()) return;
+
+    ScanStats& stats = ScanStats::getInstance();
+    size_t overlap = automaton.maxPatternLength() - 1;
+    uint64_t pieceSize = std::max<uint64_t>(options.chunkSize, 4096);
+
+    std::set<std::pair<uint64_t, const SignatureScanner::FileSignature*>> known;
+    for (const auto& hit : hits) known.insert({hit.offset, hit.signature});
+
+    DiskReader::RawData buffer;
+    std::vector<Hit> found;
+    for (unsigned pass = 1; pass <= options.badSectorRetries && !badBlocks.empty(); ++pass) {
+        auto ranges = badBlocks.ranges();
+        uint64_t before = badBlocks.totalBytes();
+        stats.setPhase(ScanStats::Phase::READ, before);
+        LOG_INFO("Job", "Retry pass ", pass, ": ", ranges.size(), " bad areas, ", Utils::formatFileSize(before));
+
+        for (const auto& [start, length] : ranges) {
+            for (uint64_t pos = start; pos < start + length && !stopRequested(); pos += pieceSize) {
+                uint64_t len = std::min(pieceSize, start + length - pos);
+                buffer.resize(static_cast<size_t>(len));
+                badBlocks.remove(pos, len);
+                uint64_t unreadable = reader.readTolerant(pos, buffer.data(), buffer.size(), badBlocks);
+                stats.advance(len);
+                if (unreadable == len) continue;
+                teeToImage(pos, buffer.data(), buffer.size());
+
+                // مسح ما حول المنطقة المستعادة داخل مقطعها بحثًا عن توقيعات كانت مغطاة بالأصفار
+                auto extent = std::find_if(extents.begin(), extents.end(),
+                                           [&](const ScanExtent& e) { return pos >= e.start && pos < e.end(); });
+                if (extent == extents.end()) continue;
+                uint64_t windowStart = std::max(extent->start, pos >= overlap ? pos - overlap : 0);
+                uint64_t windowEnd = std::min(extent->end(), pos + len + overlap);
+                buffer.resize(static_cast<size_t>(windowEnd - windowStart));
+                reader.readTolerant(windowStart, buffer.data(), buffer.size(), badBlocks);
+
+                found.clear();
+                automaton.scan(buffer.data(), buffer.size(), buffer.size(), windowStart, found);
+                std::vector<Hit> fresh;
+                for (const auto& hit : found) {
+                    if (hit.offset >= pos + len || !known.insert({hit.offset, hit.signature}).second) continue;
+                    fresh.push_back(hit);
+                }
+                checkpoint.addHits(fresh);
+                hits.insert(hits.end(), fresh.begin(), fresh.end());
+            }
+        }
+
+        uint64_t after = badBlocks.totalBytes();
+        summary.bytesRecoveredOnRetry += before > after ? before - after : 0;
+        if (after == before) break;
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) { return a.offset < b.offset; });
+    LOG_INFO("Job", "Bad areas after retry: ", Utils::formatFileSize(badBlocks.totalBytes()),
+             " (", Utils::formatFileSize(summary.bytesRecoveredOnRetry), " recovered)");
+}
+
+void RecoveryJob::carveHits(DiskReader& reader, const std::vector<Hit>& hits, uint64_t diskSize,
+                            unsigned threads, Checkpoint& checkpoint, OutputManager& output, Summary& summary) {
+    ScanStats& stats = ScanStats::getInstance();
+    stats.setPhase(ScanStats::Phase::CARVE, hits.size());
+    std::mutex outputMutex;
+
+    // سجل التقرير لإصابة، والباقي يُملأ حسب مصيرها
+    auto hitRecord = [](const Hit& hit, const char* status) {
+        ReportWriter::Record record;
+        record.status = status;
+        record.type = hit.signature->extension;
+        record.offset = hit.offset;
+        record.validation = hit.signature->validator.empty() ? "none" : "passed";
+        return record;
+    };
+
+    // الملفات المكتوبة في تشغيل سابق تُسجَّل دون قراءة، والباقي يُجدول حسب الموقع
+    std::vector<Hit> pending;
+    for (const auto& hit : hits) {
+        Checkpoint::CarvedRecord previous;
+        if (!checkpoint.findCarved(hit.offset, hit.signature->extension, previous)) {
+            pending.push_back(hit);
+            continue;
+        }
+        output.addRecoveredFile(previous.filename, hit.signature->extension, previous.size);
+        // فهرس مفقود أو تالف: الملف يبقى قابلًا للبحث بموقعه وحجمه دون إعادة قراءته
+        RecoveredIndex::Entry entry;
+        if (!recoveredIndex.find(previous.filename, entry)) {
+            entry.filename = previous.filename;
+            entry.type = hit.signature->extension;
+            entry.offset = hit.offset;
+            entry.size = previous.size;
+            recoveredIndex.add(entry);
+        }
+        if (!reports.empty()) {
+            ReportWriter::Record record = hitRecord(hit, "resumed");
+            record.length = previous.size;
+            record.filename = previous.filename;
+            record.sha256 = entry.sha256;
+            report(record);
+        }
+        summary.filesRecovered++;
+        summary.filesResumed++;
+        summary.bytesRecovered += previous.size;
+        summary.filesPerType[hit.signature->extension]++;
+        stats.advance(1);
+    }
+    CarveScheduler::sortByOffset(pending);
+
+    uint64_t maxBatch = std::max<uint64_t>(options.chunkSize, options.maxFileSize);
+    auto batches = CarveScheduler::plan(pending, options.maxFileSize, diskSize, maxBatch);
+    summary.carveReads = batches.size();
+    if (!pending.empty()) {
+        LOG_INFO("Job", "Carving ", pending.size(), " files with ", batches.size(), " coalesced reads");
+    }
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, batches.size())));
+
+    std::atomic<size_t> nextBatch{0};
+    std::atomic<uint64_t> readErrors{0};
+    std::atomic<uint64_t> writeErrors{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> contained{0};
+
+    // الاحتواء يُقرر بترتيب الدفعات: الدفعة تقيس ملفاتها بالتوازي مع غيرها، ثم تنتظر قرارات ما قبلها
+    // (فقد يمتد ملف من دفعة سابقة فوقها) قبل أن تقرر ما تكتبه
+    ContainmentIndex containers;
+    std::mutex containmentMutex;
+    std::condition_variable containmentReady;
+    size_t decidedBatches = 0;
+    ContainmentIndex::Policy policy = options.containment;
+
+    // كل إطار في تيار MPEG audio يطابق توقيع mp3: الإطارات داخل تيار قيس طوله جزء منه لا ملفات
+    // مستقلة مهما كانت سياسة الاحتواء. آخر تيار بترتيب القرص واسم ملفه (أو حاويته)
+    auto isFrame = [](const Hit& hit) { return hit.signature->validator == "mpeg-audio"; };
+    auto isStream = [&](const Hit& hit) { return isFrame(hit) || hit.signature->validator == "id3"; };
+    uint64_t streamEnd = 0;
+    std::string streamFile;
+    uint64_t streamStart = 0;
+
+    // هل تبدأ إصابة أخرى داخل (start, end) غير إطارات التيار نفسه؟
+    auto hasInnerHit = [&](const Hit& outer, uint64_t end) {
+        auto it = std::upper_bound(pending.begin(), pending.end(), outer.offset,
+                                   [](uint64_t value, const Hit& hit) { return value < hit.offset; });
+        for (; it != pending.end() && it->offset < end; ++it) {
+            if (!(isStream(outer) && isFrame(*it))) return true;
+        }
+        return false;
+    };
+
+    enum class Action { WRITE, SKIP, REFERENCE };
+    struct Planned {
+        size_t hit = 0;
+        FileRebuilder::Extent extent;
+        Action action = Action::WRITE;
+        std::string filename;               // اسم الملف، أو اسم الحاوية للمرجع
+        uint64_t containerOffset = 0;       // موقع المرجع داخل حاويته
+    };
+
+    auto worker = [&](unsigned id) {
+        IoBuffer buffer(options.hugePages, placeWorker(id));
+        // مخازن الاستعادة (ما يُقرأ خارج الدفعة، مؤشر JPEG) تُعاد إلى مجمع العامل بعد كل ملف فتُستخدم مجددًا،
+        // وخطة الدفعة من ساحة تُهمل بين الدفعات
+        std::pmr::unsynchronized_pool_resource pool(std::pmr::pool_options{0, FileRebuilder::kStreamBlock});
+        WorkerArena arena(64 * 1024, &pool);
+        std::vector<uint8_t> head;
+        for (size_t index = nextBatch.fetch_add(1); index < batches.size(); index = nextBatch.fetch_add(1)) {
+            if (stopRequested()) break;
+            stats.setQueueDepth(ScanStats::Queue::CARVE, batches.size() - index);
+            const CarveScheduler::Batch& batch = batches[index];
+            std::pmr::vector<Planned> planned(arena.reset());
+
+            buffer.resize(static_cast<size_t>(batch.length));
+            bool readable = true;
+            try {
+                if (readRegion(reader, batch.start, buffer.data(), buffer.size())) {
+                    readErrors.fetch_add(1, std::memory_order_relaxed);
+                }
+            } catch (const std::exception& e) {
+                readErrors.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARN("Job", "Cannot read carve range at ", batch.start, ": ", e.what());
+                stats.advance(batch.hitCount);
+                readable = false;
+            }
+
+            // كل ملف يبدأ عند توقيعه داخل المخزن المشترك، وما يتجاوزه يُقرأ من القرص بالتدفق
+            FileRebuilder::Source source;
+            source.read = [&](uint64_t offset, uint8_t* data, size_t size) { readRegion(reader, offset, data, size); };
+            source.size = diskSize;
+            source.cached = buffer.data();
+            source.cachedOffset = batch.start;
+            source.cachedSize = buffer.size();
+            source.memory = &pool;
+
+            // القياس: التحقق وحساب الطول دون كتابة. إطارات تيار قيس في هذه الدفعة لا تُقاس (كل منها
+            // يمتد حتى نهاية التيار)، وقرار الاحتواء يسقطها
+            uint64_t batchStreamEnd = 0;
+            for (size_t i = batch.firstHit; readable && i < batch.firstHit + batch.hitCount; ++i) {
+                const Hit& hit = pending[i];
+                if (isFrame(hit) && hit.offset < batchStreamEnd) {
+                    Planned plan;
+                    plan.hit = i;
+                    planned.push_back(plan);
+                    continue;
+                }
+                size_t start = static_cast<size_t>(hit.offset - batch.start);
+                if (!FileRebuilder::validate(*hit.signature, buffer.data() + start, buffer.size() - start)) {
+                    rejected.fetch_add(1, std::memory_order_relaxed);
+                    ReportWriter::Record record = hitRecord(hit, "rejected");
+                    record.validation = "failed";
+                    report(record);
+                    stats.advance(1);
+                    continue;
+                }
+                FileRebuilder::Limits limits;
+                limits.fallbackSize = CarveScheduler::windowFor(hit, options.maxFileSize);
+                limits.maxSize = options.maxCarveSize;
+                Planned plan;
+                plan.hit = i;
+                try {
+                    plan.extent = FileRebuilder::measure(source, hit.offset, *hit.signature, limits);
+                } catch (const std::exception& e) {
+                    readErrors.fetch_add(1, std::memory_order_relaxed);
+                    LOG_WARN("Job", "Cannot carve ", hit.signature->extension, " at ", hit.offset, ": ", e.what());
+                    report(hitRecord(hit, "failed"));
+                    stats.advance(1);
+                    continue;
+                }
+                if (isStream(hit) && plan.extent.exact) {
+                    batchStreamEnd = std::max(batchStreamEnd, hit.offset + plan.extent.size);
+                }
+                planned.push_back(plan);
+            }
+
+            // القرار بترتيب القرص
+            {
+                std::unique_lock<std::mutex> lock(containmentMutex);
+                while (decidedBatches != index && !stopRequested()) {
+                    containmentReady.wait_for(lock, std::chrono::milliseconds(100));
+                }
+                for (auto& plan : planned) {
+                    const Hit& hit = pending[plan.hit];
+                    uint64_t end = hit.offset + plan.extent.size;
+                    if (isFrame(hit) && hit.offset < streamEnd) {
+                        plan.action = Action::SKIP;
+                        plan.filename = streamFile;
+                        plan.containerOffset = hit.offset - streamStart;
+                        continue;
+                    }
+                    const ContainmentIndex::Range* duplicate = containers.duplicateOf(hit.offset, end);
+                    const ContainmentIndex::Range* container =
+                        policy == ContainmentIndex::Policy::INNER ? nullptr : containers.containerOf(hit.offset);
+                    if (duplicate) {
+                        // النطاق نفسه كُتب بتوقيع آخر يطابق البايتات نفسها
+                        plan.action = Action::SKIP;
+                        plan.filename = duplicate->filename;
+                        container = duplicate;
+                    } else if (container && policy == ContainmentIndex::Policy::OUTER) {
+                        plan.action = Action::SKIP;
+                        plan.filename = container->filename;
+                        plan.containerOffset = hit.offset - container->start;
+                    } else if (container && policy == ContainmentIndex::Policy::BOTH) {
+                        plan.action = Action::REFERENCE;
+                        plan.filename = container->filename;
+                        plan.containerOffset = hit.offset - container->start;
+                    } else if (policy == ContainmentIndex::Policy::INNER && plan.extent.exact &&
+                               hasInnerHit(hit, end)) {
+                        plan.action = Action::SKIP;
+                    } else {
+                        plan.filename = FileRebuilder::reserveFilename(hit.signature->extension);
+                        containers.add(hit.offset, end, plan.filename,
+                                       plan.extent.exact && policy != ContainmentIndex::Policy::INNER);
+                    }
+                    if (isStream(hit) && plan.extent.exact && end > streamEnd) {
+                        // تيار داخل حاوية: إطاراته تُنسب إلى الحاوية نفسها
+                        streamStart = plan.action == Action::WRITE ? hit.offset : hit.offset - plan.containerOffset;
+                        streamEnd = end;
+                        streamFile = plan.filename;
+                    }
+                    if (plan.action != Action::WRITE) {
+                        LOG_DEBUG("Job", hit.signature->extension, " at ", hit.offset, " overlaps a ",
+                                  container ? "container" : "file with hits inside", ", ",
+                                  plan.action == Action::SKIP ? "skipped" : "referenced");
+                    }
+                }
+                decidedBatches = std::max(decidedBatches, index + 1);
+            }
+            containmentReady.notify_all();
+
+            for (const auto& plan : planned) {
+                const Hit& hit = pending[plan.hit];
+                if (plan.action != Action::WRITE) {
+                    contained.fetch_add(1, std::memory_order_relaxed);
+                    if (plan.action == Action::REFERENCE) {
+                        std::lock_guard<std::mutex> lock(outputMutex);
+                        output.addContainedFile(hit.signature->extension, plan.extent.size, plan.filename,
+                                                plan.containerOffset);
+                    }
+                    // SKIP بلا حاوية: ملف خارجي تُرك لما بداخله (INNER)
+                    ReportWriter::Record record = hitRecord(hit, plan.action == Action::REFERENCE ? "referenced"
+                                                                 : plan.filename.empty()           ? "skipped"
+                                                                                                   : "contained");
+                    record.length = plan.extent.size;
+                    record.exactLength = plan.extent.exact;
+                    record.container = plan.filename;
+                    record.containerOffset = plan.containerOffset;
+                    report(record);
+                    stats.advance(1);
+                    continue;
+                }
+                FileRebuilder::RecoveredFile recovered;
+                try {
+                    recovered = FileRebuilder::writeFile(source, hit.offset, plan.extent, *hit.signature,
+                                                         options.outputDir, plan.filename, options.hashFiles);
+                } catch (const std::exception& e) {
+                    readErrors.fetch_add(1, std::memory_order_relaxed);
+                    LOG_WARN("Job", "Cannot carve ", hit.signature->extension, " at ", hit.offset, ": ", e.what());
+                    ReportWriter::Record record = hitRecord(hit, "failed");
+                    record.length = plan.extent.size;
+                    record.exactLength = plan.extent.exact;
+                    report(record);
+                    stats.advance(1);
+                    continue;
+                }
+                if (!recovered.success) {
+                    // لا نقطة استئناف ولا فهرس: التشغيل التالي يحاول كتابته مجددًا
+                    writeErrors.fetch_add(1, std::memory_order_relaxed);
+                    ReportWriter::Record record = hitRecord(hit, "failed");
+                    record.length = plan.extent.size;
+                    record.exactLength = plan.extent.exact;
+                    report(record);
+                    stats.advance(1);
+                    continue;
+                }
+                size_t size = recovered.endOffset - recovered.startOffset;
+                checkpoint.recordCarve(hit.offset, hit.signature->extension, {recovered.filename, size});
+
+                // البيانات الوصفية في رأس الملف، ويُقرأ من المخزن المشترك غالبًا
+                RecoveredIndex::Entry entry;
+                entry.filename = recovered.filename;
+                entry.type = recovered.extension;
+                entry.offset = hit.offset;
+                entry.size = size;
+                entry.sha256 = recovered.sha256;
+                auto metadataStart = std::chrono::steady_clock::now();
+                head.resize(std::min<size_t>(size, RecoveredIndex::kMetadataHead));
+                head.resize(FileRebuilder::readAt(source, hit.offset, head.data(), head.size()));
+                MetadataExtractor::Metadata metadata = MetadataExtractor::extract(head, recovered.extension);
+                stats.recordMetadata(head.size(), std::chrono::steady_clock::now() - metadataStart);
+                RecoveredIndex::applyMetadata(entry, metadata);
+                recoveredIndex.add(entry);
+                if (!reports.empty()) {
+                    ReportWriter::Record record = hitRecord(hit, "carved");
+                    record.length = size;
+                    record.filename = recovered.filename;
+                    record.sha256 = recovered.sha256;
+                    record.exactLength = recovered.exactSize;
+                    record.metadata.insert(metadata.values.begin(), metadata.values.end());
+                    report(record);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    output.addRecoveredFile(recovered.filename, recovered.extension, size);
+                    summary.filesRecovered++;
+                    summary.bytesRecovered += size;
+                    summary.filesPerType[recovered.extension]++;
+                }
+                stats.advance(1);
+            }
+            checkpoint.maybeSave();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; ++i) pool.emplace_back(worker, i);
+    for (auto& t : pool) t.join();
+
+    stats.setQueueDepth(ScanStats::Queue::CARVE, 0);
+    summary.readErrors += readErrors.load();
+    summary.writeErrors += writeErrors.load();
+    if (summary.writeErrors) LOG_WARN("Job", summary.writeErrors, " files could not be written to ", options.outputDir);
+    summary.hitsRejected += rejected.load();
+    summary.hitsContained += contained.load();
+    if (summary.hitsContained) {
+        LOG_INFO("Job", summary.hitsContained, " hits overlapped other recovered files (policy ",
+                 ContainmentIndex::policyName(policy), ")");
+    }
+    if (summary.hitsRejected) LOG_INFO("Job", "Validators rejected ", summary.hitsRejected, " hits");
+}
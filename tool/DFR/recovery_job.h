@@ -0,0 +1,168 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "disk_reader.h"
+#include "signature_automaton.h"
+#include "output_manager.h"
+#include "scan_extent.h"
+#include "partition_table.h"
+#include "checkpoint.h"
+#include "bad_block_map.h"
+#include "disk_image.h"
+#include "hit_index.h"
+#include "carve_scheduler.h"
+#include "block_classifier.h"
+#include "containment.h"
+#include "worker_arena.h"
+#include "io_buffer.h"
+#include "recovered_index.h"
+#include "report_writer.h"
+
+// مهمة مسح واستعادة كاملة بلا أي تفاعل: تستخدمها القائمة التفاعلية ووضع الدفعات
+class RecoveryJob {
+public:
+    struct Options {
+        std::string devicePath;
+        std::string outputDir = "./recovered";
+        std::vector<std::string> fileTypes;     // فارغة = كل الأنواع المعروفة
+        std::vector<ScanExtent> extents;        // فارغة = القرص كاملًا
+        bool usePartitionTable = false;         // مسح الأقسام (والفجوات) حسب جدول الأقسام
+        bool scanGaps = true;                   // مسح المناطق غير المقسمة كبيانات خام
+        unsigned threads = 0;                   // 0 = عدد أنوية المعالج
+        size_t chunkSize = 64 * 1024 * 1024;
+        size_t maxFileSize = 10 * 1024 * 1024;  // حين لا يُعرف حجم الملف من رأسه ولا نهايته
+        uint64_t maxCarveSize = 16ULL << 30;    // سقف الأحجام المعلنة في الرؤوس (الاستعادة متدفقة فلا تقيدها الذاكرة)
+        bool tolerateBadSectors = true;         // ملء القطاعات التالفة بأصفار بدل تخطي القطعة كاملة
+        unsigned badSectorRetries = 1;          // تمريرات إعادة قراءة المناطق التالفة بعد انتهاء المسح
+        std::string imagePath;                  // كتابة صورة للجهاز أثناء المسح (فارغ = بدون)
+        bool compressImage = false;             // صورة مضغوطة بـ zlib بدل الخام
+        bool useIndex = true;                   // مسح ما لم يغطه فهرس الإصابات فقط (false = إعادة بناء الفهرس)
+        bool resume = true;                     // استئناف نقطة الاستئناف في مجلد الإخراج إن طابقت المهمة
+        unsigned checkpointInterval = 30;       // ثوانٍ بين كل كتابة لنقطة الاستئناف
+        bool hugePages = false;                 // مخازن القراءة بصفحات 2MB (مع الرجوع للعادية)
+        bool numa = false;                      // تثبيت العمال على عقد NUMA ومخازنهم على ذاكرة عقدتهم
+        bool hashFiles = true;                  // بصمة SHA-256 لكل ملف مستعاد في الفهرس
+        std::vector<ReportWriter::Format> reports;  // تقارير آلية في <output>/report.<صيغة> أثناء الاستعادة
+        bool prefilter = true;                  // تخطي كتل الأصفار والبايت المتكرر وحفظ خريطة الاستخدام
+        ContainmentIndex::Policy containment = ContainmentIndex::Policy::OUTER;    // الملفات داخل ملفات أخرى
+    };
+
+    struct Summary {
+        bool success = false;
+        std::string error;
+        std::string devicePath;
+        std::string outputDir;
+        std::vector<ScanExtent> extents;        // المقاطع بعد التطبيع
+        std::vector<uint64_t> extentHits;       // عدد الإصابات في كل مقطع
+        PartitionTable::Layout layout;          // عند usePartitionTable فقط
+        uint64_t bytesScanned = 0;
+        uint64_t hits = 0;
+        uint64_t filesRecovered = 0;
+        uint64_t bytesRecovered = 0;
+        uint64_t readErrors = 0;                // قراءات فشلت كليًا أو احتوت قطاعات تالفة
+        uint64_t unreadableBytes = 0;           // ما بقي تالفًا بعد إعادة المحاولة
+        uint64_t bytesRecoveredOnRetry = 0;
+        uint64_t writeErrors = 0;               // ملفات تعذرت كتابتها (قرص الإخراج ممتلئ مثلًا)
+        std::string badBlockMapPath;
+        uint64_t bytesResumed = 0;              // بايتات مُسحت في تشغيل سابق
+        uint64_t filesResumed = 0;              // ملفات استُعيدت في تشغيل سابق
+        bool interrupted = false;               // توقفت المهمة بطلب (يمكن استئنافها)
+        std::string checkpointPath;
+        std::string imagePath;
+        uint64_t bytesImaged = 0;
+        std::string indexPath;
+        uint64_t bytesFromIndex = 0;            // بايتات مطلوبة أُخذت إصاباتها من الفهرس دون قراءة
+        uint64_t carveReads = 0;                // قراءات الاستعادة بعد دمج النوافذ
+        uint64_t hitsRejected = 0;              // إصابات رفضها مدقق نوعها (أثناء المسح أو الاستعادة)
+        uint64_t hitsContained = 0;             // ملفات لم تُكتب بسبب سياسة الاحتواء (أو سُجلت كمراجع)
+        uint64_t bytesSkipped = 0;              // كتل أصفار أو بايت متكرر لم يمررها المصنف إلى الماسح
+        uint64_t bytesHighEntropy = 0;          // كتل مضغوطة أو مشفرة حسب خريطة الاستخدام
+        std::string usageMapPath;
+        std::string recoveredIndexPath;         // فهرس الملفات المستعادة وبياناتها الوصفية
+        std::vector<std::string> reportPaths;
+        double elapsedSeconds = 0.0;
+        std::map<std::string, uint64_t> filesPerType;
+
+        // تمثيل الملخص ككائن JSON في سطر واحد
+        std::string toJson() const;
+    };
+
+    explicit RecoveryJob(const Options& options);
+
+    // تشغيل المهمة كاملة: قراءة ومسح متوازيان لقطع المقاطع المطلوبة فقط ثم استعادة الإصابات
+    Summary run(OutputManager& output);
+
+    const Options& getOptions() const {
+        return options;
+    }
+
+    // طلب إيقاف المهام الجارية بأمان (آمن للاستدعاء من معالج الإشارات)
+    static void requestStop() {
+        stopFlag.store(true, std::memory_order_relaxed);
+    }
+
+    static bool stopRequested() {
+        return stopFlag.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Hit = SignatureAutomaton::Hit;
+
+    Options options;
+    BadBlockMap badBlocks;
+    UsageMap usage;
+    RecoveredIndex recoveredIndex;
+    std::vector<std::unique_ptr<ReportWriter>> reports;
+    std::unique_ptr<ImageWriter> image;
+    std::atomic<bool> imageFailed{false};
+    static std::atomic<bool> stopFlag;
+
+    // قطعة قراءة داخل مقطع؛ التداخل مع القطعة التالية لا يتجاوز نهاية المقطع
+    struct Chunk {
+        uint64_t start;
+        uint64_t length;
+        uint64_t extentEnd;
+    };
+
+    // تقسيم المقاطع إلى قطع موزعة بين الخيوط ومسحها بماسح يحتوي الأنواع المختارة فقط
+    // (القطع المنجزة في نقطة الاستئناف تُتخطى)
+    std::vector<Hit> scanExtents(DiskReader& reader, const SignatureAutomaton& automaton,
+                                 const std::vector<ScanExtent>& extents, unsigned threads,
+                                 Checkpoint& checkpoint, Summary& summary);
+
+    // مسح قطعة مصنفة: مجموعات الكتل الموحدة التي لا يتكون توقيع من بايتها تُتخطى، مع الإبقاء على
+    // التداخل حول حدودها حتى لا يضيع توقيع يبدأ في آخرها. تُرجع عدد البايتات المتخطاة
+    static uint64_t scanBlocks(const SignatureAutomaton& automaton, const uint8_t* data, size_t size, size_t limit,
+                               uint64_t baseOffset, const std::pmr::vector<BlockClassifier::Run>& runs,
+                               const std::array<bool, 256>& skippableFill, std::vector<Hit>& hits);
+
+    // حذف الإصابات التي يرفضها مدقق نوعها إن كان في المخزن ما يكفي للحكم عليها. تُرجع عدد المحذوف
+    static size_t dropInvalidHits(const uint8_t* buffer, size_t size, uint64_t bufferOffset, std::vector<Hit>& hits);
+
+    // عقدة العامل رقم worker مع تثبيت الخيط عليها (-1 بلا NUMA)
+    int placeWorker(unsigned worker) const;
+
+    // قراءة حسب الوضع: متسامحة (أصفار مكان القطاعات التالفة) أو صارمة (ترمي عند أول خطأ).
+    // تُرجع عدد البايتات غير المقروءة
+    uint64_t readRegion(DiskReader& reader, uint64_t offset, uint8_t* buffer, size_t size);
+
+    // سجل في كل تقرير مفتوح
+    void report(const ReportWriter::Record& record);
+
+    // نسخ ما قُرئ إلى الصورة إن طُلبت (يوقف المهمة عند فشل الكتابة)
+    void teeToImage(uint64_t offset, const uint8_t* data, size_t size);
+
+    // إعادة قراءة المناطق التالفة بعد انتهاء المسح، ومسح ما نجحت قراءته بحثًا عن إصابات جديدة
+    void retryBadBlocks(DiskReader& reader, const SignatureAutomaton& automaton, const std::vector<ScanExtent>& extents,
+                        std::vector<Hit>& hits, Checkpoint& checkpoint, Summary& summary);
+
+    // استعادة الإصابات بالتوازي بدفعات مرتبة حسب الموقع، كل دفعة قراءة واحدة تخدم عدة ملفات
+    void carveHits(DiskReader& reader, const std::vector<Hit>& hits, uint64_t diskSize,
+                   unsigned threads, Checkpoint& checkpoint, OutputManager& output, Summary& summary);
+};
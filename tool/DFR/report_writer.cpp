@@ -0,0 +1,226 @@
+#include "report_writer.h"
+#include "utils.h"
+
+#include <sstream>
+
+namespace {
+
+// طول تسلسل UTF-8 صالح يبدأ عند i (0 = بايت غير صالح): بلا ترميز زائد الطول ولا بدائل
+// ولا ما بعد U+10FFFF، ومع استبعاد U+FFFE وU+FFFF غير المسموحين في XML 1.0
+size_t utf8Length(const std::string& text, size_t i) {
+    auto byte = [&](size_t k) { return static_cast<unsigned char>(text[k]); };
+    unsigned char c = byte(i);
+    size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+    if (length == 0 || c > 0xF4 || c == 0xC0 || c == 0xC1 || i + length > text.size()) return 0;
+    for (size_t k = 1; k < length; ++k) {
+        if ((byte(i + k) & 0xC0) != 0x80) return 0;
+    }
+
+    unsigned char next = byte(i + 1);
+    if (c == 0xE0 && next < 0xA0) return 0;             // ترميز زائد الطول
+    if (c == 0xED && next >= 0xA0) return 0;            // بدائل UTF-16
+    if (c == 0xF0 && next < 0x90) return 0;
+    if (c == 0xF4 && next >= 0x90) return 0;            // بعد U+10FFFF
+    if (c == 0xEF && next == 0xBF && byte(i + 2) >= 0xBE) return 0;
+    return length;
+}
+
+std::string xmlEscape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default:
+                if (c >= 0x80) {
+                    // أسماء وبيانات وصفية من ملفات مستعادة قد لا تكون UTF-8: كل بايت غير صالح يصبح U+FFFD
+                    size_t length = utf8Length(text, i);
+                    if (length == 0) {
+                        out += "\xEF\xBF\xBD";
+                    } else {
+                        out.append(text, i, length);
+                        i += length - 1;
+                    }
+                } else if (c >= 0x20 || c == '\t' || c == '\n' || c == '\r') {
+                    // محارف التحكم غير مسموحة في XML 1.0
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    return out;
+}
+
+std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"\r\n") == std::string::npos) return text;
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+bool ReportWriter::parseFormat(const std::string& name, Format& format) {
+    if (name == "jsonl") format = Format::JSONL;
+    else if (name == "csv") format = Format::CSV;
+    else if (name == "dfxml") format = Format::DFXML;
+    else return false;
+    return true;
+}
+
+const char* ReportWriter::extension(Format format) {
+    switch (format) {
+        case Format::JSONL: return "jsonl";
+        case Format::CSV: return "csv";
+        case Format::DFXML: return "dfxml";
+    }
+    return "";
+}
+
+ReportWriter::ReportWriter(const std::string& path, Format format, const std::string& source,
+                           std::chrono::milliseconds flushInterval)
+    : path(path), format(format), source(source), flushInterval(flushInterval) {}
+
+ReportWriter::~ReportWriter() {
+    close();
+}
+
+bool ReportWriter::open(std::string& error) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "cannot create " + path;
+        return false;
+    }
+
+    if (format == Format::CSV) {
+        buffer = "status,type,offset,length,filename,sha256,validation,exact_length,container,container_offset,"
+                 "metadata\n";
+    } else if (format == Format::DFXML) {
+        buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                 "<dfxml version=\"1.0\">\n"
+                 "  <creator>\n"
+                 "    <program>dfr</program>\n"
+                 "  </creator>\n"
+                 "  <source>\n"
+                 "    <image_filename>" + xmlEscape(source) + "</image_filename>\n"
+                 "  </source>\n";
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushLocked();
+    }
+
+    flusher = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, flushInterval, [this]() { return stopping; });
+            if (!buffer.empty()) flushLocked();
+        }
+    });
+    return !failed;
+}
+
+void ReportWriter::write(const Record& record) {
+    std::string line = formatRecord(record);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!out.is_open()) return;
+    buffer += line;
+    ++records;
+    if (buffer.size() >= kBufferSize) flushLocked();
+}
+
+bool ReportWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (flusher.joinable()) flusher.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!out.is_open()) return !failed;
+    if (format == Format::DFXML) buffer += "</dfxml>\n";
+    flushLocked();
+    out.close();
+    return !failed;
+}
+
+uint64_t ReportWriter::recordCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return records;
+}
+
+void ReportWriter::flushLocked() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.flush();
+    if (!out) failed = true;
+    buffer.clear();
+}
+
+std::string ReportWriter::formatRecord(const Record& record) const {
+    std::ostringstream line;
+    switch (format) {
+        case Format::JSONL: {
+            line << "{\"status\": \"" << record.status << "\""
+                 << ", \"type\": \"" << Utils::jsonEscape(record.type) << "\""
+                 << ", \"offset\": " << record.offset
+                 << ", \"length\": " << record.length
+                 << ", \"filename\": \"" << Utils::jsonEscape(record.filename) << "\""
+                 << ", \"sha256\": \"" << record.sha256 << "\""
+                 << ", \"validation\": \"" << record.validation << "\""
+                 << ", \"exact_length\": " << (record.exactLength ? "true" : "false")
+                 << ", \"container\": \"" << Utils::jsonEscape(record.container) << "\""
+                 << ", \"container_offset\": " << record.containerOffset
+                 << ", \"metadata\": {";
+            bool first = true;
+            for (const auto& [key, value] : record.metadata) {
+                line << (first ? "" : ", ") << "\"" << Utils::jsonEscape(key) << "\": \"" << Utils::jsonEscape(value)
+                     << "\"";
+                first = false;
+            }
+            line << "}}\n";
+            break;
+        }
+        case Format::CSV: {
+            std::string metadata;
+            for (const auto& [key, value] : record.metadata) {
+                metadata += (metadata.empty() ? "" : ";") + key + "=" + value;
+            }
+            line << record.status << "," << csvField(record.type) << "," << record.offset << "," << record.length
+                 << "," << csvField(record.filename) << "," << record.sha256 << "," << record.validation << ","
+                 << (record.exactLength ? "true" : "false") << "," << csvField(record.container) << ","
+                 << record.containerOffset << "," << csvField(metadata) << "\n";
+            break;
+        }
+        case Format::DFXML: {
+            // fileobject مع byte_run واحد على المصدر؛ حقول الاستعادة عناصر إضافية تتجاهلها أدوات DFXML
+            line << "  <fileobject>\n";
+            if (!record.filename.empty()) line << "    <filename>" << xmlEscape(record.filename) << "</filename>\n";
+            line << "    <filesize>" << record.length << "</filesize>\n"
+                 << "    <byte_runs>\n"
+                 << "      <byte_run img_offset=\"" << record.offset << "\" len=\"" << record.length << "\"/>\n"
+                 << "    </byte_runs>\n";
+            if (!record.sha256.empty()) line << "    <hashdigest type=\"sha256\">" << record.sha256 << "</hashdigest>\n";
+            line << "    <type>" << xmlEscape(record.type) << "</type>\n"
+                 << "    <carve_status>" << record.status << "</carve_status>\n"
+                 << "    <validation>" << record.validation << "</validation>\n"
+                 << "    <exact_length>" << (record.exactLength ? 1 : 0) << "</exact_length>\n";
+            if (!record.container.empty()) {
+                line << "    <container offset=\"" << record.containerOffset << "\">" << xmlEscape(record.container)
+                     << "</container>\n";
+            }
+            for (const auto& [key, value] : record.metadata) {
+                line << "    <metadata name=\"" << xmlEscape(key) << "\">" << xmlEscape(value) << "</metadata>\n";
+            }
+            line << "  </fileobject>\n";
+            break;
+        }
+    }
+    return line.str();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// تقرير آلي لنتائج الاستعادة يُكتب أثناءها بصيغة JSON Lines أو CSV أو DFXML، سجل لكل إصابة.
+// السجلات تتجمع في مخزن يُفرغ إلى الملف عند امتلائه أو كل flushInterval من خيط خلفي،
+// فتقرأ أدوات أخرى التقرير أثناء مهمة طويلة دون كلفة flush لكل ملف
+class ReportWriter {
+public:
+    enum class Format {
+        JSONL,
+        CSV,
+        DFXML
+    };
+
+    struct Record {
+        std::string status;         // carved | resumed | contained | referenced | skipped | rejected | failed
+        std::string type;
+        uint64_t offset = 0;        // موقع الملف على المصدر
+        uint64_t length = 0;
+        std::string filename;       // فارغ إن لم يُكتب ملف
+        std::string sha256;
+        std::string validation;     // passed | failed | none (النوع بلا مدقق)
+        bool exactLength = false;   // الطول من بنية الملف لا من حد احتياطي
+        std::string container;      // الملف الحاوي إن وقع داخله
+        uint64_t containerOffset = 0;
+        std::map<std::string, std::string> metadata;
+    };
+
+    static constexpr size_t kBufferSize = 256 * 1024;
+
+    // "jsonl" أو "csv" أو "dfxml"
+    static bool parseFormat(const std::string& name, Format& format);
+
+    // امتداد ملف التقرير لكل صيغة
+    static const char* extension(Format format);
+
+    // source: الجهاز أو الصورة الممسوحة (يُذكر في رأس DFXML)
+    ReportWriter(const std::string& path, Format format, const std::string& source,
+                 std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000));
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    // إنشاء الملف (يستبدل تقرير تشغيل سابق) وكتابة رأسه وبدء خيط التفريغ
+    bool open(std::string& error);
+
+    // إضافة سجل؛ آمنة من عدة خيوط
+    void write(const Record& record);
+
+    // تفريغ الباقي وكتابة الخاتمة. تُرجع false إن فشلت أي كتابة
+    bool close();
+
+    const std::string& getPath() const {
+        return path;
+    }
+
+    uint64_t recordCount() const;
+
+private:
+    std::string path;
+    Format format;
+    std::string source;
+    std::chrono::milliseconds flushInterval;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::ofstream out;
+    std::string buffer;
+    uint64_t records = 0;
+    bool stopping = false;
+    bool failed = false;
+    std::thread flusher;
+
+    std::string formatRecord(const Record& record) const;
+    void flushLocked();
+};
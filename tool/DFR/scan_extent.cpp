@@ -0,0 +1,102 @@
+#include "scan_extent.h"
+#include "utils.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+ScanExtent ScanExtents::parse(const std::string& spec) {
+    std::string s = Utils::trim(spec);
+    if (s.empty()) throw std::invalid_argument("empty extent");
+
+    size_t colon = s.find(':');
+    ScanExtent extent;
+    extent.start = Utils::parseSize(s.substr(0, colon));
+    if (colon != std::string::npos) {
+        extent.length = Utils::parseSize(s.substr(colon + 1));
+        if (extent.length == 0) throw std::invalid_argument("extent '" + spec + "' has zero length");
+    }
+    return extent;
+}
+
+std::vector<ScanExtent> ScanExtents::parseList(const std::string& list) {
+    std::vector<ScanExtent> extents;
+    std::istringstream iss(list);
+    std::string token;
+    while (std::getline(iss, token, ',')) {
+        if (Utils::trim(token).empty()) continue;
+        extents.push_back(parse(token));
+    }
+    return extents;
+}
+
+std::vector<ScanExtent> ScanExtents::loadFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::invalid_argument("cannot open extents file " + path);
+
+    std::vector<ScanExtent> extents;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = Utils::trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        try {
+            extents.push_back(parse(line));
+        } catch (const std::exception& e) {
+            throw std::invalid_argument(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+    return extents;
+}
+
+std::vector<ScanExtent> ScanExtents::normalize(std::vector<ScanExtent> extents, uint64_t diskSize) {
+    if (extents.empty()) return {{0, diskSize, ""}};
+
+    std::vector<ScanExtent> clipped;
+    for (auto& extent : extents) {
+        if (extent.start >= diskSize) continue;
+        uint64_t maxLength = diskSize - extent.start;
+        extent.length = extent.length ? std::min(extent.length, maxLength) : maxLength;
+        clipped.push_back(extent);
+    }
+
+    std::sort(clipped.begin(), clipped.end(),
+              [](const ScanExtent& a, const ScanExtent& b) { return a.start < b.start; });
+
+    std::vector<ScanExtent> merged;
+    for (const auto& extent : clipped) {
+        // المتلاصقان يُدمجان فقط إن كانا من المصدر نفسه حتى لا تضيع حدود الأقسام
+        if (!merged.empty() && (extent.start < merged.back().end() ||
+                                (extent.start == merged.back().end() && extent.label == merged.back().label))) {
+            ScanExtent& last = merged.back();
+            last.length = std::max(last.end(), extent.end()) - last.start;
+            if (last.label != extent.label) last.label.clear();
+        } else {
+            merged.push_back(extent);
+        }
+    }
+    return merged;
+}
+
+uint64_t ScanExtents::totalLength(const std::vector<ScanExtent>& extents) {
+    uint64_t total = 0;
+    for (const auto& extent : extents) total += extent.length;
+    return total;
+}
+
+std::string ScanExtents::describe(const std::vector<ScanExtent>& extents) {
+    if (extents.empty()) return "whole device";
+
+    std::ostringstream oss;
+    for (size_t i = 0; i < extents.size(); ++i) {
+        if (i == 3) {
+            oss << ", ... (" << extents.size() << " extents, " << Utils::formatFileSize(totalLength(extents)) << ")";
+            break;
+        }
+        oss << (i ? ", " : "") << (extents[i].length ? Utils::formatFileSize(extents[i].length) : "rest")
+            << " @ " << extents[i].start;
+    }
+    return oss.str();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// مقطع من القرص للمسح: بداية وطول بالبايت (الطول 0 = حتى نهاية القرص)
+struct ScanExtent {
+    uint64_t start = 0;
+    uint64_t length = 0;
+    std::string label;      // اختياري: مصدر المقطع (مثل اسم القسم)
+
+    uint64_t end() const {
+        return start + length;
+    }
+};
+
+// تحليل قوائم المقاطع من سطر الأوامر أو من ملف وتطبيعها على حجم القرص.
+// الصيغة: START:LENGTH أو START فقط، مع اللواحق K/M/G/T أو S للقطاعات (512 بايت).
+class ScanExtents {
+public:
+    // تحليل مقطع واحد (يرمي std::invalid_argument)
+    static ScanExtent parse(const std::string& spec);
+
+    // تحليل قائمة مفصولة بفواصل
+    static std::vector<ScanExtent> parseList(const std::string& list);
+
+    // تحميل مقاطع من ملف: مقطع في كل سطر، والأسطر التي تبدأ بـ # تعليقات
+    static std::vector<ScanExtent> loadFile(const std::string& path);
+
+    // قص المقاطع على حجم القرص وترتيبها ودمج المتداخل منها (والمتلاصق إن كان بالاسم نفسه)
+    // (قائمة فارغة = القرص كاملًا)
+    static std::vector<ScanExtent> normalize(std::vector<ScanExtent> extents, uint64_t diskSize);
+
+    // مجموع أطوال المقاطع
+    static uint64_t totalLength(const std::vector<ScanExtent>& extents);
+
+    // تمثيل نصي مختصر مثل "1.00 GB @ 0"
+    static std::string describe(const std::vector<ScanExtent>& extents);
+};
@@ -0,0 +1,192 @@
+#include "scan_stats.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+
+ScanStats& ScanStats::getInstance() {
+    static ScanStats instance;
+    return instance;
+}
+
+void ScanStats::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    startTime = std::chrono::steady_clock::now();
+    phase.store(Phase::IDLE, std::memory_order_relaxed);
+    phaseTotal.store(0, std::memory_order_relaxed);
+    phaseDone.store(0, std::memory_order_relaxed);
+    bytesRead.store(0, std::memory_order_relaxed);
+    readCalls.store(0, std::memory_order_relaxed);
+    readNanos.store(0, std::memory_order_relaxed);
+    for (auto& bucket : readLatency) bucket.store(0, std::memory_order_relaxed);
+    bytesUnreadable.store(0, std::memory_order_relaxed);
+    bytesScanned.store(0, std::memory_order_relaxed);
+    scanNanos.store(0, std::memory_order_relaxed);
+    totalHits.store(0, std::memory_order_relaxed);
+    hitsPerSignature.clear();
+    filesCarved.store(0, std::memory_order_relaxed);
+    carveBytesWritten.store(0, std::memory_order_relaxed);
+    carveNanos.store(0, std::memory_order_relaxed);
+    metadataBytes.store(0, std::memory_order_relaxed);
+    metadataNanos.store(0, std::memory_order_relaxed);
+    for (auto& depth : queueDepth) depth.store(0, std::memory_order_relaxed);
+}
+
+void ScanStats::setPhase(Phase newPhase, uint64_t total) {
+    phaseDone.store(0, std::memory_order_relaxed);
+    phaseTotal.store(total, std::memory_order_relaxed);
+    phase.store(newPhase, std::memory_order_relaxed);
+}
+
+void ScanStats::advance(uint64_t units) {
+    phaseDone.fetch_add(units, std::memory_order_relaxed);
+}
+
+void ScanStats::recordRead(uint64_t bytes, std::chrono::nanoseconds latency) {
+    uint64_t nanos = static_cast<uint64_t>(latency.count());
+    bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    readCalls.fetch_add(1, std::memory_order_relaxed);
+    readNanos.fetch_add(nanos, std::memory_order_relaxed);
+    readLatency[latencyBucket(nanos / 1000)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ScanStats::recordUnreadable(uint64_t bytes) {
+    bytesUnreadable.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void ScanStats::recordScan(uint64_t bytes, std::chrono::nanoseconds elapsed) {
+    bytesScanned.fetch_add(bytes, std::memory_order_relaxed);
+    scanNanos.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+}
+
+void ScanStats::recordHits(const std::string& extension, uint64_t count) {
+    if (count == 0) return;
+    totalHits.fetch_add(count, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex);
+    hitsPerSignature[extension] += count;
+}
+
+void ScanStats::recordCarve(uint64_t bytesWritten, std::chrono::nanoseconds elapsed) {
+    filesCarved.fetch_add(1, std::memory_order_relaxed);
+    carveBytesWritten.fetch_add(bytesWritten, std::memory_order_relaxed);
+    carveNanos.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+}
+
+void ScanStats::recordMetadata(uint64_t bytes, std::chrono::nanoseconds elapsed) {
+    metadataBytes.fetch_add(bytes, std::memory_order_relaxed);
+    metadataNanos.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+}
+
+void ScanStats::setQueueDepth(Queue queue, uint64_t depth) {
+    queueDepth[static_cast<size_t>(queue)].store(depth, std::memory_order_relaxed);
+}
+
+ScanStats::Snapshot ScanStats::snapshot() const {
+    Snapshot snap;
+    snap.phase = phase.load(std::memory_order_relaxed);
+    snap.phaseTotal = phaseTotal.load(std::memory_order_relaxed);
+    snap.phaseDone = phaseDone.load(std::memory_order_relaxed);
+    snap.bytesRead = bytesRead.load(std::memory_order_relaxed);
+    snap.readCalls = readCalls.load(std::memory_order_relaxed);
+    snap.readNanos = readNanos.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kLatencyBuckets; ++i) {
+        snap.readLatency[i] = readLatency[i].load(std::memory_order_relaxed);
+    }
+    snap.bytesUnreadable = bytesUnreadable.load(std::memory_order_relaxed);
+    snap.bytesScanned = bytesScanned.load(std::memory_order_relaxed);
+    snap.scanNanos = scanNanos.load(std::memory_order_relaxed);
+    snap.totalHits = totalHits.load(std::memory_order_relaxed);
+    snap.filesCarved = filesCarved.load(std::memory_order_relaxed);
+    snap.carveBytesWritten = carveBytesWritten.load(std::memory_order_relaxed);
+    snap.carveNanos = carveNanos.load(std::memory_order_relaxed);
+    snap.metadataBytes = metadataBytes.load(std::memory_order_relaxed);
+    snap.metadataNanos = metadataNanos.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < queueDepth.size(); ++i) {
+        snap.queueDepth[i] = queueDepth[i].load(std::memory_order_relaxed);
+    }
+    snap.logQueueDepth = Logger::getInstance().queueDepth();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    snap.hitsPerSignature = hitsPerSignature;
+    snap.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return snap;
+}
+
+bool ScanStats::writeJson(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "[!] Failed to write stats file: " << path << std::endl;
+        return false;
+    }
+
+    Snapshot snap = snapshot();
+    out << std::fixed << std::setprecision(3);
+    out << "{\n"
+        << "  \"elapsed_seconds\": " << snap.elapsedSeconds << ",\n"
+        << "  \"read\": {\n"
+        << "    \"bytes\": " << snap.bytesRead << ",\n"
+        << "    \"calls\": " << snap.readCalls << ",\n"
+        << "    \"seconds\": " << snap.readNanos / 1e9 << ",\n"
+        << "    \"bytes_per_second\": " << snap.readRate() << ",\n"
+        << "    \"unreadable_bytes\": " << snap.bytesUnreadable << ",\n"
+        << "    \"latency_histogram_us\": [";
+    bool first = true;
+    for (size_t i = 0; i < kLatencyBuckets; ++i) {
+        if (snap.readLatency[i] == 0) continue;
+        out << (first ? "" : ", ") << "{\"lt\": " << (1ull << i) << ", \"count\": " << snap.readLatency[i] << "}";
+        first = false;
+    }
+    out << "]\n"
+        << "  },\n"
+        << "  \"scan\": {\n"
+        << "    \"bytes\": " << snap.bytesScanned << ",\n"
+        << "    \"seconds\": " << snap.scanNanos / 1e9 << ",\n"
+        << "    \"bytes_per_second\": " << snap.scanRate() << ",\n"
+        << "    \"hits\": " << snap.totalHits << ",\n"
+        << "    \"hits_per_signature\": {";
+    first = true;
+    for (const auto& [extension, count] : snap.hitsPerSignature) {
+        out << (first ? "" : ", ") << "\"" << Utils::jsonEscape(extension) << "\": " << count;
+        first = false;
+    }
+    out << "}\n"
+        << "  },\n"
+        << "  \"carve\": {\n"
+        << "    \"files\": " << snap.filesCarved << ",\n"
+        << "    \"bytes_written\": " << snap.carveBytesWritten << ",\n"
+        << "    \"seconds\": " << snap.carveNanos / 1e9 << ",\n"
+        << "    \"bytes_per_second\": " << snap.carveRate() << "\n"
+        << "  },\n"
+        << "  \"metadata\": {\n"
+        << "    \"bytes\": " << snap.metadataBytes << ",\n"
+        << "    \"seconds\": " << snap.metadataNanos / 1e9 << ",\n"
+        << "    \"bytes_per_second\": " << snap.metadataRate() << "\n"
+        << "  },\n"
+        << "  \"queue_depth\": {\n"
+        << "    \"carve\": " << snap.queueDepth[static_cast<size_t>(Queue::CARVE)] << ",\n"
+        << "    \"log\": " << snap.logQueueDepth << "\n"
+        << "  }\n"
+        << "}\n";
+    return static_cast<bool>(out);
+}
+
+const char* ScanStats::phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::IDLE:  return "idle";
+        case Phase::READ:  return "read";
+        case Phase::SCAN:  return "scan";
+        case Phase::CARVE: return "carve";
+        case Phase::DONE:  return "done";
+        default:           return "unknown";
+    }
+}
+
+size_t ScanStats::latencyBucket(uint64_t micros) {
+    size_t bucket = 0;
+    while (bucket + 1 < kLatencyBuckets && (1ull << bucket) <= micros) {
+        ++bucket;
+    }
+    return bucket;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+// عدادات أداء المسح والاستعادة
+// كل التحديثات ذرية بترتيب relaxed وتُستدعى مرة لكل قطعة/ملف وليس لكل بايت
+class ScanStats {
+public:
+    // مرحلة العمل الحالية
+    enum class Phase {
+        IDLE,
+        READ,
+        SCAN,
+        CARVE,
+        DONE
+    };
+
+    // الطوابير التي نراقب عمقها
+    enum class Queue {
+        CARVE,
+        COUNT
+    };
+
+    // مدرج زمن القراءة: الخانة i تعد القراءات التي استغرقت أقل من 2^i ميكروثانية
+    static constexpr size_t kLatencyBuckets = 24;
+
+    // نسخة متسقة تقريبًا من العدادات للعرض
+    struct Snapshot {
+        Phase phase = Phase::IDLE;
+        uint64_t phaseTotal = 0;
+        uint64_t phaseDone = 0;
+        double elapsedSeconds = 0.0;
+
+        uint64_t bytesRead = 0;
+        uint64_t readCalls = 0;
+        uint64_t readNanos = 0;
+        std::array<uint64_t, kLatencyBuckets> readLatency{};
+        uint64_t bytesUnreadable = 0;
+
+        uint64_t bytesScanned = 0;
+        uint64_t scanNanos = 0;
+        uint64_t totalHits = 0;
+        std::map<std::string, uint64_t> hitsPerSignature;
+
+        uint64_t filesCarved = 0;
+        uint64_t carveBytesWritten = 0;
+        uint64_t carveNanos = 0;
+
+        uint64_t metadataBytes = 0;
+        uint64_t metadataNanos = 0;
+
+        std::array<uint64_t, static_cast<size_t>(Queue::COUNT)> queueDepth{};
+        uint64_t logQueueDepth = 0;
+
+        // معدلات مشتقة بالبايت/ثانية
+        double readRate() const { return readNanos ? bytesRead * 1e9 / readNanos : 0.0; }
+        double scanRate() const { return scanNanos ? bytesScanned * 1e9 / scanNanos : 0.0; }
+        double carveRate() const { return carveNanos ? carveBytesWritten * 1e9 / carveNanos : 0.0; }
+        double metadataRate() const { return metadataNanos ? metadataBytes * 1e9 / metadataNanos : 0.0; }
+    };
+
+    static ScanStats& getInstance();
+
+    // تصفير كل العدادات في بداية تشغيل جديد
+    void reset();
+
+    // بدء مرحلة جديدة بعدد وحدات عمل معروف (بايتات أو ملفات)
+    void setPhase(Phase newPhase, uint64_t total);
+
+    void advance(uint64_t units);
+
+    // تسجيل عملية قراءة واحدة من القرص
+    void recordRead(uint64_t bytes, std::chrono::nanoseconds latency);
+
+    // تسجيل بايتات تعذرت قراءتها (مُلئت بأصفار)
+    void recordUnreadable(uint64_t bytes);
+
+    // تسجيل مسح كتلة بيانات
+    void recordScan(uint64_t bytes, std::chrono::nanoseconds elapsed);
+
+    // تسجيل عدد الإصابات لتوقيع معين (مرة لكل توقيع في كل استدعاء مسح)
+    void recordHits(const std::string& extension, uint64_t count);
+
+    // تسجيل ملف تمت كتابته وزمن نسخه
+    void recordCarve(uint64_t bytesWritten, std::chrono::nanoseconds elapsed);
+
+    // تسجيل استخراج البيانات الوصفية من رأس ملف مستعاد
+    void recordMetadata(uint64_t bytes, std::chrono::nanoseconds elapsed);
+
+    void setQueueDepth(Queue queue, uint64_t depth);
+
+    Snapshot snapshot() const;
+
+    // كتابة الإحصائيات بصيغة JSON في نهاية التشغيل
+    bool writeJson(const std::string& path) const;
+
+    static const char* phaseName(Phase phase);
+
+private:
+    std::atomic<Phase> phase{Phase::IDLE};
+    std::atomic<uint64_t> phaseTotal{0};
+    std::atomic<uint64_t> phaseDone{0};
+
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> readCalls{0};
+    std::atomic<uint64_t> readNanos{0};
+    std::array<std::atomic<uint64_t>, kLatencyBuckets> readLatency{};
+    std::atomic<uint64_t> bytesUnreadable{0};
+
+    std::atomic<uint64_t> bytesScanned{0};
+    std::atomic<uint64_t> scanNanos{0};
+    std::atomic<uint64_t> totalHits{0};
+
+    std::atomic<uint64_t> filesCarved{0};
+    std::atomic<uint64_t> carveBytesWritten{0};
+    std::atomic<uint64_t> carveNanos{0};
+
+    std::atomic<uint64_t> metadataBytes{0};
+    std::atomic<uint64_t> metadataNanos{0};
+
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Queue::COUNT)> queueDepth{};
+
+    mutable std::mutex mutex;
+    std::map<std::string, uint64_t> hitsPerSignature;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    ScanStats() = default;
+    ScanStats(const ScanStats&) = delete;
+    ScanStats& operator=(const ScanStats&) = delete;
+
+    // رقم خانة المدرج لزمن بالميكروثانية
+    static size_t latencyBucket(uint64_t micros);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// تنفيذ SHA-256 مستقل (FIPS 180-4) لبصمات قطع الصورة والملفات المستعادة دون مكتبات خارجية
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+
+    void update(const uint8_t* data, size_t size);
+
+    // إنهاء الحساب (لا يصح الاستدعاء بعده إلا بعد reset)
+    Digest finish();
+
+    void reset();
+
+    // بصمة كتلة كاملة بصيغة hex
+    static std::string hex(const uint8_t* data, size_t size);
+
+    static std::string toHex(const Digest& digest);
+
+private:
+    std::array<uint32_t, 8> state;
+    std::array<uint8_t, 64> block;
+    size_t blockLength = 0;
+    uint64_t totalLength = 0;
+
+    void transform(const uint8_t* chunk);
+};
@@ -0,0 +1,363 @@
+#include "signature_automaton.h"
+#include "logger.h"
+#include "scan_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <set>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DFR_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// نمط سحري ثابت وقت الترجمة: المقارنة تُفك بالكامل إلى مقارنات بايتات ثابتة
+template <uint8_t... Bytes>
+struct Magic {
+    static constexpr size_t size = sizeof...(Bytes);
+    static constexpr std::array<uint8_t, sizeof...(Bytes)> bytes = {Bytes...};
+
+    static bool matches(const uint8_t* p) {
+        size_t i = 0;
+        return ((p[i++] == Bytes) && ...);
+    }
+};
+
+// مطابِق مولد لمجموعة جاهزة: حلقة واحدة على البيانات، وفي كل موقع تُجرب الأنماط الثابتة بالترتيب
+template <typename... Magics>
+struct StaticMatcher {
+    static constexpr size_t maxSize = std::max({Magics::size...});
+
+    static std::vector<std::vector<uint8_t>> magics() {
+        return {std::vector<uint8_t>(Magics::bytes.begin(), Magics::bytes.end())...};
+    }
+
+    static void scan(const SignatureAutomaton& automaton, const uint8_t* data, size_t size, size_t limit,
+                     uint64_t baseOffset, std::vector<SignatureAutomaton::Hit>& hits) {
+        limit = std::min(limit, size);
+        size_t safeEnd = size >= maxSize ? std::min(limit, size - maxSize + 1) : 0;
+
+        size_t i = 0;
+        for (; i < safeEnd; ++i) {
+            matchAt<false>(automaton, data, size, i, baseOffset, hits, std::index_sequence_for<Magics...>{});
+        }
+        // آخر البيانات: قد لا تتسع الأنماط الطويلة
+        for (; i < limit; ++i) {
+            matchAt<true>(automaton, data, size, i, baseOffset, hits, std::index_sequence_for<Magics...>{});
+        }
+    }
+
+private:
+    template <bool Bounded, size_t... K>
+    static void matchAt(const SignatureAutomaton& automaton, const uint8_t* data, size_t size, size_t i,
+                        uint64_t baseOffset, std::vector<SignatureAutomaton::Hit>& hits, std::index_sequence<K...>) {
+        const uint8_t* p = data + i;
+        ((((!Bounded || Magics::size <= size - i) && Magics::matches(p))
+              ? automaton.emit(K, baseOffset + i, hits) : void()), ...);
+    }
+};
+
+namespace {
+
+using ImagesMatcher = StaticMatcher<
+    Magic<0xFF, 0xD8, 0xFF>,                                // jpg
+    Magic<0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A>,  // png
+    Magic<0x47, 0x49, 0x46, 0x38>,                          // gif
+    Magic<0x42, 0x4D>,                                      // bmp
+    Magic<0x00, 0x00, 0x01, 0x00>>;                         // ico
+
+using DocumentsMatcher = StaticMatcher<
+    Magic<0x25, 0x50, 0x44, 0x46>,                          // pdf
+    Magic<0x50, 0x4B, 0x03, 0x04>>;                         // docx/xlsx/pptx
+
+// أقصى عدد لقيم المراسي في التصفية المتجهة: كل قيمة مقارنة إضافية لكل كتلة، وبعدها يكون جدول الدلاء أسرع
+constexpr size_t kMaxVectorAnchors = 16;
+
+inline unsigned lowestBit(uint32_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return index;
+#else
+    return static_cast<unsigned>(__builtin_ctz(bits));
+#endif
+}
+
+// استدعاء onMatch(i) لكل بايت في data[0, size) قيمته من values، بمقارنة كتلة كاملة بكل القيم معًا.
+// يُرجع أول موقع لم يُفحص (ذيل أقصر من كتلة، أو 0 بلا دعم متجهات) ليكمله المستدعي
+template <typename OnMatch>
+size_t scanByteSet(const uint8_t* data, size_t size, const std::vector<uint8_t>& values, OnMatch&& onMatch) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256i set[kMaxVectorAnchors];
+    for (size_t k = 0; k < values.size(); ++k) set[k] = _mm256_set1_epi8(static_cast<char>(values[k]));
+    for (; i + 32 <= size; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i any = _mm256_cmpeq_epi8(block, set[0]);
+        for (size_t k = 1; k < values.size(); ++k) any = _mm256_or_si256(any, _mm256_cmpeq_epi8(block, set[k]));
+        for (uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(any)); bits; bits &= bits - 1) {
+            onMatch(i + lowestBit(bits));
+        }
+    }
+#elif defined(DFR_SSE2)
+    __m128i set[kMaxVectorAnchors];
+    for (size_t k = 0; k < values.size(); ++k) set[k] = _mm_set1_epi8(static_cast<char>(values[k]));
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i any = _mm_cmpeq_epi8(block, set[0]);
+        for (size_t k = 1; k < values.size(); ++k) any = _mm_or_si128(any, _mm_cmpeq_epi8(block, set[k]));
+        for (uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(any)); bits; bits &= bits - 1) {
+            onMatch(i + lowestBit(bits));
+        }
+    }
+#else
+    (void)data; (void)size; (void)values; (void)onMatch;
+#endif
+    return i;
+}
+
+const std::vector<std::string> kImageTypes = {"jpg", "png", "gif", "bmp", "ico"};
+const std::vector<std::string> kDocumentTypes = {"pdf", "docx", "xlsx", "pptx"};
+
+std::vector<std::string> sortedUnique(std::vector<std::string> types) {
+    std::sort(types.begin(), types.end());
+    types.erase(std::unique(types.begin(), types.end()), types.end());
+    return types;
+}
+
+} // namespace
+
+SignatureAutomaton SignatureAutomaton::compile(const std::vector<std::string>& types) {
+    SignatureAutomaton automaton;
+    std::vector<std::string> wanted = sortedUnique(types);
+
+    bool bound = false;
+    if (wanted == sortedUnique(kImageTypes)) {
+        bound = bindPreset<ImagesMatcher>(automaton, Preset::IMAGES, wanted);
+    } else if (wanted == sortedUnique(kDocumentTypes)) {
+        bound = bindPreset<DocumentsMatcher>(automaton, Preset::DOCUMENTS, wanted);
+    }
+
+    if (!bound) {
+        for (const auto& sig : SignatureScanner::getKnownSignatures()) {
+            if (wanted.empty() || std::binary_search(wanted.begin(), wanted.end(), sig.extension)) {
+                automaton.addPattern(&sig);
+            }
+        }
+    }
+
+    // التوقيعات المختارة بترتيب الجدول الأصلي
+    std::set<const SignatureScanner::FileSignature*> used;
+    for (const auto& pattern : automaton.patterns) used.insert(pattern.outputs.begin(), pattern.outputs.end());
+    for (const auto& sig : SignatureScanner::getKnownSignatures()) {
+        if (used.count(&sig)) automaton.selected.push_back(&sig);
+    }
+    automaton.patternByBytes.clear();
+
+    automaton.buildIndex();
+    LOG_DEBUG("Automaton", "Compiled ", automaton.patterns.size(), " patterns for ", automaton.selected.size(),
+              " signatures (", presetName(automaton.presetKind), ")");
+    return automaton;
+}
+
+const std::vector<std::string>* SignatureAutomaton::presetTypes(const std::string& name) {
+    if (name == "images") return &kImageTypes;
+    if (name == "documents") return &kDocumentTypes;
+    return nullptr;
+}
+
+void SignatureAutomaton::scan(const uint8_t* data, size_t size, size_t limit, uint64_t baseOffset,
+                              std::vector<Hit>& hits) const {
+    ScanStats& stats = ScanStats::getInstance();
+    auto scanStart = std::chrono::steady_clock::now();
+    size_t hitsBefore = hits.size();
+    limit = std::min(limit, size);
+
+    if (staticScan) {
+        staticScan(*this, data, size, limit, baseOffset, hits);
+    } else if (!patterns.empty()) {
+        // المرساة عند i تعني أن النمط يبدأ عند i - anchor
+        auto tryAt = [&](size_t i) {
+            uint8_t value = data[i];
+            for (uint32_t k = bucketStart[value]; k < bucketStart[value + 1]; ++k) {
+                const Pattern& pattern = patterns[bucketPatterns[k]];
+                if (i < pattern.anchor) continue;
+                size_t start = i - pattern.anchor;
+                const auto& magic = pattern.magic;
+                if (start >= limit || magic.size() > size - start) continue;
+                bool match = true;
+                if (pattern.mask.empty()) {
+                    match = std::memcmp(data + start, magic.data(), magic.size()) == 0;
+                } else {
+                    for (size_t j = 0; j < magic.size() && match; ++j) match = (data[start + j] & pattern.mask[j]) == magic[j];
+                }
+                if (match) emit(bucketPatterns[k], baseOffset + start, hits);
+            }
+        };
+
+        size_t scanEnd = std::min(size, limit + maxAnchor);
+        if (singleAnchorByte >= 0) {
+            const uint8_t* p = data;
+            const uint8_t* end = data + scanEnd;
+            while (p < end && (p = static_cast<const uint8_t*>(std::memchr(p, singleAnchorByte, end - p)))) {
+                tryAt(p - data);
+                ++p;
+            }
+        } else {
+            size_t i = anchorBytes.empty() ? 0 : scanByteSet(data, scanEnd, anchorBytes, tryAt);
+            for (; i < scanEnd; ++i) {
+                if (bucketStart[data[i]] != bucketStart[data[i] + 1]) tryAt(i);
+            }
+        }
+
+        // مراسٍ في مواقع مختلفة تُخرج الإصابات بغير ترتيب البداية
+        if (maxAnchor) {
+            std::stable_sort(hits.begin() + hitsBefore, hits.end(),
+                             [](const Hit& x, const Hit& y) { return x.offset < y.offset; });
+        }
+    }
+
+    std::map<const SignatureScanner::FileSignature*, uint64_t> perSignature;
+    for (size_t i = hitsBefore; i < hits.size(); ++i) perSignature[hits[i].signature]++;
+    for (const auto& [sig, count] : perSignature) stats.recordHits(sig->extension, count);
+
+    stats.advance(limit);
+    stats.recordScan(limit, std::chrono::steady_clock::now() - scanStart);
+}
+
+const char* SignatureAutomaton::presetName(Preset preset) {
+    switch (preset) {
+        case Preset::IMAGES:    return "images";
+        case Preset::DOCUMENTS: return "documents";
+        default:                return "custom";
+    }
+}
+
+void SignatureAutomaton::addPattern(const SignatureScanner::FileSignature* sig) {
+    std::vector<uint8_t> magic(sig->headerOffset, 0);
+    magic.insert(magic.end(), sig->magic.begin(), sig->magic.end());
+
+    // القناع يُطبق مسبقًا على magic فتصبح المقارنة (بايت & قناع) == magic
+    std::vector<uint8_t> mask;
+    if (sig->headerOffset || !sig->mask.empty()) {
+        mask.assign(sig->headerOffset, 0x00);
+        for (size_t i = 0; i < sig->magic.size(); ++i) mask.push_back(sig->mask.empty() ? 0xFF : sig->mask[i]);
+        for (size_t i = 0; i < magic.size(); ++i) magic[i] &= mask[i];
+    }
+
+    auto existing = patternByBytes.find({magic, mask});
+    if (existing != patternByBytes.end()) {
+        patterns[existing->second].outputs.push_back(sig);
+        return;
+    }
+    patternByBytes[{magic, mask}] = patterns.size();
+    patterns.push_back({magic, mask, {sig}});
+}
+
+void SignatureAutomaton::buildIndex() {
+    auto anchorMatches = [](const Pattern& pattern, size_t value) {
+        uint8_t mask = pattern.mask.empty() ? 0xFF : pattern.mask[pattern.anchor];
+        return (value & mask) == pattern.magic[pattern.anchor];
+    };
+
+    std::array<uint32_t, 256> counts{};
+    maxLength = 0;
+    maxAnchor = 0;
+    for (auto& pattern : patterns) {
+        pattern.anchor = chooseAnchor(pattern);
+        for (size_t b = 0; b < 256; ++b) {
+            if (anchorMatches(pattern, b)) counts[b]++;
+        }
+        maxLength = std::max(maxLength, pattern.magic.size());
+        maxAnchor = std::max(maxAnchor, pattern.anchor);
+    }
+
+    bucketStart[0] = 0;
+    for (size_t b = 0; b < 256; ++b) bucketStart[b + 1] = bucketStart[b] + counts[b];
+
+    bucketPatterns.assign(bucketStart[256], 0);
+    std::array<uint32_t, 256> fill{};
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        for (size_t b = 0; b < 256; ++b) {
+            if (anchorMatches(patterns[i], b)) bucketPatterns[bucketStart[b] + fill[b]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    singleAnchorByte = -1;
+    anchorBytes.clear();
+    size_t usedValues = std::count_if(counts.begin(), counts.end(), [](uint32_t c) { return c != 0; });
+    if (usedValues == 1) {
+        singleAnchorByte = static_cast<int>(std::find_if(counts.begin(), counts.end(), [](uint32_t c) { return c != 0; }) -
+                                            counts.begin());
+    } else if (usedValues <= kMaxVectorAnchors) {
+        for (size_t b = 0; b < 256; ++b) {
+            if (counts[b]) anchorBytes.push_back(static_cast<uint8_t>(b));
+        }
+    }
+}
+
+size_t SignatureAutomaton::chooseAnchor(const Pattern& pattern) {
+    // تقدير تكرار البايت في بيانات الأقراص: الأصفار و0xFF والنصوص كثيرة فهي مراسٍ سيئة
+    auto weight = [](size_t value) -> uint64_t {
+        if (value == 0x00) return 64;
+        if (value == 0xFF) return 16;
+        if (value == 0x20 || value == 0x0A || value == 0x0D) return 8;
+        if (value > 0x20 && value < 0x7F) return 4;
+        return 2;
+    };
+
+    // كلفة الموقع = مجموع أوزان القيم التي يقبلها قناعه؛ الأقل هو المرساة (والأسبق عند التساوي)
+    size_t best = 0;
+    uint64_t bestCost = UINT64_MAX;
+    for (size_t pos = 0; pos < pattern.magic.size(); ++pos) {
+        uint8_t mask = pattern.mask.empty() ? 0xFF : pattern.mask[pos];
+        uint64_t cost = 0;
+        for (size_t value = 0; value < 256; ++value) {
+            if ((value & mask) == pattern.magic[pos]) cost += weight(value);
+        }
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = pos;
+        }
+    }
+    return best;
+}
+
+void SignatureAutomaton::emit(size_t pattern, uint64_t offset, std::vector<Hit>& hits) const {
+    for (const auto* sig : patterns[pattern].outputs) {
+        hits.push_back({offset, sig});
+    }
+}
+
+template <typename PresetMatcher>
+bool SignatureAutomaton::bindPreset(SignatureAutomaton& automaton, Preset kind, const std::vector<std::string>& types) {
+    // ربط أنماط المطابِق الثابت بالتوقيعات في الجدول؛ أي اختلاف يعيدنا إلى الماسح العام
+    std::vector<Pattern> bound;
+    size_t covered = 0;
+    for (const auto& magic : PresetMatcher::magics()) {
+        Pattern pattern{magic, {}};
+        for (const auto& sig : SignatureScanner::getKnownSignatures()) {
+            if (sig.magic == magic && sig.mask.empty() && sig.headerOffset == 0 &&
+                std::binary_search(types.begin(), types.end(), sig.extension)) {
+                pattern.outputs.push_back(&sig);
+            }
+        }
+        if (pattern.outputs.empty()) return false;
+        covered += pattern.outputs.size();
+        bound.push_back(std::move(pattern));
+    }
+    if (covered != types.size()) return false;
+
+    automaton.patterns = std::move(bound);
+    automaton.presetKind = kind;
+    automaton.staticScan = &PresetMatcher::scan;
+    return true;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <map>
+
+#include "signature_scanner.h"
+
+// ماسح مُجمَّع يحتوي فقط على التوقيعات المطلوبة.
+// التوقيعات التي تشترك في البايتات السحرية نفسها (zip/docx/xlsx/pptx) تصبح نمطًا واحدًا بعدة مخرجات،
+// وكل نمط مفهرس حسب "مرساة": أندر بايت ثابت (أو شبه ثابت بقناع) فيه، فالأنماط ذات البداية الحرة
+// مثل ????ftyp و RIFF????WAVE تبقى في تمريرة واحدة ولا يُفحص أي موقع ليس فيه مرساة.
+// المجموعات الشائعة (صور فقط، مستندات فقط) لها مطابِقات مولدة وقت الترجمة.
+class SignatureAutomaton {
+public:
+    struct Hit {
+        uint64_t offset;
+        const SignatureScanner::FileSignature* signature;
+    };
+
+    enum class Preset {
+        CUSTOM,
+        IMAGES,
+        DOCUMENTS
+    };
+
+    // بناء ماسح لأنواع محددة (قائمة فارغة = كل التوقيعات المعروفة)
+    static SignatureAutomaton compile(const std::vector<std::string>& types = {});
+
+    // أنواع مجموعة جاهزة بالاسم ("images" أو "documents")، أو nullptr إن لم يكن الاسم مجموعة
+    static const std::vector<std::string>* presetTypes(const std::string& name);
+
+    // مسح data[0, size) وإضافة الإصابات التي تبدأ قبل limit مرتبة حسب الموقع
+    // (الإزاحات في النتائج = baseOffset + الموقع)
+    void scan(const uint8_t* data, size_t size, size_t limit, uint64_t baseOffset, std::vector<Hit>& hits) const;
+
+    // التوقيعات التي يبحث عنها هذا الماسح
+    const std::vector<const SignatureScanner::FileSignature*>& signatures() const {
+        return selected;
+    }
+
+    // أطول نمط (لحساب التداخل بين القطع)
+    size_t maxPatternLength() const {
+        return maxLength;
+    }
+
+    bool empty() const {
+        return patterns.empty();
+    }
+
+    Preset preset() const {
+        return presetKind;
+    }
+
+    static const char* presetName(Preset preset);
+
+private:
+    // النمط يبدأ من بداية الملف: موقع الرأس يصبح بايتات حرة قبل magic
+    struct Pattern {
+        std::vector<uint8_t> magic;
+        std::vector<uint8_t> mask;      // فارغ = مقارنة مباشرة
+        std::vector<const SignatureScanner::FileSignature*> outputs;
+        size_t anchor = 0;              // موقع بايت الفهرسة داخل النمط
+    };
+
+    using StaticScanFn = void (*)(const SignatureAutomaton&, const uint8_t*, size_t, size_t, uint64_t, std::vector<Hit>&);
+
+    std::vector<Pattern> patterns;
+    std::vector<const SignatureScanner::FileSignature*> selected;
+    std::array<uint32_t, 257> bucketStart{};    // الأنماط مرتبة حسب قيمة بايت المرساة
+    std::vector<uint32_t> bucketPatterns;
+    size_t maxAnchor = 0;                       // إن كان > 0 قد تظهر الإصابات بغير ترتيب فتُرتب بعد المسح
+    std::map<std::pair<std::vector<uint8_t>, std::vector<uint8_t>>, size_t> patternByBytes;    // للدمج وقت البناء
+    size_t maxLength = 0;
+    int singleAnchorByte = -1;                  // إن كانت كل المراسي قيمة واحدة نستخدم memchr
+    std::vector<uint8_t> anchorBytes;           // قيم المراسي إن كانت قليلة: تصفية متجهة قبل فحص الدلاء
+    Preset presetKind = Preset::CUSTOM;
+    StaticScanFn staticScan = nullptr;
+
+    void addPattern(const SignatureScanner::FileSignature* sig);
+    void buildIndex();
+    static size_t chooseAnchor(const Pattern& pattern);
+    void emit(size_t pattern, uint64_t offset, std::vector<Hit>& hits) const;
+
+    template <typename PresetMatcher>
+    static bool bindPreset(SignatureAutomaton& automaton, Preset kind, const std::vector<std::string>& types);
+
+    template <typename... Magics>
+    friend struct StaticMatcher;
+};
@@ -0,0 +1,282 @@
+#include "signature_database.h"
+#include "file_rebuilder.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kCacheMagic[8] = {'D', 'F', 'R', 'S', 'I', 'G', '1', '\n'};
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// كتابة وقراءة الحقول بترتيب little-endian
+class CacheWriter {
+public:
+    void u8(uint8_t value) { out.push_back(value); }
+    void u32(uint32_t value) { for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i))); }
+    void u64(uint64_t value) { for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i))); }
+    void bytes(const void* data, size_t size) {
+        u32(static_cast<uint32_t>(size));
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), p, p + size);
+    }
+
+    std::vector<uint8_t> out;
+};
+
+class CacheReader {
+public:
+    CacheReader(const std::vector<uint8_t>& in) : in(in) {}
+
+    bool u8(uint8_t& value) {
+        if (pos + 1 > in.size()) return false;
+        value = in[pos++];
+        return true;
+    }
+    bool u32(uint32_t& value) {
+        if (pos + 4 > in.size()) return false;
+        value = 0;
+        for (int i = 3; i >= 0; --i) value = (value << 8) | in[pos + i];
+        pos += 4;
+        return true;
+    }
+    bool u64(uint64_t& value) {
+        if (pos + 8 > in.size()) return false;
+        value = 0;
+        for (int i = 7; i >= 0; --i) value = (value << 8) | in[pos + i];
+        pos += 8;
+        return true;
+    }
+    template <typename Container>
+    bool bytes(Container& value) {
+        uint32_t size = 0;
+        if (!u32(size) || pos + size > in.size()) return false;
+        value.assign(in.begin() + pos, in.begin() + pos + size);
+        pos += size;
+        return true;
+    }
+    bool atEnd() const { return pos == in.size(); }
+
+private:
+    const std::vector<uint8_t>& in;
+    size_t pos = 0;
+};
+
+} // namespace
+
+std::vector<SignatureScanner::FileSignature> SignatureDatabase::parse(std::istream& in, const std::string& sourceName) {
+    std::vector<SignatureScanner::FileSignature> signatures;
+    std::set<std::string> entries;      // EXT وHEADER
+    std::string line;
+    size_t lineNumber = 0;
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = Utils::trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        try {
+            std::istringstream iss(line);
+            std::string header;
+            SignatureScanner::FileSignature sig{};
+            if (!(iss >> sig.extension >> header)) throw std::invalid_argument("expected EXT HEADER");
+            if (!entries.insert(sig.extension + " " + header).second) {
+                throw std::invalid_argument("duplicate type '" + sig.extension + "' with header " + header);
+            }
+            parseHex(header, sig.magic, sig.mask);
+
+            std::string option;
+            while (iss >> option) {
+                size_t eq = option.find('=');
+                if (eq == std::string::npos) throw std::invalid_argument("expected KEY=VALUE, got '" + option + "'");
+                std::string key = option.substr(0, eq);
+                std::string value = option.substr(eq + 1);
+
+                if (key == "offset") {
+                    sig.headerOffset = static_cast<uint32_t>(Utils::parseSize(value));
+                } else if (key == "footer") {
+                    std::vector<uint8_t> footerMask;
+                    parseHex(value, sig.endMagic, footerMask);
+                    if (!footerMask.empty()) throw std::invalid_argument("footer cannot contain wildcards");
+                    sig.hasEndSignature = true;
+                } else if (key == "max") {
+                    sig.maxSize = Utils::parseSize(value);
+                } else if (key == "validator") {
+                    if (!FileRebuilder::hasValidator(value)) throw std::invalid_argument("unknown validator '" + value + "'");
+                    sig.validator = value;
+                } else {
+                    throw std::invalid_argument("unknown option '" + key + "'");
+                }
+            }
+            signatures.push_back(std::move(sig));
+        } catch (const std::exception& e) {
+            throw std::invalid_argument(sourceName + ":" + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+
+    if (signatures.empty()) throw std::invalid_argument(sourceName + ": no signatures defined");
+    return signatures;
+}
+
+std::vector<SignatureScanner::FileSignature> SignatureDatabase::load(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    SourceStamp stamp;
+    if (!stampOf(path, stamp)) throw std::invalid_argument("cannot open signature database " + path);
+
+    std::vector<SignatureScanner::FileSignature> signatures;
+    bool cached = readCache(cachePath(path), stamp, signatures);
+    if (!cached) {
+        std::ifstream in(path);
+        if (!in.is_open()) throw std::invalid_argument("cannot open signature database " + path);
+        signatures = parse(in, path);
+        if (!writeCache(cachePath(path), stamp, signatures)) {
+            LOG_DEBUG("Signatures", "Cannot write signature cache ", cachePath(path));
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("Signatures", "Loaded ", signatures.size(), " signatures from ", path, cached ? " (cached)" : "",
+             " in ", elapsed, " ms");
+    return signatures;
+}
+
+std::string SignatureDatabase::cachePath(const std::string& path) {
+    return path + ".bin";
+}
+
+bool SignatureDatabase::stampOf(const std::string& path, SourceStamp& stamp) {
+    std::error_code ec;
+    stamp.size = fs::file_size(path, ec);
+    if (ec) return false;
+    auto modified = fs::last_write_time(path, ec);
+    if (ec) return false;
+    stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    return true;
+}
+
+bool SignatureDatabase::readCache(const std::string& path, const SourceStamp& stamp,
+                                  std::vector<SignatureScanner::FileSignature>& signatures) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(kCacheMagic) || std::memcmp(data.data(), kCacheMagic, sizeof(kCacheMagic)) != 0) {
+        return false;
+    }
+    std::vector<uint8_t> body(data.begin() + sizeof(kCacheMagic), data.end());
+    CacheReader reader(body);
+
+    // النسخة الثنائية صالحة فقط لنفس حجم الملف النصي ووقت تعديله
+    uint64_t size = 0, modified = 0;
+    uint32_t count = 0;
+    if (!reader.u64(size) || !reader.u64(modified) || !reader.u32(count)) return false;
+    if (size != stamp.size || static_cast<int64_t>(modified) != stamp.modified) return false;
+
+    std::vector<SignatureScanner::FileSignature> loaded(count);
+    for (auto& sig : loaded) {
+        uint8_t hasEnd = 0;
+        if (!reader.bytes(sig.extension) || !reader.bytes(sig.magic) || !reader.bytes(sig.mask) ||
+            !reader.u32(sig.headerOffset) || !reader.u8(hasEnd) || !reader.bytes(sig.endMagic) ||
+            !reader.u64(sig.maxSize) || !reader.bytes(sig.validator)) {
+            return false;
+        }
+        sig.hasEndSignature = hasEnd != 0;
+        if (!sig.mask.empty() && sig.mask.size() != sig.magic.size()) return false;
+    }
+    if (!reader.atEnd()) return false;
+
+    signatures = std::move(loaded);
+    return true;
+}
+
+bool SignatureDatabase::writeCache(const std::string& path, const SourceStamp& stamp,
+                                   const std::vector<SignatureScanner::FileSignature>& signatures) {
+    CacheWriter writer;
+    writer.out.assign(kCacheMagic, kCacheMagic + sizeof(kCacheMagic));
+    writer.u64(stamp.size);
+    writer.u64(static_cast<uint64_t>(stamp.modified));
+    writer.u32(static_cast<uint32_t>(signatures.size()));
+    for (const auto& sig : signatures) {
+        writer.bytes(sig.extension.data(), sig.extension.size());
+        writer.bytes(sig.magic.data(), sig.magic.size());
+        writer.bytes(sig.mask.data(), sig.mask.size());
+        writer.u32(sig.headerOffset);
+        writer.u8(sig.hasEndSignature ? 1 : 0);
+        writer.bytes(sig.endMagic.data(), sig.endMagic.size());
+        writer.u64(sig.maxSize);
+        writer.bytes(sig.validator.data(), sig.validator.size());
+    }
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(reinterpret_cast<const char*>(writer.out.data()), writer.out.size());
+        if (!out) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+void SignatureDatabase::parseHex(const std::string& text, std::vector<uint8_t>& bytes, std::vector<uint8_t>& mask) {
+    size_t amp = text.find('&');
+    std::string value = text.substr(0, amp);
+    if (value.empty() || value.size() % 2) throw std::invalid_argument("bad hex '" + text + "'");
+
+    bytes.clear();
+    mask.clear();
+    bool masked = false;
+    for (size_t i = 0; i < value.size(); i += 2) {
+        uint8_t byte = 0, byteMask = 0;
+        for (size_t n = 0; n < 2; ++n) {
+            char c = value[i + n];
+            int shift = n ? 0 : 4;
+            if (c == '?') {
+                masked = true;
+                continue;
+            }
+            int v = hexValue(c);
+            if (v < 0) throw std::invalid_argument("bad hex '" + text + "'");
+            byte |= static_cast<uint8_t>(v << shift);
+            byteMask |= static_cast<uint8_t>(0x0F << shift);
+        }
+        bytes.push_back(byte);
+        mask.push_back(byteMask);
+    }
+
+    if (amp != std::string::npos) {
+        // قناع صريح بالطول نفسه يُضاف إلى أنصاف البايتات الحرة
+        std::vector<uint8_t> explicitMask, unused;
+        parseHex(text.substr(amp + 1), explicitMask, unused);
+        if (!unused.empty() || explicitMask.size() != bytes.size()) {
+            throw std::invalid_argument("mask in '" + text + "' must be plain hex of the same length");
+        }
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            mask[i] &= explicitMask[i];
+            bytes[i] &= mask[i];
+        }
+        masked = true;
+    }
+
+    if (!masked) mask.clear();
+    if (!mask.empty() && mask[0] == 0 && std::all_of(mask.begin(), mask.end(), [](uint8_t m) { return m == 0; })) {
+        throw std::invalid_argument("header '" + text + "' has no fixed bits");
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <cstdint>
+
+#include "signature_scanner.h"
+
+// قاعدة توقيعات خارجية بصيغة نصية بدل الجدول المدمج. سطر لكل نوع:
+//   EXT  HEADER  [offset=N] [footer=HEX] [max=SIZE] [validator=NAME]
+// HEADER بالست عشري، و'?' نصف بايت حر، و"HEX&MASK" قناع بتات صريح (مثل FFE0&FFE0 لتزامن MP3).
+// تُحفظ نسخة ثنائية بجانب الملف (FILE.bin) فيصبح تحميل آلاف التوقيعات عند البدء قراءة واحدة.
+class SignatureDatabase {
+public:
+    // تحليل نص القاعدة (يرمي std::invalid_argument مع اسم المصدر ورقم السطر)
+    static std::vector<SignatureScanner::FileSignature> parse(std::istream& in, const std::string& sourceName);
+
+    // تحميل قاعدة من ملف عبر النسخة الثنائية إن كانت أحدث من الملف، وإلا تحليله وتحديثها
+    static std::vector<SignatureScanner::FileSignature> load(const std::string& path);
+
+    // مسار النسخة الثنائية لقاعدة نصية
+    static std::string cachePath(const std::string& path);
+
+private:
+    struct SourceStamp {
+        uint64_t size = 0;
+        int64_t modified = 0;
+    };
+
+    static bool stampOf(const std::string& path, SourceStamp& stamp);
+    static bool readCache(const std::string& path, const SourceStamp& stamp,
+                          std::vector<SignatureScanner::FileSignature>& signatures);
+    static bool writeCache(const std::string& path, const SourceStamp& stamp,
+                           const std::vector<SignatureScanner::FileSignature>& signatures);
+
+    // "FFD8?F" أو "FFE0&FFE0" -> بايتات وقناع (فارغ إن لم يكن فيه بت حر)
+    static void parseHex(const std::string& text, std::vector<uint8_t>& bytes, std::vector<uint8_t>& mask);
+};
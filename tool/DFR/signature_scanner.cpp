@@ -1,108 +1,123 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <cstdint>
-#include <unordered_map>
+#include "signature_scanner.h"
+#include "signature_automaton.h"
+
 #include <algorithm>
-#include <cstring>
-
-class SignatureScanner {
-public:
-    // هيكل يحتوي على معلومات التوقيع
-    struct FileSignature {
-        std::vector<uint8_t> magic;
-        std::string extension;
-        bool hasEndSignature;
-        std::vector<uint8_t> endMagic;
+
+namespace {
+
+// أكبر حجم معقول لكل نوع (كما في signatures.conf): حد البحث عن التذييل والطول الاحتياطي
+constexpr uint64_t kMB = 1024 * 1024;
+
+std::vector<SignatureScanner::FileSignature> builtinSignatures() {
+    return {
+        // صور
+        {{0xFF, 0xD8, 0xFF}, "jpg", true, {0xFF, 0xD9}, {}, 0, 20 * kMB, "jpeg"},
+        {{0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A}, "png", true, {0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82},
+         {}, 0, 20 * kMB, "png"},
+        {{0x47, 0x49, 0x46, 0x38}, "gif", true, {0x00, 0x3B}, {}, 0, 10 * kMB, "gif"},
+        {{0x42, 0x4D}, "bmp", false, {}, {}, 0, 32 * kMB, "bmp"},
+        {{0x00, 0x00, 0x01, 0x00}, "ico", false, {}, {}, 0, 1 * kMB, "ico"},
+
+        // مستندات
+        {{0x25, 0x50, 0x44, 0x46}, "pdf", true, {0x25, 0x25, 0x45, 0x4F, 0x46}, {}, 0, 64 * kMB, "pdf"},
+        {{0x50, 0x4B, 0x03, 0x04}, "docx", true, {0x50, 0x4B, 0x05, 0x06}, {}, 0, 64 * kMB, "docx"}, // ZIP-based files
+        {{0x50, 0x4B, 0x03, 0x04}, "xlsx", true, {0x50, 0x4B, 0x05, 0x06}, {}, 0, 64 * kMB, "xlsx"},
+        {{0x50, 0x4B, 0x03, 0x04}, "pptx", true, {0x50, 0x4B, 0x05, 0x06}, {}, 0, 64 * kMB, "pptx"},
+
+        // فيديو
+        {{0x66, 0x74, 0x79, 0x70}, "mp4", false, {}, {}, 4, 64 * kMB, "ftyp"},                  // ftyp بعد حجم الصندوق، والطول من الصناديق
+        {{0x52, 0x49, 0x46, 0x46, 0, 0, 0, 0, 0x41, 0x56, 0x49, 0x20}, "avi", false, {},
+         {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF}, 0, 64 * kMB, "riff"},    // RIFF????AVI
+
+        // صوت
+        {{0xFF, 0xE0}, "mp3", false, {}, {0xFF, 0xE0}, 0, 16 * kMB, "mpeg-audio"},              // تزامن 11 بت
+        {{0x49, 0x44, 0x33}, "mp3", false, {}, {}, 0, 16 * kMB, "id3"},                         // وسم ID3v2 قبل الإطارات
+        {{0x52, 0x49, 0x46, 0x46, 0, 0, 0, 0, 0x57, 0x41, 0x56, 0x45}, "wav", false, {},
+         {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF}, 0, 64 * kMB, "riff"},    // RIFF????WAVE
+
+        // Archives
+        {{0x1F, 0x8B, 0x08}, "gz", false, {}, {}, 0, 64 * kMB, "gzip"},
+        {{0x50, 0x4B, 0x03, 0x04}, "zip", true, {0x50, 0x4B, 0x05, 0x06}, {}, 0, 64 * kMB, "zip"}
     };
+}
+
+std::vector<SignatureScanner::FileSignature>& activeSignatures() {
+    static std::vector<SignatureScanner::FileSignature> signatures = builtinSignatures();
+    return signatures;
+}
+
+} // namespace
 
-    // قائمة التوقيعات المعروفة
-    static const std::vector<FileSignature>& getKnownSignatures() {
-        static std::vector<FileSignature> signatures = {
-            // صور
-            {{0xFF, 0xD8, 0xFF}, "jpg", true, {0xFF, 0xD9}},
-            {{0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A}, "png", true, {0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82}},
-            {{0x47, 0x49, 0x46, 0x38}, "gif"},
-            {{0x42, 0x4D}, "bmp"},
-            {{0x00, 0x00, 0x01, 0x00}, "ico"},
-
-            // مستندات
-            {{0x25, 0x50, 0x44, 0x46}, "pdf"},
-            {{0x50, 0x4B, 0x03, 0x04}, "docx", true, {0x50, 0x4B, 0x05, 0x06}}, // ZIP-based files
-            {{0x50, 0x4B, 0x03, 0x04}, "xlsx", true, {0x50, 0x4B, 0x05, 0x06}},
-            {{0x50, 0x4B, 0x03, 0x04}, "pptx", true, {0x50, 0x4B, 0x05, 0x06}},
-
-            // فيديو
-            {{0x00, 0x00, 0x00, 0x18}, "mp4", true, {0x66, 0x72, 0x65, 0x65}}, // Begins with ftyp ends with free
-            {{0x52, 0x49, 0x46, 0x46}, "avi"},
-
-            // صوت
-            {{0xFF, 0xFB}, "mp3"},
-            {{0x52, 0x49, 0x46, 0x46}, "wav", true, {0x57, 0x41, 0x56, 0x45}},
-
-            // Archives
-            {{0x1F, 0x8B, 0x08}, "gz"},
-            {{0x50, 0x4B, 0x03, 0x04}, "zip", true, {0x50, 0x4B, 0x05, 0x06}}
-        };
-        return signatures;
+const std::vector<SignatureScanner::FileSignature>& SignatureScanner::getKnownSignatures() {
+    return activeSignatures();
+}
+
+void SignatureScanner::installSignatures(std::vector<FileSignature> signatures) {
+    activeSignatures() = std::move(signatures);
+}
+
+bool SignatureScanner::matchesAt(const FileSignature& signature, const uint8_t* p, size_t available) {
+    if (available < signature.headerOffset + signature.magic.size()) return false;
+    p += signature.headerOffset;
+    for (size_t i = 0; i < signature.magic.size(); ++i) {
+        uint8_t mask = signature.mask.empty() ? 0xFF : signature.mask[i];
+        if ((p[i] & mask) != (signature.magic[i] & mask)) return false;
     }
+    return true;
+}
 
-    // البحث عن التوقيعات في البيانات
-    static std::vector<std::pair<size_t, FileSignature>> scan(const std::vector<uint8_t>& data) {
-        std::vector<std::pair<size_t, FileSignature>> results;
+std::vector<std::pair<size_t, SignatureScanner::FileSignature>> SignatureScanner::scan(const std::vector<uint8_t>& data) {
+    // ماسح واحد لكل التوقيعات في تمريرة واحدة على البيانات
+    static const SignatureAutomaton automaton = SignatureAutomaton::compile();
 
-        for (const auto& sig : getKnownSignatures()) {
-            size_t pos = 0;
-            while ((pos = findSubVector(data, sig.magic, pos)) != std::string::npos) {
-                results.emplace_back(pos, sig);
-                pos += 1; // الاستمرار بعد الموقع المكتشف
-            }
-        }
+    std::vector<SignatureAutomaton::Hit> hits;
+    automaton.scan(data.data(), data.size(), data.size(), 0, hits);
 
-        return results;
+    std::vector<std::pair<size_t, FileSignature>> results;
+    results.reserve(hits.size());
+    for (const auto& hit : hits) {
+        results.emplace_back(static_cast<size_t>(hit.offset), *hit.signature);
     }
+    return results;
+}
 
-    // البحث عن نهاية الملف إن وُجد توقيع نهاية
-    static size_t findEndOfSignature(const std::vector<uint8_t>& data, const FileSignature& signature, size_t startOffset, size_t maxSearchSize = 1024 * 1024) {
-        if (!signature.hasEndSignature) return std::string::npos;
-
-        size_t searchLimit = std::min(data.size(), startOffset + maxSearchSize);
-        for (size_t i = startOffset; i < searchLimit - signature.endMagic.size(); ++i) {
-            bool match = true;
-            for (size_t j = 0; j < signature.endMagic.size(); ++j) {
-                if (data[i + j] != signature.endMagic[j]) {
-                    match = false;
-                    break;
-                }
-            }
-            if (match) {
-                return i + signature.endMagic.size();
+size_t SignatureScanner::findEndOfSignature(const std::vector<uint8_t>& data, const FileSignature& signature, size_t startOffset, size_t maxSearchSize) {
+    if (!signature.hasEndSignature) return std::string::npos;
+
+    size_t searchLimit = std::min(data.size(), startOffset + maxSearchSize);
+    for (size_t i = startOffset; i < searchLimit - signature.endMagic.size(); ++i) {
+        bool match = true;
+        for (size_t j = 0; j < signature.endMagic.size(); ++j) {
+            if (data[i + j] != signature.endMagic[j]) {
+                match = false;
+                break;
             }
         }
+        if (match) {
+            return i + signature.endMagic.size();
+        }
+    }
+
+    return std::string::npos;
+}
 
+size_t SignatureScanner::findSubVector(const std::vector<uint8_t>& data, const std::vector<uint8_t>& pattern, size_t startPos) {
+    if (pattern.empty() || data.size() < pattern.size() || startPos > data.size() - pattern.size()) {
         return std::string::npos;
     }
 
-private:
-    // البحث عن تسلسل بايتات في مصفوفة أخرى
-    static size_t findSubVector(const std::vector<uint8_t>& data, const std::vector<uint8_t>& pattern, size_t startPos) {
-        if (pattern.empty() || data.size() < pattern.size() || startPos > data.size() - pattern.size()) {
-            return std::string::npos;
-        }
-
-        for (size_t i = startPos; i <= data.size() - pattern.size(); ++i) {
-            bool found = true;
-            for (size_t j = 0; j < pattern.size(); ++j) {
-                if (data[i + j] != pattern[j]) {
-                    found = false;
-                    break;
-                }
-            }
-            if (found) {
-                return i;
+    for (size_t i = startPos; i <= data.size() - pattern.size(); ++i) {
+        bool found = true;
+        for (size_t j = 0; j < pattern.size(); ++j) {
+            if (data[i + j] != pattern[j]) {
+                found = false;
+                break;
             }
         }
-
-        return std::string::npos;
+        if (found) {
+            return i;
+        }
     }
-};
\ No newline at end of file
+
+    return std::string::npos;
+}
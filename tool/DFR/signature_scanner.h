@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+
+class SignatureScanner {
+public:
+    // هيكل يحتوي على معلومات التوقيع
+    struct FileSignature {
+        std::vector<uint8_t> magic;
+        std::string extension;
+        bool hasEndSignature;
+        std::vector<uint8_t> endMagic;
+        std::vector<uint8_t> mask;      // قناع لكل بايت من magic (فارغ = كل البايتات ثابتة)
+        uint32_t headerOffset = 0;      // موقع magic من بداية الملف
+        uint64_t maxSize = 0;           // أقصى حجم لهذا النوع (0 = الحد العام)
+        std::string validator;          // اسم مدقق الرأس قبل الاستعادة (فارغ = بدون)
+    };
+
+    // قائمة التوقيعات المعروفة (المدمجة أو المحملة من قاعدة توقيعات)
+    static const std::vector<FileSignature>& getKnownSignatures();
+
+    // استبدال التوقيعات المدمجة بقاعدة محملة؛ يجب أن يسبق بناء أي ماسح لأن الماسحات تحتفظ بمؤشرات إليها
+    static void installSignatures(std::vector<FileSignature> signatures);
+
+    // هل يبدأ ملف من هذا النوع عند p؟ (available = البايتات المتاحة من p)
+    static bool matchesAt(const FileSignature& signature, const uint8_t* p, size_t available);
+
+    // البحث عن كل التوقيعات في البيانات (لمسح أنواع محددة استخدم SignatureAutomaton)
+    static std::vector<std::pair<size_t, FileSignature>> scan(const std::vector<uint8_t>& data);
+
+    // البحث عن نهاية الملف إن وُجد توقيع نهاية
+    static size_t findEndOfSignature(const std::vector<uint8_t>& data, const FileSignature& signature, size_t startOffset, size_t maxSearchSize = 1024 * 1024);
+
+private:
+    // البحث عن تسلسل بايتات في مصفوفة أخرى
+    static size_t findSubVector(const std::vector<uint8_t>& data, const std::vector<uint8_t>& pattern, size_t startPos);
+};
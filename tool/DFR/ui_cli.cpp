@@ -1,16 +1,14 @@
+#include "ui_cli.h"
+#include "signature_automaton.h"
+
 #include <iostream>
-#include <vector>
-#include <string>
 #include <sstream>
 #include <iomanip>
 #include <limits>
 #include <algorithm>
 
-class CliUI {
-public:
-    // عرض عنوان الأداة
-    void showBanner() const {
-        std::cout << R"(
+void CliUI::showBanner() const {
+    std::cout << R"(
   ██████╗ ██╗   ██╗██╗ ██████╗     ███████╗██╗███╗   ██╗██████╗ 
   ██╔══██╗██║   ██║██║ ██╔══██╗    ██╔════╝██║████╗  ██║██╔══██╗
   ██████╔╝██║   ██║██║ ██████╔╝    ███████╗██║██╔██╗ ██║██║  ██║
@@ -18,124 +16,171 @@ public:
   ██████╔╝ ╚████╔╝ ██║ ██║         ███████║██║██║ ╚████║██████╔╝
   ╚═════╝   ╚═══╝  ╚═╝ ╚═╝         ╚══════╝╚═╝╚═╝  ╚═══╝╚═════╝ 
 )" << '\n';
-        std::cout << "          File Recovery Tool - Advanced CLI Interface\n";
-        std::cout << "--------------------------------------------------------\n\n";
-    }
-
-    // عرض القائمة الرئيسية
-    void showMainMenu() const {
-        std::cout << "[Main Menu]\n";
-        std::cout << "  [1] Start Disk Scan\n";
-        std::cout << "  [2] View Recovered Files\n";
-        std::cout << "  [3] Settings\n";
-        std::cout << "  [4] Exit\n";
-        std::cout << "\nEnter your choice: ";
-    }
-
-    // طلب مسار القرص من المستخدم
-    std::string getDiskPathInput() const {
-        std::string path;
-        std::cout << "\nEnter disk path (e.g., /dev/sda or \\\\.\\PhysicalDrive0): ";
-        std::cin.ignore();
-        std::getline(std::cin, path);
-        return path;
-    }
-
-    // طلب مسار حفظ النتائج
-    std::string getOutputPathInput() const {
-        std::string path;
-        std::cout << "Enter output directory (default: ./recovered): ";
-        std::getline(std::cin, path);
-        return path.empty() ? "./recovered" : path;
-    }
-
-    // عرض خيارات أنواع الملفات
-    std::vector<std::string> getFileTypesSelection() const {
-        std::vector<std::string> allTypes = {"jpg", "png", "pdf", "docx", "xlsx", "pptx", "mp3", "wav", "zip", "gif"};
-        std::vector<std::string> selected;
-
-        std::cout << "\nSelect file types to recover (comma-separated, e.g.: jpg,png,pdf)\n";
-        std::cout << "Available types: ";
-        for (const auto& t : allTypes) std::cout << t << " ";
-        std::cout << "\nYour selection: ";
-
-        std::string input;
-        std::getline(std::cin, input);
-
-        if (input == "all") return allTypes;
-
-        std::istringstream iss(input);
-        std::string token;
-        while (std::getline(iss, token, ',')) {
-            token = trim(token);
-            if (std::find(allTypes.begin(), allTypes.end(), token) != allTypes.end()) {
-                selected.push_back(token);
-            }
+    std::cout << "          File Recovery Tool - Advanced CLI Interface\n";
+    std::cout << "--------------------------------------------------------\n\n";
+}
+
+void CliUI::showMainMenu() const {
+    std::cout << "[Main Menu]\n";
+    std::cout << "  [1] Start Disk Scan\n";
+    std::cout << "  [2] View Recovered Files\n";
+    std::cout << "  [3] Settings\n";
+    std::cout << "  [4] Exit\n";
+    std::cout << "\nEnter your choice: ";
+}
+
+std::string CliUI::getDiskPathInput() const {
+    std::string path;
+    std::cout << "\nEnter disk path (e.g., /dev/sda or \\\\.\\PhysicalDrive0): ";
+    std::cin.ignore();
+    std::getline(std::cin, path);
+    return path;
+}
+
+std::string CliUI::getOutputPathInput() const {
+    std::string path;
+    std::cout << "Enter output directory (default: ./recovered): ";
+    std::getline(std::cin, path);
+    return path.empty() ? "./recovered" : path;
+}
+
+std::vector<std::string> CliUI::getFileTypesSelection() const {
+    std::vector<std::string> allTypes = {"jpg", "png", "pdf", "docx", "xlsx", "pptx", "mp3", "wav", "zip", "gif"};
+    std::vector<std::string> selected;
+
+    std::cout << "\nSelect file types to recover (comma-separated, e.g.: jpg,png,pdf)\n";
+    std::cout << "Presets: images, documents, all\n";
+    std::cout << "Available types: ";
+    for (const auto& t : allTypes) std::cout << t << " ";
+    std::cout << "\nYour selection: ";
+
+    std::string input;
+    std::getline(std::cin, input);
+
+    if (input == "all") return allTypes;
+
+    std::istringstream iss(input);
+    std::string token;
+    while (std::getline(iss, token, ',')) {
+        token = trim(token);
+        if (const auto* preset = SignatureAutomaton::presetTypes(token)) {
+            selected.insert(selected.end(), preset->begin(), preset->end());
+        } else if (std::find(allTypes.begin(), allTypes.end(), token) != allTypes.end()) {
+            selected.push_back(token);
         }
-
-        return selected;
     }
 
-    // عرض شاشة الإعدادات
-    void showSettingsMenu() const {
-        std::cout << "\n[Settings]\n";
-        std::cout << "  [1] Set custom scan size\n";
-        std::cout << "  [2] Toggle debug mode\n";
-        std::cout << "  [3] Back to main menu\n";
-        std::cout << "\nEnter your choice: ";
+    return selected;
+}
+
+void CliUI::showSettingsMenu() const {
+    std::cout << "\n[Settings]\n";
+    std::cout << "  [1] Set scan range / extents\n";
+    std::cout << "  [2] Toggle debug mode\n";
+    std::cout << "  [3] Back to main menu\n";
+    std::cout << "\nEnter your choice: ";
+}
+
+std::string CliUI::getScanExtentsInput(const std::string& current) const {
+    std::string input;
+    std::cout << "\nCurrent scan extents: " << current << "\n";
+    std::cout << "Enter extents as START:LENGTH, comma-separated (suffixes K/M/G/T, S = 512-byte sectors),\n";
+    std::cout << "'all' for the whole disk, @FILE to load them from a file,\n";
+    std::cout << "or 'partitions' to toggle scanning per MBR/GPT partition: ";
+    std::cin.ignore();
+    std::getline(std::cin, input);
+    return trim(input);
+}
+
+void CliUI::showProgress(int percent, const std::string& status) const {
+    int barWidth = 50;
+    std::cout << "[";
+    int pos = barWidth * percent / 100;
+    for (int i = 0; i < barWidth; ++i) {
+        if (i < pos) std::cout << "=";
+        else if (i == pos) std::cout << ">";
+        else std::cout << " ";
     }
-
-    // عرض شاشة التحميل أثناء المسح
-    void showProgress(int percent, const std::string& status = "") const {
-        int barWidth = 50;
-        std::cout << "[";
-        int pos = barWidth * percent / 100;
-        for (int i = 0; i < barWidth; ++i) {
-            if (i < pos) std::cout << "=";
-            else if (i == pos) std::cout << ">";
-            else std::cout << " ";
-        }
-        std::cout << "] " << percent << " % " << status << "\r";
-        std::cout.flush();
+    std::cout << "] " << percent << " % " << status << "\r";
+    std::cout.flush();
+}
+
+void CliUI::showScanProgress(const ScanStats::Snapshot& snap, std::ostream& out) const {
+    int percent = snap.phaseTotal ? static_cast<int>(std::min<uint64_t>(100, snap.phaseDone * 100 / snap.phaseTotal)) : 0;
+
+    std::ostringstream oss;
+    oss << "[" << std::setw(5) << ScanStats::phaseName(snap.phase) << "] "
+        << std::setw(3) << percent << "% | read " << formatFileSize(snap.bytesRead)
+        << " @ " << formatFileSize(static_cast<uint64_t>(snap.readRate())) << "/s";
+    if (snap.bytesUnreadable) oss << " (bad " << formatFileSize(snap.bytesUnreadable) << ")";
+    oss << " | scan " << formatFileSize(static_cast<uint64_t>(snap.scanRate())) << "/s"
+        << " | hits " << snap.totalHits
+        << " | carved " << snap.filesCarved << " (" << formatFileSize(snap.carveBytesWritten) << ")"
+        << " | queue " << snap.queueDepth[static_cast<size_t>(ScanStats::Queue::CARVE)]
+        << "/" << snap.logQueueDepth
+        << " | " << static_cast<uint64_t>(snap.elapsedSeconds) << "s";
+
+    out << "\r" << oss.str() << "   ";
+    out.flush();
+}
+
+void CliUI::showRecoverySummary(size_t filesRecovered, size_t totalSize) const {
+    std::cout << "\n\n[+] Recovery completed successfully!\n";
+    std::cout << " - Total files recovered: " << filesRecovered << "\n";
+    std::cout << " - Total data recovered: " << formatFileSize(totalSize) << "\n";
+}
+
+int CliUI::getUserChoice() const {
+    int choice;
+    while (!(std::cin >> choice)) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid input. Please enter a number: ";
     }
-
-    // عرض ملخص الاستعادة
-    void showRecoverySummary(size_t filesRecovered, size_t totalSize) const {
-        std::cout << "\n\n[+] Recovery completed successfully!\n";
-        std::cout << " - Total files recovered: " << filesRecovered << "\n";
-        std::cout << " - Total data recovered: " << formatFileSize(totalSize) << "\n";
+    return choice;
+}
+
+std::string CliUI::formatFileSize(uint64_t bytes) const {
+    const std::string units[] = {"B", "KB", "MB", "GB"};
+    int i = 0;
+    double size = static_cast<double>(bytes);
+    while (size >= 1024 && i < 3) {
+        size /= 1024;
+        ++i;
     }
-
-    // قراءة خيار من المستخدم
-    int getUserChoice() const {
-        int choice;
-        while (!(std::cin >> choice)) {
-            std::cin.clear();
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::cout << "Invalid input. Please enter a number: ";
-        }
-        return choice;
-    }
-
-    // تنسيق الحجم إلى KB/MB/GB
-    std::string formatFileSize(uint64_t bytes) const {
-        const std::string units[] = {"B", "KB", "MB", "GB"};
-        int i = 0;
-        double size = static_cast<double>(bytes);
-        while (size >= 1024 && i < 3) {
-            size /= 1024;
-            ++i;
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << size << " " << units[i];
+    return oss.str();
+}
+
+std::string CliUI::trim(const std::string& s) const {
+    if (s.empty()) return s;
+    size_t start = s.find_first_not_of(" \t\n\r\f\v");
+    size_t end = s.find_last_not_of(" \t\n\r\f\v");
+    return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
+}
+
+ProgressReporter::ProgressReporter(const CliUI& ui, std::chrono::milliseconds interval, std::ostream& out)
+    : ui(ui), interval(interval), out(out), running(true) {
+    worker = std::thread([this]() {
+        auto nextTick = std::chrono::steady_clock::now();
+        while (running.load(std::memory_order_relaxed)) {
+            nextTick += this->interval;
+            while (running.load(std::memory_order_relaxed) && std::chrono::steady_clock::now() < nextTick) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            this->ui.showScanProgress(ScanStats::getInstance().snapshot(), this->out);
         }
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(2) << size << " " << units[i];
-        return oss.str();
-    }
-
-    // تقليم المسافات
-    std::string trim(const std::string& s) const {
-        if (s.empty()) return s;
-        size_t start = s.find_first_not_of(" \t\n\r\f\v");
-        size_t end = s.find_last_not_of(" \t\n\r\f\v");
-        return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
-    }
-};
\ No newline at end of file
+    });
+}
+
+ProgressReporter::~ProgressReporter() {
+    stop();
+}
+
+void ProgressReporter::stop() {
+    if (!worker.joinable()) return;
+    running.store(false, std::memory_order_relaxed);
+    worker.join();
+    out << std::endl;
+}
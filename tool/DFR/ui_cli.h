@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+#include "scan_stats.h"
+
+class CliUI {
+public:
+    // عرض عنوان الأداة
+    void showBanner() const;
+
+    // عرض القائمة الرئيسية
+    void showMainMenu() const;
+
+    // طلب مسار القرص من المستخدم
+    std::string getDiskPathInput() const;
+
+    // طلب مسار حفظ النتائج
+    std::string getOutputPathInput() const;
+
+    // عرض خيارات أنواع الملفات
+    std::vector<std::string> getFileTypesSelection() const;
+
+    // عرض شاشة الإعدادات
+    void showSettingsMenu() const;
+
+    // طلب مقاطع المسح (START:LENGTH مفصولة بفواصل، أو all للقرص كاملًا)
+    std::string getScanExtentsInput(const std::string& current) const;
+
+    // عرض شاشة التحميل أثناء المسح
+    void showProgress(int percent, const std::string& status = "") const;
+
+    // سطر تقدم حي أثناء المسح: المرحلة، النسبة، معدلات القراءة والمسح، الإصابات والطوابير
+    void showScanProgress(const ScanStats::Snapshot& snap, std::ostream& out = std::cout) const;
+
+    // عرض ملخص الاستعادة
+    void showRecoverySummary(size_t filesRecovered, size_t totalSize) const;
+
+    // قراءة خيار من المستخدم
+    int getUserChoice() const;
+
+    // تنسيق الحجم إلى KB/MB/GB
+    std::string formatFileSize(uint64_t bytes) const;
+
+    // تقليم المسافات
+    std::string trim(const std::string& s) const;
+};
+
+// خيط خلفي يطبع سطر التقدم دوريًا طوال عمر الكائن
+class ProgressReporter {
+public:
+    ProgressReporter(const CliUI& ui,
+                     std::chrono::milliseconds interval = std::chrono::milliseconds(1000),
+                     std::ostream& out = std::cout);
+
+    ~ProgressReporter();
+
+    // إيقاف الخيط وطباعة السطر الأخير
+    void stop();
+
+private:
+    const CliUI& ui;
+    std::chrono::milliseconds interval;
+    std::ostream& out;
+    std::atomic<bool> running;
+    std::thread worker;
+};
@@ -1,148 +1,195 @@
+#include "utils.h"
+
 #include <iostream>
 #include <fstream>
-#include <vector>
-#include <string>
 #include <sstream>
 #include <iomanip>
-#include <cstdint>
 #include <cctype>
+#include <cstdio>
 #include <filesystem>
 #include <algorithm>
+#include <stdexcept>
+
+#ifndef _WIN32
+    #include <sys/stat.h>
+#endif
 
 namespace fs = std::filesystem;
 
-class Utils {
-public:
-    // تحويل بيانات ثنائية إلى هيكسي
-    static std::string toHex(const std::vector<uint8_t>& data, size_t limit = 64) {
-        std::stringstream ss;
-        for (size_t i = 0; i < std::min(data.size(), limit); ++i) {
-            ss << std::hex << std::setw(2) << std::setfill('0') 
-               << static_cast<int>(data[i]) << " ";
-        }
-        return ss.str();
+std::string Utils::toHex(const std::vector<uint8_t>& data, size_t limit) {
+    std::stringstream ss;
+    for (size_t i = 0; i < std::min(data.size(), limit); ++i) {
+        ss << std::hex << std::setw(2) << std::setfill('0') 
+           << static_cast<int>(data[i]) << " ";
     }
-
-    // طباعة Hex Dump كامل أو جزئي
-    static void hexDump(const std::vector<uint8_t>& data, size_t limit = 128) {
-        for (size_t i = 0; i < std::min(data.size(), limit); ++i) {
-            printf("%02X ", data[i]);
-            if ((i + 1) % 16 == 0) std::cout << std::endl;
-            else if ((i + 1) % 8 == 0) std::cout << "  ";
-        }
-        std::cout << std::endl;
+    return ss.str();
+}
+
+void Utils::hexDump(const std::vector<uint8_t>& data, size_t limit) {
+    for (size_t i = 0; i < std::min(data.size(), limit); ++i) {
+        printf("%02X ", data[i]);
+        if ((i + 1) % 16 == 0) std::cout << std::endl;
+        else if ((i + 1) % 8 == 0) std::cout << "  ";
     }
-
-    // قراءة ملف كبيانات ثنائية
-    static std::vector<uint8_t> readFileBinary(const std::string& path) {
-        std::ifstream file(path, std::ios::binary | std::ios::ate);
-        if (!file.is_open()) {
-            std::cerr << "[!] Failed to open file: " << path << std::endl;
-            return {};
-        }
-
-        std::streamsize size = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        std::vector<uint8_t> buffer(size);
-        if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
-            std::cerr << "[!] Failed to read file: " << path << std::endl;
-            return {};
-        }
-
-        return buffer;
+    std::cout << std::endl;
+}
+
+std::vector<uint8_t> Utils::readFileBinary(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "[!] Failed to open file: " << path << std::endl;
+        return {};
     }
 
-    // كتابة بيانات ثنائية إلى ملف
-    static bool writeFileBinary(const std::string& path, const std::vector<uint8_t>& data) {
-        std::ofstream file(path, std::ios::binary);
-        if (!file) {
-            std::cerr << "[!] Failed to create file: " << path << std::endl;
-            return false;
-        }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
 
-        file.write(reinterpret_cast<const char*>(data.data()), data.size());
-        return true;
+    std::vector<uint8_t> buffer(size);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
+        std::cerr << "[!] Failed to read file: " << path << std::endl;
+        return {};
     }
 
-    // إنشاء مجلد إن لم يكن موجودًا
-    static bool createDirectoryIfNotExists(const std::string& path) {
-        try {
-            if (!fs::exists(path)) {
-                if (!fs::create_directories(path)) {
-                    std::cerr << "[!] Failed to create directory: " << path << std::endl;
-                    return false;
-                }
-            }
-        } catch (const fs::filesystem_error& e) {
-            std::cerr << "[!] Filesystem error: " << e.what() << std::endl;
-            return false;
-        }
-        return true;
-    }
+    return buffer;
+}
 
-    // التحقق مما إذا كان الملف موجودًا
-    static bool fileExists(const std::string& path) {
-        return fs::exists(path);
+bool Utils::writeFileBinary(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "[!] Failed to create file: " << path << std::endl;
+        return false;
     }
 
-    // الحصول على اسم الملف من المسار
-    static std::string getFileNameFromPath(const std::string& path) {
-        fs::path p(path);
-        return p.filename().string();
-    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return true;
+}
 
-    // تنظيف المسار (إزالة المسافات الزائدة، التنقلات..)
-    static std::string sanitizePath(const std::string& path) {
-        std::string result = path;
-        std::replace(result.begin(), result.end(), '\\', '/');
-        size_t pos = 0;
-        while ((pos = result.find("//", pos)) != std::string::npos) {
-            result.replace(pos, 2, "/");
+bool Utils::createDirectoryIfNotExists(const std::string& path) {
+    try {
+        if (!fs::exists(path)) {
+            if (!fs::create_directories(path)) {
+                std::cerr << "[!] Failed to create directory: " << path << std::endl;
+                return false;
+            }
         }
-        return result;
+    } catch (const fs::filesystem_error& e) {
+        std::cerr << "[!] Filesystem error: " << e.what() << std::endl;
+        return false;
     }
-
-    // فحص ما إذا كان القرص موجودًا (Linux فقط)
-    static bool isBlockDevice(const std::string& path) {
-        #ifdef _WIN32
-            return true; // في ويندوز نعتمد على المحاولة
-        #else
-            struct stat sb;
-            return stat(path.c_str(), &sb) == 0 && S_ISBLK(sb.st_mode);
-        #endif
+    return true;
+}
+
+bool Utils::fileExists(const std::string& path) {
+    return fs::exists(path);
+}
+
+std::string Utils::getFileNameFromPath(const std::string& path) {
+    fs::path p(path);
+    return p.filename().string();
+}
+
+std::string Utils::sanitizePath(const std::string& path) {
+    std::string result = path;
+    std::replace(result.begin(), result.end(), '\\', '/');
+    size_t pos = 0;
+    while ((pos = result.find("//", pos)) != std::string::npos) {
+        result.replace(pos, 2, "/");
     }
-
-    // تحويل حجم بالبايت إلى KB/MB/GB
-    static std::string formatFileSize(uint64_t bytes) {
-        const std::string units[] = {"B", "KB", "MB", "GB"};
-        int i = 0;
-        double size = static_cast<double>(bytes);
-        while (size >= 1024 && i < 3) {
-            size /= 1024;
-            ++i;
-        }
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(2) << size << " " << units[i];
-        return oss.str();
+    return result;
+}
+
+bool Utils::isBlockDevice(const std::string& path) {
+    #ifdef _WIN32
+        return true; // في ويندوز نعتمد على المحاولة
+    #else
+        struct stat sb;
+        return stat(path.c_str(), &sb) == 0 && S_ISBLK(sb.st_mode);
+    #endif
+}
+
+std::string Utils::formatFileSize(uint64_t bytes) {
+    const std::string units[] = {"B", "KB", "MB", "GB"};
+    int i = 0;
+    double size = static_cast<double>(bytes);
+    while (size >= 1024 && i < 3) {
+        size /= 1024;
+        ++i;
     }
-
-    // تقليم المسافات من بداية ونهاية السلسلة
-    static std::string trim(const std::string& s) {
-        if (s.empty()) return s;
-        size_t start = s.find_first_not_of(" \t\n\r\f\v");
-        size_t end = s.find_last_not_of(" \t\n\r\f\v");
-        return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << size << " " << units[i];
+    return oss.str();
+}
+
+std::string Utils::trim(const std::string& s) {
+    if (s.empty()) return s;
+    size_t start = s.find_first_not_of(" \t\n\r\f\v");
+    size_t end = s.find_last_not_of(" \t\n\r\f\v");
+    return (start == std::string::npos) ? "" : s.substr(start, end - start + 1);
+}
+
+std::string Utils::jsonEscape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
     }
-
-    // هل السلسلة تبدأ بنص معين؟
-    static bool startsWith(const std::string& str, const std::string& prefix) {
-        return str.rfind(prefix, 0) == 0;
+    return out;
+}
+
+uint64_t Utils::parseSize(const std::string& text) {
+    std::string s = trim(text);
+    if (s.empty()) throw std::invalid_argument("empty size");
+
+    // عشري دائمًا (الصفر في البداية لا يعني ثماني) إلا مع 0x صريحة، ولا إشارة قبل الرقم
+    bool hex = s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X');
+    size_t start = hex ? 2 : 0;
+    if (!std::isxdigit(static_cast<unsigned char>(s[start])) ||
+        (!hex && !std::isdigit(static_cast<unsigned char>(s[start])))) {
+        throw std::invalid_argument("invalid size '" + text + "'");
     }
 
-    // هل السلسلة تنتهي بنص معين؟
-    static bool endsWith(const std::string& str, const std::string& suffix) {
-        return str.size() >= suffix.size() &&
-               str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+    size_t used = 0;
+    uint64_t value = 0;
+    try {
+        value = std::stoull(s.substr(start), &used, hex ? 16 : 10);
+    } catch (const std::out_of_range&) {
+        throw std::invalid_argument("size out of range '" + text + "'");
     }
-};
\ No newline at end of file
+    std::string suffix = s.substr(start + used);
+    std::transform(suffix.begin(), suffix.end(), suffix.begin(), [](unsigned char c) { return std::toupper(c); });
+    if (!suffix.empty() && suffix.back() == 'B') suffix.pop_back();
+
+    uint64_t multiplier = 1;
+    if (suffix == "K") multiplier = 1ULL << 10;
+    else if (suffix == "M") multiplier = 1ULL << 20;
+    else if (suffix == "G") multiplier = 1ULL << 30;
+    else if (suffix == "T") multiplier = 1ULL << 40;
+    else if (suffix == "S") multiplier = 512; // قطاعات
+    else if (!suffix.empty()) throw std::invalid_argument("invalid size '" + text + "'");
+
+    if (value > UINT64_MAX / multiplier) throw std::invalid_argument("size out of range '" + text + "'");
+    return value * multiplier;
+}
+
+bool Utils::startsWith(const std::string& str, const std::string& prefix) {
+    return str.rfind(prefix, 0) == 0;
+}
+
+bool Utils::endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class Utils {
+public:
+    // تحويل بيانات ثنائية إلى هيكسي
+    static std::string toHex(const std::vector<uint8_t>& data, size_t limit = 64);
+
+    // طباعة Hex Dump كامل أو جزئي
+    static void hexDump(const std::vector<uint8_t>& data, size_t limit = 128);
+
+    // قراءة ملف كبيانات ثنائية
+    static std::vector<uint8_t> readFileBinary(const std::string& path);
+
+    // كتابة بيانات ثنائية إلى ملف
+    static bool writeFileBinary(const std::string& path, const std::vector<uint8_t>& data);
+
+    // إنشاء مجلد إن لم يكن موجودًا
+    static bool createDirectoryIfNotExists(const std::string& path);
+
+    // التحقق مما إذا كان الملف موجودًا
+    static bool fileExists(const std::string& path);
+
+    // الحصول على اسم الملف من المسار
+    static std::string getFileNameFromPath(const std::string& path);
+
+    // تنظيف المسار (إزالة المسافات الزائدة، التنقلات..)
+    static std::string sanitizePath(const std::string& path);
+
+    // فحص ما إذا كان القرص موجودًا (Linux فقط)
+    static bool isBlockDevice(const std::string& path);
+
+    // تحويل حجم بالبايت إلى KB/MB/GB
+    static std::string formatFileSize(uint64_t bytes);
+
+    // تحويل حجم مثل 512, 64K, 16M, 2G أو 2048S (قطاعات 512) إلى بايتات؛ الرقم عشري إلا مع بادئة 0x
+    // (يرمي std::invalid_argument للسالب أو الفائض أو اللاحقة المجهولة)
+    static uint64_t parseSize(const std::string& text);
+
+    // تقليم المسافات من بداية ونهاية السلسلة
+    static std::string trim(const std::string& s);
+
+    // تهريب نص لاستخدامه داخل سلسلة JSON
+    static std::string jsonEscape(const std::string& s);
+
+    // هل السلسلة تبدأ بنص معين؟
+    static bool startsWith(const std::string& str, const std::string& prefix);
+
+    // هل السلسلة تنتهي بنص معين؟
+    static bool endsWith(const std::string& str, const std::string& suffix);
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// ساحة ذاكرة لعامل واحد: مخزن ثابت يُحجز مرة، وكل قطعة (أو دفعة) تأخذ منه بالتتابع بلا أقفال ولا malloc.
+// reset يهمل كل ما حُجز في القطعة السابقة دفعة واحدة (O(1))، وما يتجاوز المخزن يُطلب من upstream.
+// كل حاوية أخذت من الساحة يجب أن تنتهي قبل reset التالي.
+class WorkerArena {
+public:
+    explicit WorkerArena(size_t capacity,
+                         std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : storage(capacity), upstream(upstream) {}
+
+    WorkerArena(const WorkerArena&) = delete;
+    WorkerArena& operator=(const WorkerArena&) = delete;
+
+    // مورد جديد يبدأ من أول المخزن
+    std::pmr::memory_resource* reset() {
+        resource.reset();
+        resource.emplace(storage.data(), storage.size(), upstream);
+        return &*resource;
+    }
+
+private:
+    std::vector<std::byte> storage;
+    std::pmr::memory_resource* upstream;
+    std::optional<std::pmr::monotonic_buffer_resource> resource;
+};